@@ -31,9 +31,8 @@ class DofBlurShader : public Shader {
             DofBlurFBO->initDrawBuffers();
 
             // Handle frame size changing
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&, frameScale = frameScale](const Message &msg) {
-                const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-                glm::uvec2 frameSize = (static_cast<const WindowFrameSizeMessage &>(msg)).frameSize;
+            mFrameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&, frameScale = frameScale](const WindowFrameSizeMessage &msg) {
+                glm::uvec2 frameSize = msg.frameSize;
                 Library::getFBO("dofblur")->resize(frameSize / glm::uvec2(*frameScale));
             });
  
@@ -62,4 +61,7 @@ class DofBlurShader : public Shader {
         virtual void imguiEditor() override {
             ImGui::SliderInt("Blur size", &blurSize, 0, 8);
         }
+
+    private:
+        Subscription mFrameSizeReceiver;
 };
@@ -30,9 +30,8 @@ class DofDownShader : public Shader {
             DofDownFBO->initDrawBuffers();
 
             // Handle frame size changing
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&, frameScale = frameScale](const Message &msg) {
-                const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-                glm::uvec2 frameSize = (static_cast<const WindowFrameSizeMessage &>(msg)).frameSize;
+            mFrameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&, frameScale = frameScale](const WindowFrameSizeMessage &msg) {
+                glm::uvec2 frameSize = msg.frameSize;
                 Library::getFBO("dofdown")->resize(frameSize / glm::uvec2(*frameScale));
             });
  
@@ -58,4 +57,7 @@ class DofDownShader : public Shader {
 
         virtual void imguiEditor() override {
         }
+
+    private:
+        Subscription mFrameSizeReceiver;
 };
@@ -28,9 +28,8 @@ class DofInfoShader : public Shader {
             DofInfoFBO->initDrawBuffers();
 
             // Handle frame size changing
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const Message &msg) {
-                const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-                glm::uvec2 frameSize = (static_cast<const WindowFrameSizeMessage &>(msg)).frameSize;
+            mFrameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const WindowFrameSizeMessage &msg) {
+                glm::uvec2 frameSize = msg.frameSize;
                 Library::getFBO("dofinfo")->resize(frameSize);
             });
  
@@ -66,4 +65,7 @@ class DofInfoShader : public Shader {
             ImGui::SliderFloat("Center Point", &focalPoints[1], focalPoints.x + 0.001f, focalPoints.z - 0.001f);
             ImGui::SliderFloat("Far Point", &focalPoints[2], focalPoints.y + 0.001f, 1.f);
         }
+
+    private:
+        Subscription mFrameSizeReceiver;
 };
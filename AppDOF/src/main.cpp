@@ -24,6 +24,7 @@ struct Camera {
         Engine::addComponent<SpatialComponent>(gameObject, pos, glm::vec3(1.f));
         camera = &Engine::addComponentAs<PerspectiveCameraComponent, CameraComponent>(gameObject, near, far, fov, Window::getAspectRatio());
         Engine::addComponent<CameraControllerComponent>(gameObject, ls, ms);
+        Engine::addComponent<FrustumFitSourceComponent>(gameObject);
     }
 };
 
@@ -34,8 +35,14 @@ struct Light {
         auto& spat = Engine::addComponent<SpatialComponent>(gameObject, pos);
         spat.setLookDir(lookDir);
         Engine::addComponent<LightComponent>(gameObject, col, att);
-        Engine::addComponentAs<OrthoCameraComponent, CameraComponent>(gameObject, -1.f, 1000.f, -100.f, 100.f, -100.f, 100.f);
-        Engine::addComponent<ShadowCameraComponent>(gameObject);
+
+        // Shadow camera object -- 4 cascades of 1024x1024 fit around the main camera
+        auto cameraObject = &Engine::createGameObject();
+        Engine::addComponentAs<OrthoCameraComponent, CameraComponent>(cameraObject, -1.f, 1000.f, -100.f, 100.f, -100.f, 100.f);
+        Engine::addComponent<SpatialComponent>(cameraObject, pos);
+        Engine::addComponent<ShadowCameraComponent>(cameraObject);
+        Engine::addComponent<FrustumFitReceiverComponent>(cameraObject);
+        Engine::addComponent<CascadedShadowComponent>(cameraObject, 4, 1024);
 
         Engine::addImGuiFunc("Light", [&]() {
             auto light = Engine::getSingleComponent<LightComponent>();
@@ -43,6 +50,7 @@ struct Light {
             if (auto spatial = light->getGameObject().getComponentByType<SpatialComponent>()) {
                 spatial->imGuiEditor();
             }
+            Engine::getSingleComponent<CascadedShadowComponent>()->imGuiEditor();
         });
     }
 };
@@ -99,6 +107,7 @@ int main() {
 
     /* Systems - order matters! */
     Engine::addSystem<CameraControllerSystem>();
+    Engine::addSystem<FrustaFittingSystem>();
 
     /* Init renderer */
     auto defaultFBO = Library::createFBO("default");
@@ -106,9 +115,8 @@ int main() {
     defaultFBO->attachDepthTexture(Window::getFrameSize(), GL_NEAREST, GL_CLAMP_TO_EDGE); // depth
     defaultFBO->initDrawBuffers();
     // Handle frame size changing
-    Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const Message &msg) {
-        const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-        glm::uvec2 frameSize = (static_cast<const WindowFrameSizeMessage &>(msg)).frameSize;
+    auto frameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const WindowFrameSizeMessage &msg) {
+        glm::uvec2 frameSize = msg.frameSize;
         Library::getFBO("default")->resize(frameSize);
     });
  
@@ -119,7 +127,7 @@ int main() {
     Renderer::addPreProcessShader<DofInfoShader>("dofinfo.vert", "dofinfo.frag");
     Renderer::addPreProcessShader<DofDownShader>("dofdown.vert", "dofdown.frag", frameScale);
     Renderer::addPreProcessShader<DofBlurShader>("dofblur.vert", "dofblur.frag", frameScale);
-    Renderer::addPreProcessShader<ShadowCasterShader>(4096);
+    Renderer::addPreProcessShader<ShadowCasterShader>(2048);
     auto& phongshadow = Renderer::addSceneShader<PhongShadowShader>();
     phongshadow.bias = 0.002f;
     Renderer::addSceneShader<SkyboxShader>();
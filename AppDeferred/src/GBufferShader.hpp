@@ -28,9 +28,8 @@ class GBufferShader : public Shader {
             gbuffer->initDrawBuffers();
 
             // Handle frame size changing
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const Message &msg) {
-                const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-                glm::uvec2 frameSize = (static_cast<const WindowFrameSizeMessage &>(msg)).frameSize;
+            mFrameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const WindowFrameSizeMessage &msg) {
+                glm::uvec2 frameSize = msg.frameSize;
                 Library::getFBO("gbuffer")->resize(frameSize);
             });
         }
@@ -43,14 +42,17 @@ class GBufferShader : public Shader {
 
             bind();
 
-            if (auto camera = Engine::getComponentTuple<MainCameraComponent, CameraComponent>()) {
-                loadUniform("P", camera->get<CameraComponent>()->getProj());
-                loadUniform("V", camera->get<CameraComponent>()->getView());
-            }
+            auto camera = Engine::getComponentTuple<MainCameraComponent, CameraComponent>();
+            NEO_ASSERT(camera, "No main camera exists");
+            const glm::mat4 P = camera->get<CameraComponent>()->getProj();
+            const glm::mat4 V = camera->get<CameraComponent>()->getView();
+            loadUniform("P", P);
+            loadUniform("V", V);
 
             for (auto& renderableIt : Engine::getComponentTuples<GBufferComponent, MeshComponent, SpatialComponent>()) {
                 auto renderable = renderableIt->get<GBufferComponent>();
-                loadUniform("M", renderableIt->get<SpatialComponent>()->getModelMatrix());
+                const glm::mat4 M = renderableIt->get<SpatialComponent>()->getModelMatrix();
+                loadUniform("M", M);
                 loadUniform("N", renderableIt->get<SpatialComponent>()->getNormalMatrix());
 
                 loadUniform("ambientColor", renderable->mMaterial.mAmbient);
@@ -59,9 +61,12 @@ class GBufferShader : public Shader {
                 loadTexture("diffuseMap", renderable->mDiffuseMap);
 
                 /* DRAW */
-                renderableIt->get<MeshComponent>()->mMesh.draw();
+                renderableIt->get<MeshComponent>()->mMesh.draw(P, V, M);
             }
 
             unbind();
     }
+
+    private:
+        Subscription mFrameSizeReceiver;
 };
\ No newline at end of file
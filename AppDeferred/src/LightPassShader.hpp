@@ -14,6 +14,9 @@ class LightPassShader : public Shader {
 
         bool showLights = false;
         float showRadius = 0.1f;
+        /* Lights are looked up in SceneSpatialHash by their centers, so the view's bounds are widened by this much.
+         * A bigger light can be culled while it still reaches into view */
+        float maxLightRadius = 100.f;
 
         LightPassShader(const std::string &vert, const std::string &frag) :
             Shader("LightPassShader", vert, frag) {
@@ -22,9 +25,8 @@ class LightPassShader : public Shader {
             lightFBO->attachColorTexture(Window::getFrameSize(), TextureFormat{ GL_RGBA, GL_RGBA, GL_NEAREST, GL_REPEAT }); // color
 
             // Handle frame size changing
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const Message &msg) {
-                const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-                glm::uvec2 frameSize = (static_cast<const WindowFrameSizeMessage &>(msg)).frameSize;
+            mFrameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const WindowFrameSizeMessage &msg) {
+                glm::uvec2 frameSize = msg.frameSize;
                 Library::getFBO("lightpass")->resize(frameSize);
             });
         }
@@ -49,10 +51,12 @@ class LightPassShader : public Shader {
             loadUniform("showLights", showLights);
             loadUniform("showRadius", showRadius);
 
-            loadUniform("P", mainCamera->get<CameraComponent>()->getProj());
-            loadUniform("V", mainCamera->get<CameraComponent>()->getView());
-            loadUniform("invP", glm::inverse(mainCamera->get<CameraComponent>()->getProj()));
-            loadUniform("invV", glm::inverse(mainCamera->get<CameraComponent>()->getView()));
+            const glm::mat4 & P = mainCamera->get<CameraComponent>()->getProj();
+            const glm::mat4 & V = mainCamera->get<CameraComponent>()->getView();
+            loadUniform("P", P);
+            loadUniform("V", V);
+            loadUniform("invP", glm::inverse(P));
+            loadUniform("invV", glm::inverse(V));
             loadUniform("camPos", mainCamera->get<SpatialComponent>()->getPosition());
 
             /* Bind gbuffer */
@@ -61,18 +65,53 @@ class LightPassShader : public Shader {
             loadTexture("gDiffuse", *gbuffer->mTextures[1]);
             loadTexture("gDepth",   *gbuffer->mTextures[2]);
 
-            /* Render light volumes */
-            for (auto& light : Engine::getComponentTuples<LightComponent, SpatialComponent>()) {
-                auto spatial = light->get<SpatialComponent>();
+            /* World bounds and planes of the view */
+            const glm::mat4 PV = P * V;
+            const glm::mat4 invPV = glm::inverse(PV);
+            glm::vec3 viewMin(FLT_MAX), viewMax(-FLT_MAX);
+            for (int i = 0; i < 8; i++) {
+                const glm::vec4 corner = invPV * glm::vec4(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f, 1.f);
+                viewMin = glm::min(viewMin, glm::vec3(corner) / corner.w);
+                viewMax = glm::max(viewMax, glm::vec3(corner) / corner.w);
+            }
+            const glm::mat4 rows = glm::transpose(PV);
+            glm::vec4 planes[6] = { rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2] };
+            for (auto & plane : planes) {
+                plane /= glm::length(glm::vec3(plane));
+            }
+
+            /* Render light volumes, only for the lights that reach into view */
+            mLights.clear();
+            SceneSpatialHash::queryAABB(viewMin - glm::vec3(maxLightRadius), viewMax + glm::vec3(maxLightRadius), mLights);
+            mLightsDrawn = 0;
+            for (auto gameObject : mLights) {
+                auto light = gameObject->getComponentByType<LightComponent>();
+                auto spatial = gameObject->getComponentByType<SpatialComponent>();
+                if (!light || !spatial) {
+                    continue;
+                }
+
+                const float radius = spatial->getScale().x;
+                bool inView = true;
+                for (const auto & plane : planes) {
+                    if (glm::dot(glm::vec3(plane), spatial->getPosition()) + plane.w < -radius) {
+                        inView = false;
+                        break;
+                    }
+                }
+                if (!inView) {
+                    continue;
+                }
+                mLightsDrawn++;
 
                 loadUniform("M", spatial->getModelMatrix());
                 loadUniform("lightPos", spatial->getPosition());
-                loadUniform("lightRadius", spatial->getScale().x);
-                loadUniform("lightCol", light->get<LightComponent>()->mColor);
+                loadUniform("lightRadius", radius);
+                loadUniform("lightCol", light->mColor);
 
                 // If mainCamera is inside light 
                 float dist = glm::distance(spatial->getPosition(), mainCamera->get<SpatialComponent>()->getPosition());
-                if (dist - mainCamera->get<CameraComponent>()->getNearFar().x < spatial->getScale().x) {
+                if (dist - mainCamera->get<CameraComponent>()->getNearFar().x < radius) {
                     CHECK_GL(glCullFace(GL_FRONT));
                 }
                 else {
@@ -89,5 +128,13 @@ class LightPassShader : public Shader {
             if (showLights) {
                 ImGui::SliderFloat("Show radius", &showRadius, 0.01f, 1.f);
             }
+            ImGui::SliderFloat("Max light radius", &maxLightRadius, 1.f, 200.f);
+            ImGui::Text("Lights drawn: %d", mLightsDrawn);
         }
+
+    private:
+        Subscription mFrameSizeReceiver;
+        /* Query results, kept so their storage is reused */
+        std::vector<GameObject *> mLights;
+        int mLightsDrawn = 0;
 };
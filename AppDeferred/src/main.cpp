@@ -30,6 +30,7 @@ struct Light {
         gameObject = &Engine::createGameObject();
         Engine::addComponent<SpatialComponent>(gameObject, pos, scale);
         light = &Engine::addComponent<LightComponent>(gameObject, col);
+        Engine::addComponent<SpatialHashComponent>(gameObject);
     }
 };
 
@@ -80,9 +81,19 @@ int main() {
     terrain.gbuffer->mMaterial.mAmbient = glm::vec3(0.7f);
     terrain.gbuffer->mMaterial.mDiffuse = glm::vec3(0.7f);
 
+    /* Occluders, in each mesh's object space. The staircase is an open sheet of treads and risers, so it gets
+     * the ramp beneath them -- every inner corner lies on it, and so do both ends of the sheet */
+    Engine::addComponent<OccluderComponent>(cube.gameObject, glm::vec3(-0.5f), glm::vec3(0.5f));
+    Engine::addComponent<OccluderComponent>(stairs.gameObject,
+        std::vector<glm::vec3>{ { -0.68f, -0.856f, -0.72f }, { 0.68f, -0.856f, -0.72f }, { 0.68f, 0.510f, 0.99f }, { -0.68f, 0.510f, 0.99f } },
+        std::vector<unsigned>{ 0, 1, 2,  0, 2, 3 });
+    Engine::addComponent<OccluderComponent>(terrain.gameObject,
+        std::vector<glm::vec3>{ { -0.5f, -0.5f, 0.f }, { 0.5f, -0.5f, 0.f }, { 0.5f, 0.5f, 0.f }, { -0.5f, 0.5f, 0.f } },
+        std::vector<unsigned>{ 0, 1, 2,  0, 2, 3 });
+
     /* Systems - order matters! */
     Engine::addSystem<CameraControllerSystem>();
-    Engine::addSystem<SinTranslateSystem>();
+    Engine::addSystem<AnimationSystem>();
 
     /* Init renderer */
     Renderer::init("shaders/");
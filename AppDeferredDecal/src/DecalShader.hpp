@@ -21,9 +21,8 @@ class DecalShader : public Shader {
             decalFBO->initDrawBuffers();
 
             // Handle frame size changing
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const Message &msg) {
-                const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-                glm::uvec2 frameSize = (static_cast<const WindowFrameSizeMessage &>(msg)).frameSize;
+            mFrameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const WindowFrameSizeMessage &msg) {
+                glm::uvec2 frameSize = msg.frameSize;
                 Library::getFBO("decals")->resize(frameSize);
             });
         }
@@ -52,7 +51,7 @@ class DecalShader : public Shader {
             for (auto& decal : Engine::getComponentTuples<DecalRenderable, SpatialComponent>()) {
                 auto spatial = decal->get<SpatialComponent>();
                 loadUniform("M", spatial->getModelMatrix());
-                loadUniform("invM", glm::inverse(spatial->getModelMatrix()));
+                loadUniform("invM", spatial->getInverseModelMatrix());
 
                 loadTexture("decalTexture", decal->get<DecalRenderable>()->mDiffuseMap);
 
@@ -61,4 +60,7 @@ class DecalShader : public Shader {
 
             unbind();
     }
+
+    private:
+        Subscription mFrameSizeReceiver;
 };
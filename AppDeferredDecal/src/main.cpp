@@ -95,7 +95,7 @@ int main() {
 
     /* Systems - order matters! */
     Engine::addSystem<CameraControllerSystem>();
-    Engine::addSystem<RotationSystem>();
+    Engine::addSystem<AnimationSystem>();
 
     /* Init renderer */
     Renderer::init("shaders/");
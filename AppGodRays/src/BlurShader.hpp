@@ -26,9 +26,8 @@ class BlurShader : public Shader {
             blur->initDrawBuffers();
 
             // Handle frame size changing
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const Message &msg) {
-                const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-                glm::ivec2 frameSize = (static_cast<const WindowFrameSizeMessage &>(msg)).frameSize;
+            mFrameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const WindowFrameSizeMessage &msg) {
+                glm::ivec2 frameSize = msg.frameSize;
                 Library::getFBO("godrayblur")->resize(frameSize / 2);
             });
 
@@ -77,4 +76,7 @@ class BlurShader : public Shader {
             ImGui::SliderFloat("Weight", &mWeight, 0.01f, 1.f);
             ImGui::SliderFloat("Contribution", &mContribution, 0.01f, 1.f);
         }
+
+    private:
+        Subscription mFrameSizeReceiver;
 };
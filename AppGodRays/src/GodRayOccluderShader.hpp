@@ -35,17 +35,14 @@ class GodRayOccluderShader : public Shader {
             loadUniform("P", camera->get<CameraComponent>()->getProj());
             loadUniform("V", camera->get<CameraComponent>()->getView());
 
+            const auto cameraFrustum = camera->mGameObject.getComponentByType<FrustumComponent>();
+
             for (auto& renderable : Engine::getComponentTuples<SunOccluderComponent, MeshComponent, SpatialComponent>()) {
                 auto renderableSpatial = renderable->get<SpatialComponent>();
 
                 // VFC
-                if (const auto& boundingBox = renderable->mGameObject.getComponentByType<BoundingBoxComponent>()) {
-                    if (const auto& frustumPlanes = camera->mGameObject.getComponentByType<FrustumComponent>()) {
-                        float radius = glm::max(glm::max(renderableSpatial->getScale().x, renderableSpatial->getScale().y), renderableSpatial->getScale().z) * boundingBox->getRadius();
-                        if (!frustumPlanes->isInFrustum(renderableSpatial->getPosition(), radius)) {
-                            continue;
-                        }
-                    }
+                if (cameraFrustum && !cameraFrustum->isVisible(renderable->mGameObject)) {
+                    continue;
                 }
 
                 loadUniform("M", renderableSpatial->getModelMatrix());
@@ -24,9 +24,8 @@ class GodRaySunShader : public Shader {
             godray->initDrawBuffers();
 
             // Handle frame size changing
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const Message &msg) {
-                const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-                glm::ivec2 frameSize = (static_cast<const WindowFrameSizeMessage &>(msg)).frameSize;
+            mFrameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const WindowFrameSizeMessage &msg) {
+                glm::ivec2 frameSize = msg.frameSize;
                 Library::getFBO("godray")->resize(frameSize / 2);
             });
 
@@ -63,4 +62,7 @@ class GodRaySunShader : public Shader {
 
             unbind();
         }
+
+    private:
+        Subscription mFrameSizeReceiver;
 };
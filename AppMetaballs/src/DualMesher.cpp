@@ -0,0 +1,225 @@
+#include "DualMesher.hpp"
+
+#include "Util/ThreadPool.hpp"
+
+#include "ext/microprofile.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace neo;
+
+namespace {
+    /* Cell layers each task meshes */
+    const int SlabDepth = 4;
+
+    /* Corner i of a cell is at (i & 1, i >> 1 & 1, i >> 2 & 1). Edges run between corners one bit apart */
+    const int sEdgeCorners[12][2] = {
+        { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+        { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+        { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },
+    };
+
+    glm::ivec3 _corner(int corner) {
+        return glm::ivec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+    }
+
+    /* How far the dual contouring solve is pulled toward the mean of the crossings */
+    const float MassPointWeight = 0.05f;
+}
+
+void DualMesher::_makeVertex(const MetaballsField & field, const ActiveCell & cell, Slab & slab) const {
+    const float iso = MetaballsField::IsoValue;
+    const bool useNormals = _usesNormals();
+    float values[8];
+    glm::vec3 cornerNormals[8];
+    for (int corner = 0; corner < 8; corner++) {
+        const glm::ivec3 sample = glm::ivec3(cell.mX, cell.mY, cell.mZ) + _corner(corner);
+        values[corner] = field.getValue(sample.x, sample.y, sample.z);
+        if (useNormals) {
+            cornerNormals[corner] = field.getNormal(sample.x, sample.y, sample.z);
+        }
+    }
+
+    glm::vec3 points[12];
+    glm::vec3 normals[12];
+    unsigned count = 0;
+    for (int edge = 0; edge < 12; edge++) {
+        const int a = sEdgeCorners[edge][0];
+        const int b = sEdgeCorners[edge][1];
+        if ((values[a] < iso) == (values[b] < iso)) {
+            continue;
+        }
+        const float t = glm::clamp((iso - values[a]) / (values[b] - values[a]), 0.f, 1.f);
+        points[count] = glm::mix(glm::vec3(_corner(a)), glm::vec3(_corner(b)), t);
+        if (useNormals) {
+            normals[count] = glm::mix(cornerNormals[a], cornerNormals[b], t);
+        }
+        count++;
+    }
+
+    const glm::vec3 p = glm::clamp(_place(points, normals, count), glm::vec3(0.f), glm::vec3(1.f));
+    const glm::vec3 position = field.getOrigin() + glm::vec3(cell.mX, cell.mY, cell.mZ) + p;
+    const unsigned key = (unsigned(cell.mZ) * mDims + unsigned(cell.mY)) * mDims + unsigned(cell.mX);
+    slab.mTable.insert(key, unsigned(slab.mPositions.size() / 3));
+    slab.mPositions.insert(slab.mPositions.end(), { position.x, position.y, position.z });
+}
+
+unsigned DualMesher::_findVertex(int x, int y, int z) const {
+    const Slab & slab = mSlabs[z / SlabDepth];
+    const unsigned vertex = slab.mTable.find((unsigned(z) * mDims + unsigned(y)) * mDims + unsigned(x));
+    return vertex == VertexTable::None ? vertex : slab.mBase + vertex;
+}
+
+void DualMesher::_makeQuads(const MetaballsField & field, const ActiveCell & cell, Slab & slab) const {
+    const float iso = MetaballsField::IsoValue;
+    const glm::ivec3 c(cell.mX, cell.mY, cell.mZ);
+    const bool startOutside = field.getValue(c.x, c.y, c.z) < iso;
+
+    /* The three edges leaving the cell's first corner. Around each, the four cells in counterclockwise
+     * order about the axis, so the quad faces down it */
+    for (int axis = 0; axis < 3; axis++) {
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+        glm::ivec3 end = c;
+        end[axis]++;
+        if ((field.getValue(end.x, end.y, end.z) < iso) == startOutside || !c[u] || !c[v]) {
+            continue;
+        }
+
+        unsigned quad[4];
+        bool complete = true;
+        for (int i = 0; i < 4; i++) {
+            glm::ivec3 neighbor = c;
+            neighbor[u] -= (i == 0 || i == 3) ? 1 : 0;
+            neighbor[v] -= (i < 2) ? 1 : 0;
+            quad[i] = _findVertex(neighbor.x, neighbor.y, neighbor.z);
+            complete = complete && quad[i] != VertexTable::None;
+        }
+        if (!complete) {
+            continue;
+        }
+
+        /* Facing away from the inside, as the normals do */
+        if (startOutside) {
+            std::swap(quad[1], quad[3]);
+        }
+        slab.mIndices.insert(slab.mIndices.end(), { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] });
+    }
+}
+
+void DualMesher::extract(const MetaballsField & field, std::vector<float> & positions, std::vector<unsigned> & indices) {
+    MICROPROFILE_SCOPEI("DualMesher", "extract", MP_AUTO);
+    mDims = field.getDims();
+    const int cells = std::max(mDims - 1, 0);
+    const unsigned slabs = (cells + SlabDepth - 1) / SlabDepth;
+    mSlabs.resize(std::max(unsigned(mSlabs.size()), slabs));
+
+    ThreadPool::parallelFor(slabs, 1, [&](unsigned begin, unsigned end) {
+        for (unsigned s = begin; s < end; s++) {
+            Slab & slab = mSlabs[s];
+            slab.mZBegin = int(s) * SlabDepth;
+            slab.mActiveCells.clear();
+            slab.mCellsVisited = 0;
+            for (int z = slab.mZBegin; z < std::min(cells, slab.mZBegin + SlabDepth); z++) {
+                slab.mCellsVisited += _classify(field, z, slab.mActiveCells);
+            }
+            slab.mTable.reset(slab.mActiveCells.size());
+            slab.mPositions.clear();
+            for (auto & cell : slab.mActiveCells) {
+                _makeVertex(field, cell, slab);
+            }
+        }
+    });
+
+    /* Vertices go out slab after slab, so each slab's are a contiguous run */
+    mStats = Stats();
+    for (unsigned s = 0; s < slabs; s++) {
+        mSlabs[s].mBase = mStats.mVertices;
+        mStats.mVertices += unsigned(mSlabs[s].mPositions.size() / 3);
+        mStats.mCellsVisited += mSlabs[s].mCellsVisited;
+        mStats.mActiveCells += unsigned(mSlabs[s].mActiveCells.size());
+    }
+
+    ThreadPool::parallelFor(slabs, 1, [&](unsigned begin, unsigned end) {
+        for (unsigned s = begin; s < end; s++) {
+            Slab & slab = mSlabs[s];
+            slab.mIndices.clear();
+            for (auto & cell : slab.mActiveCells) {
+                _makeQuads(field, cell, slab);
+            }
+        }
+    });
+
+    positions.resize(size_t(mStats.mVertices) * 3);
+    size_t indexCount = 0;
+    for (unsigned s = 0; s < slabs; s++) {
+        indexCount += mSlabs[s].mIndices.size();
+    }
+    indices.resize(indexCount);
+    size_t offset = 0;
+    for (unsigned s = 0; s < slabs; s++) {
+        const Slab & slab = mSlabs[s];
+        std::copy(slab.mPositions.begin(), slab.mPositions.end(), positions.begin() + size_t(slab.mBase) * 3);
+        std::copy(slab.mIndices.begin(), slab.mIndices.end(), indices.begin() + offset);
+        offset += slab.mIndices.size();
+    }
+    mStats.mTriangles = unsigned(indexCount / 3);
+}
+
+glm::vec3 SurfaceNets::_place(const glm::vec3 * points, const glm::vec3 * normals, unsigned count) const {
+    glm::vec3 mean(0.f);
+    for (unsigned i = 0; i < count; i++) {
+        mean += points[i];
+    }
+    return count ? mean / float(count) : glm::vec3(0.5f);
+}
+
+glm::vec3 DualContouring::_place(const glm::vec3 * points, const glm::vec3 * normals, unsigned count) const {
+    glm::vec3 mean(0.f);
+    for (unsigned i = 0; i < count; i++) {
+        mean += points[i];
+    }
+    mean = count ? mean / float(count) : glm::vec3(0.5f);
+
+    /* Least squares over the planes n . x = n . p, solved around the mean so the pull toward it is just a
+     * damping term: (A^T A + wI) d = A^T b' with b' the planes' offsets from the mean */
+    float ata[3][3] = {};
+    glm::vec3 atb(0.f);
+    for (unsigned i = 0; i < count; i++) {
+        const float length = glm::length(normals[i]);
+        if (length <= 0.f) {
+            continue;
+        }
+        const glm::vec3 n = normals[i] / length;
+        const float offset = glm::dot(n, points[i] - mean);
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                ata[r][c] += n[r] * n[c];
+            }
+            atb[r] += n[r] * offset;
+        }
+    }
+    for (int d = 0; d < 3; d++) {
+        ata[d][d] += MassPointWeight;
+    }
+
+    /* Cramer's rule -- the damping keeps the determinant away from zero */
+    auto det3 = [](const float m[3][3]) {
+        return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+             - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+             + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    };
+    const float det = det3(ata);
+    glm::vec3 solution(0.f);
+    for (int column = 0; column < 3; column++) {
+        float m[3][3];
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                m[r][c] = c == column ? atb[r] : ata[r][c];
+            }
+        }
+        solution[column] = det3(m) / det;
+    }
+    return mean + solution;
+}
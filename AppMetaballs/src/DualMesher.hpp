@@ -0,0 +1,64 @@
+#pragma once
+
+#include "IsoMesher.hpp"
+
+#include <vector>
+
+/* Meshers that put one vertex in each cell the surface crosses and join the four cells around every crossed
+ * grid edge with a quad. Backends only choose where in its cell the vertex goes. Vertices are made a Z slab
+ * at a time in parallel, then the slabs build their quads against each other's vertices */
+class DualMesher : public IsoMesher {
+
+    public:
+        virtual void extract(const MetaballsField & field, std::vector<float> & positions, std::vector<unsigned> & indices) override;
+
+    protected:
+        /* The vertex in a cell's unit cube, from where the surface crosses its edges and the normals there */
+        virtual glm::vec3 _place(const glm::vec3 * points, const glm::vec3 * normals, unsigned count) const = 0;
+        /* Whether _place looks at the normals -- they're left out otherwise */
+        virtual bool _usesNormals() const { return false; }
+
+    private:
+        struct Slab {
+            int mZBegin = 0;
+            std::vector<ActiveCell> mActiveCells;
+            unsigned mCellsVisited = 0;
+
+            /* From cell to vertex, counted from mBase */
+            VertexTable mTable;
+            unsigned mBase = 0;
+
+            std::vector<float> mPositions;
+            std::vector<unsigned> mIndices;
+        };
+
+        std::vector<Slab> mSlabs;
+        int mDims = 0;
+
+        void _makeVertex(const MetaballsField & field, const ActiveCell & cell, Slab & slab) const;
+        void _makeQuads(const MetaballsField & field, const ActiveCell & cell, Slab & slab) const;
+        unsigned _findVertex(int x, int y, int z) const;
+};
+
+/* The vertex at the mean of the edge crossings. Smooth, with about as many triangles as marching cubes but
+ * fewer slivers */
+class SurfaceNets : public DualMesher {
+
+    public:
+        virtual const char * getName() const override { return "Surface nets"; }
+
+    protected:
+        virtual glm::vec3 _place(const glm::vec3 * points, const glm::vec3 * normals, unsigned count) const override;
+};
+
+/* The vertex where the planes through the edge crossings come closest to meeting, pulled gently toward
+ * their mean so flat and curved cells stay well behaved. Keeps sharp creases where balls meet */
+class DualContouring : public DualMesher {
+
+    public:
+        virtual const char * getName() const override { return "Dual contouring"; }
+
+    protected:
+        virtual glm::vec3 _place(const glm::vec3 * points, const glm::vec3 * normals, unsigned count) const override;
+        virtual bool _usesNormals() const override { return true; }
+};
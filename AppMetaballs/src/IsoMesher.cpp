@@ -0,0 +1,130 @@
+#include "IsoMesher.hpp"
+
+#include "Util/ThreadPool.hpp"
+
+#include "ext/microprofile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+using namespace neo;
+
+namespace {
+    /* Case bits for a sample's rows (y, z), (y + 1, z), (y, z + 1), (y + 1, z + 1) outside the surface, when
+     * it's a cell's near or far corner in x -- marching cubes corners 7, 3, 4, 0 and 6, 2, 5, 1 */
+    const uint8_t sLeftCorners[16] = {
+        0x00, 0x80, 0x08, 0x88, 0x10, 0x90, 0x18, 0x98,
+        0x01, 0x81, 0x09, 0x89, 0x11, 0x91, 0x19, 0x99,
+    };
+    const uint8_t sRightCorners[16] = {
+        0x00, 0x40, 0x04, 0x44, 0x20, 0x60, 0x24, 0x64,
+        0x02, 0x42, 0x06, 0x46, 0x22, 0x62, 0x26, 0x66,
+    };
+
+    size_t _hash(unsigned key, size_t mask) {
+        return (key * 2654435761u) & mask;
+    }
+
+    /* Vertices each task generates normals for */
+    const unsigned VerticesPerTask = 4096;
+}
+
+void IsoMesher::VertexTable::reset(size_t keys) {
+    size_t capacity = 64;
+    while (capacity < keys * 2) {
+        capacity *= 2;
+    }
+    mKeys.assign(capacity, None);
+    mVertices.resize(capacity);
+}
+
+unsigned IsoMesher::VertexTable::find(unsigned key) const {
+    const size_t mask = mKeys.size() - 1;
+    for (size_t slot = _hash(key, mask); mKeys[slot] != None; slot = (slot + 1) & mask) {
+        if (mKeys[slot] == key) {
+            return mVertices[slot];
+        }
+    }
+    return None;
+}
+
+unsigned IsoMesher::VertexTable::insert(unsigned key, unsigned vertex) {
+    const size_t mask = mKeys.size() - 1;
+    size_t slot = _hash(key, mask);
+    for (; mKeys[slot] != None; slot = (slot + 1) & mask) {
+        if (mKeys[slot] == key) {
+            return mVertices[slot];
+        }
+    }
+    mKeys[slot] = key;
+    mVertices[slot] = vertex;
+    return None;
+}
+
+unsigned IsoMesher::_classify(const MetaballsField & field, int z, std::vector<ActiveCell> & cells) {
+    const float iso = MetaballsField::IsoValue;
+    unsigned visited = 0;
+    for (int y = 0; y < field.getDims() - 1; y++) {
+        int begin, end;
+        field.getCellSpan(y, z, begin, end);
+        if (begin >= end) {
+            continue;
+        }
+
+        /* Each sample's four rows packed as bits, shared by the cells on either side of it */
+        const float * rows[4] = { field.getRow(y, z), field.getRow(y + 1, z), field.getRow(y, z + 1), field.getRow(y + 1, z + 1) };
+        auto outside = [&](int x) {
+            return unsigned(rows[0][x] < iso) | unsigned(rows[1][x] < iso) << 1 | unsigned(rows[2][x] < iso) << 2 | unsigned(rows[3][x] < iso) << 3;
+        };
+        unsigned left = outside(begin);
+        for (int x = begin; x < end; x++) {
+            const unsigned right = outside(x + 1);
+            const unsigned cubeCase = sLeftCorners[left] | sRightCorners[right];
+            if (cubeCase && cubeCase != 0xff) {
+                cells.push_back({ x, y, z, cubeCase });
+            }
+            left = right;
+        }
+        visited += unsigned(end - begin);
+    }
+    return visited;
+}
+
+void IsoMesher::generateNormals(const MetaballsField & field, const std::vector<float> & positions, std::vector<float> & normals) {
+    MICROPROFILE_SCOPEI("IsoMesher", "generateNormals", MP_AUTO);
+    const unsigned count = unsigned(positions.size() / 3);
+    normals.resize(positions.size());
+    const int last = std::max(field.getDims() - 2, 0);
+    const glm::vec3 origin = field.getOrigin();
+    const unsigned tasks = (count + VerticesPerTask - 1) / VerticesPerTask;
+    ThreadPool::parallelFor(tasks, 1, [&](unsigned begin, unsigned end) {
+        for (unsigned v = begin * VerticesPerTask; v < std::min(count, end * VerticesPerTask); v++) {
+            const glm::vec3 local = glm::vec3(positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2]) - origin;
+            glm::ivec3 cell;
+            glm::vec3 t;
+            for (int axis = 0; axis < 3; axis++) {
+                cell[axis] = std::min(std::max(int(std::floor(local[axis])), 0), last);
+                t[axis] = local[axis] - float(cell[axis]);
+            }
+
+            glm::vec3 normal(0.f);
+            for (int corner = 0; corner < 8; corner++) {
+                float weight = 1.f;
+                for (int axis = 0; axis < 3; axis++) {
+                    weight *= ((corner >> axis) & 1) ? t[axis] : 1.f - t[axis];
+                }
+                if (weight > 0.f) {
+                    normal += field.getNormal(cell.x + (corner & 1), cell.y + ((corner >> 1) & 1), cell.z + ((corner >> 2) & 1)) * weight;
+                }
+            }
+            const float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+            if (length > 0.f) {
+                normal /= length;
+            }
+            normals[v * 3] = normal.x;
+            normals[v * 3 + 1] = normal.y;
+            normals[v * 3 + 2] = normal.z;
+        }
+    });
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "MetaballsField.hpp"
+
+#include <vector>
+
+/* Extracts a MetaballsField's iso surface as an indexed triangle mesh. Every backend starts from the same
+ * sparse pass -- only cells some ball reaches are classified, and only the ones the surface crosses go on.
+ * Normals are a separate pass over the finished vertices, shared by every backend */
+class IsoMesher {
+
+    public:
+        struct Stats {
+            unsigned mCellsVisited = 0;
+            unsigned mActiveCells = 0;
+            unsigned mVertices = 0;
+            unsigned mTriangles = 0;
+        };
+
+        virtual ~IsoMesher() {}
+
+        virtual const char * getName() const = 0;
+
+        /* Replaces the outputs with the surface's vertices, their normals, and its triangles */
+        void mesh(const MetaballsField & field, std::vector<float> & positions, std::vector<float> & normals, std::vector<unsigned> & indices) {
+            extract(field, positions, indices);
+            generateNormals(field, positions, normals);
+        }
+
+        /* Replaces positions and indices with the surface's vertices and triangles */
+        virtual void extract(const MetaballsField & field, std::vector<float> & positions, std::vector<unsigned> & indices) = 0;
+
+        /* A normal for each vertex -- the field's normals at its cell's corners, blended across the cell to it.
+         * Corners with no weight are skipped, so a vertex on a grid edge only reads that edge's two */
+        static void generateNormals(const MetaballsField & field, const std::vector<float> & positions, std::vector<float> & normals);
+
+        const Stats & getStats() const { return mStats; }
+
+    protected:
+        /* A cell the surface crosses, and which of its corners are outside -- bit i is corner i of marching
+         * cubes' cube */
+        struct ActiveCell {
+            int mX, mY, mZ;
+            unsigned mCase;
+        };
+
+        /* Open addressing from a grid edge or cell to the vertex made for it */
+        class VertexTable {
+
+            public:
+                static constexpr unsigned None = ~0u;
+
+                /* Empties the table, with room for this many keys at under half full */
+                void reset(size_t keys);
+                unsigned find(unsigned key) const;
+                /* The vertex already stored for key, or None after storing this one */
+                unsigned insert(unsigned key, unsigned vertex);
+
+            private:
+                std::vector<unsigned> mKeys;
+                std::vector<unsigned> mVertices;
+        };
+
+        Stats mStats;
+
+        /* Appends the cells in layer z that the surface crosses, and returns how many were looked at */
+        static unsigned _classify(const MetaballsField & field, int z, std::vector<ActiveCell> & cells);
+};
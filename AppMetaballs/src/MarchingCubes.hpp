@@ -0,0 +1,37 @@
+#pragma once
+
+#include "IsoMesher.hpp"
+
+#include <vector>
+
+/* Marching cubes. Only the cells the surface crosses get vertices and triangles, so the cost follows the
+ * surface rather than the grid. Z slabs run in parallel into their own buffers, which are kept and grown
+ * between updates. Each grid edge the surface crosses is one vertex, shared by the cells around it */
+class MarchingCubes : public IsoMesher {
+
+    public:
+        virtual const char * getName() const override { return "Marching cubes"; }
+        virtual void extract(const MetaballsField & field, std::vector<float> & positions, std::vector<unsigned> & indices) override;
+
+    private:
+        struct Slab {
+            int mZBegin = 0;
+            std::vector<ActiveCell> mActiveCells;
+            unsigned mCellsVisited = 0;
+
+            /* Vertices by the grid edge they sit on, and triangles over them */
+            std::vector<unsigned> mEdges;
+            std::vector<float> mPositions;
+            std::vector<unsigned> mIndices;
+
+            VertexTable mTable;
+
+            /* Each vertex's index in the stitched output */
+            std::vector<unsigned> mRemap;
+        };
+
+        std::vector<Slab> mSlabs;
+
+        void _triangulate(const MetaballsField & field, const ActiveCell & cell, Slab & slab) const;
+        void _stitch(int dims, unsigned slabs, std::vector<float> & positions, std::vector<unsigned> & indices);
+};
@@ -6,8 +6,7 @@ using namespace neo;
 
 MetaballComponent::MetaballComponent(GameObject* go) :
     Component(go) {
-        Messenger::addReceiver<SpatialChangeMessage>(go, [](const Message& _msg) {
-            const SpatialChangeMessage& msg = static_cast<const SpatialChangeMessage &>(_msg);
+        mSpatialReceiver = Messenger::addReceiver<SpatialChangeMessage>(go, [](const SpatialChangeMessage &msg) {
             Engine::getSystem<MetaballsSystem>().mDirtyBalls = true;
         });
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ECS/Component/Component.hpp"
+#include "Messaging/Messenger.hpp"
 
 using namespace neo;
 
@@ -8,4 +9,7 @@ class MetaballComponent : public Component {
 
 public:
     MetaballComponent(GameObject* go);
+
+private:
+    Subscription mSpatialReceiver;
 };
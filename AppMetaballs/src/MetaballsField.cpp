@@ -0,0 +1,124 @@
+#include "MetaballsField.hpp"
+
+#include "Util/SIMD.hpp"
+#include "Util/ThreadPool.hpp"
+
+#include "ext/microprofile.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace neo;
+
+namespace {
+    /* Z layers each task fills */
+    const int SlabDepth = 4;
+
+    /* Keeps a sample right on a center finite */
+    const float MinDistance2 = 1e-4f;
+
+    const float LaneOffsets[8] = { 0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f };
+}
+
+void MetaballsField::setBalls(const std::vector<glm::vec3> & centers, const std::vector<float> & radii) {
+    const unsigned count = unsigned(centers.size());
+    mCenterX.resize(count);
+    mCenterY.resize(count);
+    mCenterZ.resize(count);
+    mRadius.resize(count);
+    for (unsigned i = 0; i < count; i++) {
+        mCenterX[i] = centers[i].x;
+        mCenterY[i] = centers[i].y;
+        mCenterZ[i] = centers[i].z;
+        mRadius[i] = radii[i];
+    }
+}
+
+void MetaballsField::evaluate(int dims) {
+    MICROPROFILE_SCOPEI("MetaballsField", "evaluate", MP_AUTO);
+    mDims = dims;
+    mRowStride = (dims + simd::Width - 1) / simd::Width * simd::Width;
+    mValues.resize(size_t(mRowStride) * dims * dims);
+    mRowSpans.resize(size_t(dims) * dims);
+
+    const glm::vec3 origin = getOrigin();
+    const unsigned balls = unsigned(mRadius.size());
+    const unsigned slabs = (dims + SlabDepth - 1) / SlabDepth;
+    ThreadPool::parallelFor(slabs, 1, [&](unsigned begin, unsigned end) {
+        const int zBegin = int(begin) * SlabDepth;
+        const int zEnd = std::min(dims, int(end) * SlabDepth);
+        std::fill(mValues.begin() + size_t(zBegin) * dims * mRowStride, mValues.begin() + size_t(zEnd) * dims * mRowStride, -1.f);
+        std::fill(mRowSpans.begin() + size_t(zBegin) * dims, mRowSpans.begin() + size_t(zEnd) * dims, glm::ivec2(dims, -1));
+
+        const simd::vfloat lanes = simd::load(LaneOffsets);
+        for (unsigned ball = 0; ball < balls; ball++) {
+            /* Everything in grid units from here */
+            const glm::vec3 center = glm::vec3(mCenterX[ball], mCenterY[ball], mCenterZ[ball]) - origin;
+            const float radius2 = mRadius[ball] * mRadius[ball];
+            const float reach = mRadius[ball] * InfluenceRadii;
+            const float reach2 = reach * reach;
+            const int z0 = std::max(zBegin, int(std::ceil(center.z - reach)));
+            const int z1 = std::min(zEnd - 1, int(std::floor(center.z + reach)));
+            if (z0 > z1) {
+                continue;
+            }
+            const int y0 = std::max(0, int(std::ceil(center.y - reach)));
+            const int y1 = std::min(dims - 1, int(std::floor(center.y + reach)));
+
+            const simd::vfloat r2 = simd::set1(radius2);
+            const simd::vfloat cutoff = simd::set1(radius2 / reach2);
+            const simd::vfloat limit = simd::set1(reach2);
+            const simd::vfloat minDistance2 = simd::set1(MinDistance2);
+            const simd::vfloat zero = simd::set1(0.f);
+            for (int z = z0; z <= z1; z++) {
+                const float dz = float(z) - center.z;
+                for (int y = y0; y <= y1; y++) {
+                    const float dy = float(y) - center.y;
+                    const float rest = reach2 - dy * dy - dz * dz;
+                    if (rest < 0.f) {
+                        continue;
+                    }
+
+                    /* The span of the row inside the ball's reach, widened to whole lanes. The row padding
+                     * keeps the last one in bounds */
+                    const float halfWidth = std::sqrt(rest);
+                    const int first = std::max(0, int(std::ceil(center.x - halfWidth)));
+                    const int x1 = std::min(dims - 1, int(std::floor(center.x + halfWidth)));
+                    const int x0 = first / simd::Width * simd::Width;
+                    glm::ivec2 & span = mRowSpans[size_t(z) * dims + y];
+                    span = glm::ivec2(std::min(span.x, first), std::max(span.y, x1));
+                    float * row = &mValues[(size_t(z) * dims + y) * mRowStride];
+                    const simd::vfloat dyz2 = simd::set1(dy * dy + dz * dz);
+                    for (int x = x0; x <= x1; x += simd::Width) {
+                        const simd::vfloat dx = simd::set1(float(x) - center.x) + lanes;
+                        const simd::vfloat d2 = dx * dx + dyz2;
+                        const simd::vfloat falloff = r2 / simd::max(d2, minDistance2) - cutoff;
+                        simd::store(row + x, simd::load(row + x) + simd::select(d2 < limit, falloff, zero));
+                    }
+                }
+            }
+        }
+    });
+}
+
+glm::vec3 MetaballsField::getNormal(int x, int y, int z) const {
+    const int last = mDims - 1;
+    const glm::vec3 gradient(
+        getValue(std::max(x - 1, 0), y, z) - getValue(std::min(x + 1, last), y, z),
+        getValue(x, std::max(y - 1, 0), z) - getValue(x, std::min(y + 1, last), z),
+        getValue(x, y, std::max(z - 1, 0)) - getValue(x, y, std::min(z + 1, last))
+    );
+    const float length = glm::length(gradient);
+    return length > 0.f ? gradient / length : glm::vec3(0.f);
+}
+
+void MetaballsField::getCellSpan(int y, int z, int & begin, int & end) const {
+    /* A cell spans its row and the next in y and z, and its own sample and the next in x */
+    glm::ivec2 span(mDims, -1);
+    for (int corner = 0; corner < 4; corner++) {
+        const glm::ivec2 & row = mRowSpans[size_t(z + (corner >> 1)) * mDims + y + (corner & 1)];
+        span = glm::ivec2(std::min(span.x, row.x), std::max(span.y, row.y));
+    }
+    begin = std::max(0, span.x - 1);
+    end = std::min(mDims - 1, span.y + 1);
+}
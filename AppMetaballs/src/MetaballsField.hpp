@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/* The metaballs' scalar field sampled at the corners of a dims^3 grid of unit cells, centered on the origin.
+ * Each ball adds r^2/d^2 out to InfluenceRadii radii, less its value there so it fades to zero instead of
+ * stopping short. Balls only touch the samples they reach, and Z slabs are filled in parallel. Nothing here
+ * needs GL */
+class MetaballsField {
+
+    public:
+        /* The surface is where the field crosses this */
+        static constexpr float IsoValue = 0.5f;
+        /* How far a ball reaches, in radii */
+        static constexpr float InfluenceRadii = 4.f;
+
+        /* Copies the balls into SoA rows for the next evaluate */
+        void setBalls(const std::vector<glm::vec3> & centers, const std::vector<float> & radii);
+        void evaluate(int dims);
+
+        int getDims() const { return mDims; }
+        glm::vec3 getOrigin() const { return glm::vec3(-mDims * 0.5f); }
+
+        float getValue(int x, int y, int z) const {
+            return mValues[(unsigned(z) * mDims + y) * mRowStride + x];
+        }
+        const float * getRow(int y, int z) const {
+            return &mValues[(unsigned(z) * mDims + y) * mRowStride];
+        }
+        /* Points out of the surface -- down the field's central difference gradient */
+        glm::vec3 getNormal(int x, int y, int z) const;
+
+        /* The cells in row (y, z) that any ball reaches, as [begin, end). Everywhere else the field is -1
+         * at all eight corners, so no surface can cross it */
+        void getCellSpan(int y, int z, int & begin, int & end) const;
+
+    private:
+        int mDims = 0;
+        /* Rows are padded out to a whole number of SIMD lanes */
+        unsigned mRowStride = 0;
+        std::vector<float> mValues;
+        /* First and last sample each row's balls reach, or an empty span */
+        std::vector<glm::ivec2> mRowSpans;
+
+        std::vector<float> mCenterX, mCenterY, mCenterZ;
+        std::vector<float> mRadius;
+};
@@ -60,6 +60,7 @@ int main() {
         mesh.mMesh->mPrimitiveType = GL_TRIANGLES;
         mesh.mMesh->addVertexBuffer(VertexType::Position, 0, 3);
         mesh.mMesh->addVertexBuffer(VertexType::Normal, 1, 3);
+        mesh.mMesh->addElementBuffer();
         Engine::addComponent<SpatialComponent>(&go, glm::vec3(0.f, 0.f, 0.f));
     }
 
@@ -60,7 +60,7 @@ int main() {
 
     /* Systems - order matters! */
     Engine::addSystem<CameraControllerSystem>();
-    Engine::addSystem<RotationSystem>();
+    Engine::addSystem<AnimationSystem>();
 
     /* Init renderer */
     Renderer::init("shaders/", glm::vec3(0.2f, 0.3f, 0.4f));
@@ -27,9 +27,8 @@ class GBufferShader : public Shader {
             gbuffer->initDrawBuffers();
 
             // Handle frame size changing
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const Message &msg) {
-                const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-                glm::uvec2 frameSize = (static_cast<const WindowFrameSizeMessage &>(msg)).frameSize;
+            mFrameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const WindowFrameSizeMessage &msg) {
+                glm::uvec2 frameSize = msg.frameSize;
                 Library::getFBO("gbuffer")->resize(frameSize);
             });
         }
@@ -41,16 +40,19 @@ class GBufferShader : public Shader {
 
             bind();
 
-            if (auto camera = Engine::getComponentTuple<MainCameraComponent, CameraComponent>()) {
-                loadUniform("P", camera->get<CameraComponent>()->getProj());
-                loadUniform("V", camera->get<CameraComponent>()->getView());
-            }
+            auto camera = Engine::getComponentTuple<MainCameraComponent, CameraComponent>();
+            NEO_ASSERT(camera, "No main camera exists");
+            const glm::mat4 P = camera->get<CameraComponent>()->getProj();
+            const glm::mat4 V = camera->get<CameraComponent>()->getView();
+            loadUniform("P", P);
+            loadUniform("V", V);
 
             for (auto& renderableIt : Engine::getComponentTuples<GBufferComponent, MeshComponent, SpatialComponent>()) {
                 auto renderable = renderableIt->get<GBufferComponent>();
                 auto spatial = renderableIt->get<SpatialComponent>();
 
-                loadUniform("M", spatial->getModelMatrix());
+                const glm::mat4 M = spatial->getModelMatrix();
+                loadUniform("M", M);
                 loadUniform("N", spatial->getNormalMatrix());
 
                 /* Bind diffuse map or material */
@@ -59,9 +61,12 @@ class GBufferShader : public Shader {
                 loadTexture("diffuseMap", renderable->mDiffuseMap);
 
                 /* DRAW */
-                renderableIt->get<MeshComponent>()->mMesh.draw();
+                renderableIt->get<MeshComponent>()->mMesh.draw(P, V, M);
             }
 
             unbind();
     }
+
+    private:
+        Subscription mFrameSizeReceiver;
 };
\ No newline at end of file
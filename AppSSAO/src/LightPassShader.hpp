@@ -21,9 +21,8 @@ class LightPassShader : public Shader {
             lightFBO->attachColorTexture(Window::getFrameSize(), TextureFormat{ GL_RGBA, GL_RGBA, GL_NEAREST, GL_REPEAT }); // color
 
             // Handle frame size changing
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const Message &msg) {
-                const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-                glm::uvec2 frameSize = (static_cast<const WindowFrameSizeMessage &>(msg)).frameSize;
+            mFrameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const WindowFrameSizeMessage &msg) {
+                glm::uvec2 frameSize = msg.frameSize;
                 Library::getFBO("lightpass")->resize(frameSize);
             });
         }
@@ -89,4 +88,7 @@ class LightPassShader : public Shader {
                 ImGui::SliderFloat("Show radius", &showRadius, 0.01f, 1.f);
             }
         }
+
+    private:
+        Subscription mFrameSizeReceiver;
 };
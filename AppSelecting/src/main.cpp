@@ -80,7 +80,6 @@ int main() {
     Engine::addSystem<MouseRaySystem>(true);
     Engine::addSystem<SelectingSystem>(
         "Selecter System",
-        20, 
         100.f,
         // Decide to remove selected components
         [](SelectedComponent* selected) {
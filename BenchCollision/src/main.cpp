@@ -0,0 +1,203 @@
+#include "Spatial/SweepAndPrune.hpp"
+
+#include "Util/SIMD.hpp"
+#include "Util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace neo;
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Options {
+    unsigned colliders = 50000;
+    std::string shape = "aabb";
+    /* Fraction of the volume the boxes would fill if none overlapped */
+    float fill = 0.05f;
+    /* Units per frame. Boxes are 0.5 to 1.5 units a side */
+    float speed = 0.05f;
+    unsigned seed = 1234;
+    int frames = 100;
+    /* Untimed frames first, so the sweep order and buffers are settled */
+    int warmup = 5;
+};
+
+/* Boxes bouncing around inside a cube. OBBs also spin about y */
+struct Scene {
+    float halfWorld;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> velocities;
+    std::vector<glm::vec3> halfSizes;
+    std::vector<float> angles;
+    std::vector<float> spins;
+};
+
+Scene makeScene(const Options & options) {
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    Scene scene;
+    /* Mean box volume is 1 */
+    scene.halfWorld = 0.5f * std::cbrt(options.colliders / options.fill);
+    for (unsigned i = 0; i < options.colliders; i++) {
+        scene.positions.push_back(glm::vec3(unit(rng), unit(rng), unit(rng)) * scene.halfWorld);
+        scene.velocities.push_back(glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) + glm::vec3(1e-3f)) * options.speed);
+        scene.halfSizes.push_back(glm::vec3(unit(rng), unit(rng), unit(rng)) * 0.25f + 0.5f);
+        scene.angles.push_back(unit(rng) * 3.14159265f);
+        scene.spins.push_back(unit(rng) * 0.05f);
+    }
+    return scene;
+}
+
+void moveScene(Scene & scene) {
+    for (size_t i = 0; i < scene.positions.size(); i++) {
+        glm::vec3 & position = scene.positions[i];
+        glm::vec3 & velocity = scene.velocities[i];
+        position += velocity;
+        for (int axis = 0; axis < 3; axis++) {
+            if (std::abs(position[axis]) > scene.halfWorld) {
+                velocity[axis] = -velocity[axis];
+            }
+        }
+        scene.angles[i] += scene.spins[i];
+    }
+}
+
+/* What CollisionSystem gathers from the BoundingBoxComponents */
+void makeColliders(const Scene & scene, SweepAndPrune::Shape shape, std::vector<SweepAndPrune::Collider> & colliders) {
+    colliders.resize(scene.positions.size());
+    for (size_t i = 0; i < colliders.size(); i++) {
+        SweepAndPrune::Collider & c = colliders[i];
+        const glm::vec3 & half = scene.halfSizes[i];
+        c.mID = unsigned(i) + 1;
+        c.mShape = shape;
+        c.mCenter = scene.positions[i];
+        c.mAxes[0] = glm::vec3(1.f, 0.f, 0.f);
+        c.mAxes[1] = glm::vec3(0.f, 1.f, 0.f);
+        c.mAxes[2] = glm::vec3(0.f, 0.f, 1.f);
+        if (shape == SweepAndPrune::Shape::OBB) {
+            const float cosine = std::cos(scene.angles[i]), sine = std::sin(scene.angles[i]);
+            c.mAxes[0] = glm::vec3(cosine, 0.f, -sine);
+            c.mAxes[2] = glm::vec3(sine, 0.f, cosine);
+        }
+        c.mHalfSize = half;
+        c.mExtent = glm::abs(c.mAxes[0]) * half.x + glm::abs(c.mAxes[1]) * half.y + glm::abs(c.mAxes[2]) * half.z;
+        c.mRadius = glm::length(c.mExtent);
+        if (shape == SweepAndPrune::Shape::Sphere) {
+            c.mExtent = glm::vec3(c.mRadius);
+        }
+    }
+}
+
+void printUsage() {
+    fprintf(stderr,
+        "BenchCollision [options]\n"
+        "  --colliders 50000\n"
+        "  --shape aabb              aabb, sphere, or obb\n"
+        "  --fill 0.05               fraction of the volume the boxes cover\n"
+        "  --speed 0.05              units moved per frame\n"
+        "  --seed 1234\n"
+        "  --frames 100              timed frames\n"
+        "  --warmup 5                untimed frames before them\n");
+}
+
+int main(int argc, char ** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char * arg = argv[i];
+        const char * value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            printUsage();
+            return 1;
+        }
+        if (!strcmp(arg, "--colliders")) {
+            options.colliders = unsigned(std::max(std::atoi(value), 1));
+        }
+        else if (!strcmp(arg, "--shape")) {
+            options.shape = value;
+        }
+        else if (!strcmp(arg, "--fill")) {
+            options.fill = std::max(float(std::atof(value)), 1e-4f);
+        }
+        else if (!strcmp(arg, "--speed")) {
+            options.speed = float(std::atof(value));
+        }
+        else if (!strcmp(arg, "--seed")) {
+            options.seed = unsigned(std::strtoul(value, nullptr, 10));
+        }
+        else if (!strcmp(arg, "--frames")) {
+            options.frames = std::max(std::atoi(value), 1);
+        }
+        else if (!strcmp(arg, "--warmup")) {
+            options.warmup = std::max(std::atoi(value), 0);
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+        i++;
+    }
+
+    SweepAndPrune::Shape shape;
+    if (options.shape == "aabb") {
+        shape = SweepAndPrune::Shape::AABB;
+    }
+    else if (options.shape == "sphere") {
+        shape = SweepAndPrune::Shape::Sphere;
+    }
+    else if (options.shape == "obb") {
+        shape = SweepAndPrune::Shape::OBB;
+    }
+    else {
+        printUsage();
+        return 1;
+    }
+
+    Scene scene = makeScene(options);
+    SweepAndPrune sweepAndPrune;
+    std::vector<SweepAndPrune::Collider> colliders;
+
+    /* The first update sorts from scratch */
+    makeColliders(scene, shape, colliders);
+    auto start = Clock::now();
+    sweepAndPrune.update(colliders);
+    const double firstMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    double minMs = 1e30, maxMs = 0.0, totalMs = 0.0;
+    double candidates = 0.0, contacts = 0.0, enters = 0.0, exits = 0.0;
+    for (int frame = -options.warmup; frame < options.frames; frame++) {
+        moveScene(scene);
+        makeColliders(scene, shape, colliders);
+        start = Clock::now();
+        sweepAndPrune.update(colliders);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (frame < 0) {
+            continue;
+        }
+        minMs = std::min(minMs, ms);
+        maxMs = std::max(maxMs, ms);
+        totalMs += ms;
+        candidates += double(sweepAndPrune.getNumCandidates());
+        contacts += double(sweepAndPrune.getContacts().size());
+        enters += double(sweepAndPrune.getEntered().size());
+        exits += double(sweepAndPrune.getExited().size());
+    }
+
+    const int frames = options.frames;
+    printf("%u %s colliders, fill %.3f, speed %.3f, seed %u, %u threads, SIMD width %d\n",
+        options.colliders, options.shape.c_str(), options.fill, options.speed, options.seed, ThreadPool::getNumThreads(), int(simd::Width));
+    printf("first update  %8.3f ms\n", firstMs);
+    printf("update        %8.3f ms mean, %8.3f min, %8.3f max over %d frames\n", totalMs / frames, minMs, maxMs, frames);
+    printf("per frame     %10.1f candidates, %10.1f contacts, %8.1f enters, %8.1f exits\n",
+        candidates / frames, contacts / frames, enters / frames, exits / frames);
+
+    ThreadPool::shutDown();
+    return 0;
+}
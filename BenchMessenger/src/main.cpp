@@ -0,0 +1,91 @@
+#include "Messaging/Messenger.hpp"
+#include "ECS/GameObject.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace neo;
+
+/* Stand-in for a worker sending transform updates */
+struct BenchMessage : public Message {
+    unsigned value;
+    BenchMessage(unsigned value) : value(value) {}
+};
+
+/* Coalesced flavor -- most of the pushes collapse in the merge */
+struct BenchCoalescedMessage : public Message {
+    static constexpr bool Coalesce = true;
+    unsigned value;
+    BenchCoalescedMessage(unsigned value) : value(value) {}
+};
+
+static const int NUM_OBJECTS = 4096;
+static const int MESSAGES_PER_FRAME = 1 << 20;
+static const int NUM_FRAMES = 20;
+
+using Clock = std::chrono::high_resolution_clock;
+
+static unsigned long long sReceived = 0;
+
+template <typename MsgT>
+void runBenchmark(const char * name, std::vector<std::unique_ptr<GameObject>> & gameObjects, int numProducers) {
+    sReceived = 0;
+    double sendSeconds = 0.0;
+    double relaySeconds = 0.0;
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+        /* Threads are spawned outside of the timed region, each producer owns a slice of the objects */
+        std::atomic<bool> start = false;
+        std::vector<std::thread> producers;
+        for (int p = 0; p < numProducers; p++) {
+            producers.emplace_back([&, p]() {
+                while (!start.load(std::memory_order_acquire));
+                const int perProducer = MESSAGES_PER_FRAME / numProducers;
+                const int objectsPerProducer = NUM_OBJECTS / numProducers;
+                for (int i = 0; i < perProducer; i++) {
+                    Messenger::sendMessage<MsgT>(gameObjects[p * objectsPerProducer + i % objectsPerProducer].get(), 1u);
+                }
+            });
+        }
+
+        auto sendStart = Clock::now();
+        start.store(true, std::memory_order_release);
+        for (auto & producer : producers) {
+            producer.join();
+        }
+        auto relayStart = Clock::now();
+        Messenger::relayMessages();
+        auto relayEnd = Clock::now();
+
+        sendSeconds += std::chrono::duration<double>(relayStart - sendStart).count();
+        relaySeconds += std::chrono::duration<double>(relayEnd - relayStart).count();
+    }
+
+    const double sent = double(MESSAGES_PER_FRAME) * NUM_FRAMES;
+    printf("%-10s %2d producers: send %8.2f M msgs/s, relay %8.2f M msgs/s, %8.3f ms/frame total, %llu received\n",
+        name,
+        numProducers,
+        sent / sendSeconds / 1e6,
+        sent / relaySeconds / 1e6,
+        (sendSeconds + relaySeconds) / NUM_FRAMES * 1000.0,
+        sReceived);
+}
+
+int main() {
+    std::vector<std::unique_ptr<GameObject>> gameObjects;
+    for (int i = 0; i < NUM_OBJECTS; i++) {
+        gameObjects.emplace_back(std::make_unique<GameObject>());
+    }
+
+    auto receiver = Messenger::addReceiver<BenchMessage>(nullptr, [](const BenchMessage & msg) { sReceived += msg.value; });
+    auto coalescedReceiver = Messenger::addReceiver<BenchCoalescedMessage>(nullptr, [](const BenchCoalescedMessage & msg) { sReceived += msg.value; });
+
+    printf("%d messages per frame to %d objects, %d frames\n", MESSAGES_PER_FRAME, NUM_OBJECTS, NUM_FRAMES);
+    for (int numProducers : { 1, 4, 16 }) {
+        runBenchmark<BenchMessage>("plain", gameObjects, numProducers);
+    }
+    for (int numProducers : { 1, 4, 16 }) {
+        runBenchmark<BenchCoalescedMessage>("coalesced", gameObjects, numProducers);
+    }
+
+    return 0;
+}
@@ -0,0 +1,328 @@
+#include "MetaballsField.hpp"
+#include "MarchingCubes.hpp"
+#include "DualMesher.hpp"
+
+#include "Util/SIMD.hpp"
+#include "Util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace neo;
+
+using Clock = std::chrono::high_resolution_clock;
+
+/* Frames are this far apart in the motion patterns */
+static const float FRAME_TIME = 1.f / 60.f;
+
+struct Options {
+    std::vector<int> dims = { 32, 64, 128 };
+    std::vector<int> balls = { 16, 64 };
+    std::vector<std::string> motions = { "static", "orbit", "swarm" };
+    std::vector<std::string> meshers = { "mc", "sn", "dc" };
+    unsigned seed = 1234;
+    int frames = 20;
+    /* Untimed frames first, so buffers and worker threads are settled */
+    int warmup = 2;
+    const char * out = nullptr;
+};
+
+/* A run's balls -- where they start and how they move, all drawn from the seed */
+struct Scene {
+    std::vector<glm::vec3> base;
+    std::vector<glm::vec3> phase;
+    std::vector<float> radius;
+    std::vector<glm::vec3> centers;
+    std::vector<float> radii;
+};
+
+/* Min, max, and mean of one stage over a run's frames */
+struct Timing {
+    double mMin = 1e30, mMax = 0.0, mTotal = 0.0;
+
+    void add(double ms) {
+        mMin = std::min(mMin, ms);
+        mMax = std::max(mMax, ms);
+        mTotal += ms;
+    }
+};
+
+std::unique_ptr<IsoMesher> makeMesher(const std::string & name) {
+    if (name == "mc") {
+        return std::make_unique<MarchingCubes>();
+    }
+    if (name == "sn") {
+        return std::make_unique<SurfaceNets>();
+    }
+    if (name == "dc") {
+        return std::make_unique<DualContouring>();
+    }
+    return nullptr;
+}
+
+size_t getPeakMemory() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return size_t(usage.ru_maxrss);
+#else
+    return size_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+Scene makeScene(int dims, int balls, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    Scene scene;
+    const float scale = dims / 32.f;
+    for (int i = 0; i < balls; i++) {
+        scene.base.push_back(glm::vec3(unit(rng), unit(rng), unit(rng)));
+        scene.phase.push_back(glm::vec3(unit(rng), unit(rng), unit(rng)) * 3.14159265f);
+        scene.radius.push_back((2.f + (unit(rng) * 0.5f + 0.5f) * 1.5f) * scale);
+    }
+    scene.centers.resize(balls);
+    scene.radii.resize(balls);
+    return scene;
+}
+
+/* Positions the balls for a frame. static scatters them once, orbit is AppMetaballs' own sine paths, and
+ * swarm packs them into the middle of the grid so most of them overlap */
+bool moveBalls(Scene & scene, const std::string & motion, int dims, int frame) {
+    const float t = frame * FRAME_TIME;
+    const float scale = dims / 32.f;
+    const float extent = dims * 0.5f - 6.f * scale;
+    for (unsigned i = 0; i < scene.base.size(); i++) {
+        const glm::vec3 & phase = scene.phase[i];
+        glm::vec3 center;
+        float radius = scene.radius[i];
+        if (motion == "static") {
+            center = scene.base[i] * extent;
+        }
+        else if (motion == "orbit") {
+            center = glm::vec3(
+                std::sin(t * (i * 0.21f) + phase.x),
+                std::sin(t * (i * 0.37f) + phase.y),
+                std::cos(t * (i * 0.11f) + phase.z)) * extent;
+            radius *= 0.75f + 0.25f * std::sin(t * (i * 0.13f));
+        }
+        else if (motion == "swarm") {
+            const float breathe = 0.25f + 0.1f * std::sin(t * 2.f + phase.x);
+            center = glm::vec3(
+                std::sin(t + phase.x) * scene.base[i].x,
+                std::sin(t * 1.3f + phase.y) * scene.base[i].y,
+                std::cos(t * 0.7f + phase.z) * scene.base[i].z) * extent * breathe;
+        }
+        else {
+            return false;
+        }
+        scene.centers[i] = center;
+        scene.radii[i] = radius;
+    }
+    return true;
+}
+
+void writeTiming(FILE * file, const char * name, const Timing & timing, int frames, bool last) {
+    fprintf(file, "        \"%s\": { \"mean\": %.4f, \"min\": %.4f, \"max\": %.4f }%s\n",
+        name, timing.mTotal / frames, timing.mMin, timing.mMax, last ? "" : ",");
+}
+
+bool runBenchmark(FILE * file, const Options & options, int dims, int balls, const std::string & motion, const std::string & mesherName, bool first) {
+    std::unique_ptr<IsoMesher> mesher = makeMesher(mesherName);
+    Scene scene = makeScene(dims, balls, options.seed);
+    if (!mesher || !moveBalls(scene, motion, dims, 0)) {
+        fprintf(stderr, "Unknown mesher '%s' or motion '%s'\n", mesherName.c_str(), motion.c_str());
+        return false;
+    }
+
+    MetaballsField field;
+    std::vector<float> positions, normals;
+    std::vector<unsigned> indices;
+    Timing fieldTime, extractTime, normalsTime, totalTime;
+    double cellsVisited = 0.0, activeCells = 0.0, vertices = 0.0, triangles = 0.0;
+    unsigned maxVertices = 0, maxTriangles = 0;
+    size_t bufferBytes = 0;
+
+    for (int frame = -options.warmup; frame < options.frames; frame++) {
+        moveBalls(scene, motion, dims, std::max(frame, 0));
+
+        auto start = Clock::now();
+        field.setBalls(scene.centers, scene.radii);
+        field.evaluate(dims);
+        auto fieldEnd = Clock::now();
+        mesher->extract(field, positions, indices);
+        auto extractEnd = Clock::now();
+        IsoMesher::generateNormals(field, positions, normals);
+        auto end = Clock::now();
+
+        if (frame < 0) {
+            continue;
+        }
+        fieldTime.add(std::chrono::duration<double, std::milli>(fieldEnd - start).count());
+        extractTime.add(std::chrono::duration<double, std::milli>(extractEnd - fieldEnd).count());
+        normalsTime.add(std::chrono::duration<double, std::milli>(end - extractEnd).count());
+        totalTime.add(std::chrono::duration<double, std::milli>(end - start).count());
+
+        const IsoMesher::Stats & stats = mesher->getStats();
+        cellsVisited += stats.mCellsVisited;
+        activeCells += stats.mActiveCells;
+        vertices += stats.mVertices;
+        triangles += stats.mTriangles;
+        maxVertices = std::max(maxVertices, stats.mVertices);
+        maxTriangles = std::max(maxTriangles, stats.mTriangles);
+        bufferBytes = std::max(bufferBytes, (positions.capacity() + normals.capacity()) * sizeof(float) + indices.capacity() * sizeof(unsigned));
+    }
+
+    const int frames = options.frames;
+    fprintf(file, "%s    {\n", first ? "" : ",\n");
+    fprintf(file, "      \"dims\": %d,\n", dims);
+    fprintf(file, "      \"balls\": %d,\n", balls);
+    fprintf(file, "      \"motion\": \"%s\",\n", motion.c_str());
+    fprintf(file, "      \"mesher\": \"%s\",\n", mesher->getName());
+    fprintf(file, "      \"ms\": {\n");
+    writeTiming(file, "field", fieldTime, frames, false);
+    writeTiming(file, "extract", extractTime, frames, false);
+    writeTiming(file, "normals", normalsTime, frames, false);
+    writeTiming(file, "total", totalTime, frames, true);
+    fprintf(file, "      },\n");
+    fprintf(file, "      \"cellsVisited\": %.1f,\n", cellsVisited / frames);
+    fprintf(file, "      \"activeCells\": %.1f,\n", activeCells / frames);
+    fprintf(file, "      \"vertices\": %.1f,\n", vertices / frames);
+    fprintf(file, "      \"triangles\": %.1f,\n", triangles / frames);
+    fprintf(file, "      \"maxVertices\": %u,\n", maxVertices);
+    fprintf(file, "      \"maxTriangles\": %u,\n", maxTriangles);
+    fprintf(file, "      \"meshBufferBytes\": %zu,\n", bufferBytes);
+    fprintf(file, "      \"peakMemoryBytes\": %zu\n", getPeakMemory());
+    fprintf(file, "    }");
+    fflush(file);
+    return true;
+}
+
+template <typename T>
+std::vector<T> parseList(const char * arg, T (*convert)(const std::string &)) {
+    std::vector<T> values;
+    std::stringstream stream(arg);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            values.push_back(convert(item));
+        }
+    }
+    return values;
+}
+
+int toInt(const std::string & s) { return std::atoi(s.c_str()); }
+std::string toString(const std::string & s) { return s; }
+
+void printUsage() {
+    fprintf(stderr,
+        "BenchMetaballs [options]\n"
+        "  --dims 32,64,128          grid samples a side, 32 to 256\n"
+        "  --balls 16,64             ball counts\n"
+        "  --motion static,orbit,swarm\n"
+        "  --mesher mc,sn,dc         marching cubes, surface nets, dual contouring\n"
+        "  --seed 1234\n"
+        "  --frames 20               timed frames per run\n"
+        "  --warmup 2                untimed frames before them\n"
+        "  --out file.json           defaults to stdout\n");
+}
+
+int main(int argc, char ** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char * arg = argv[i];
+        const char * value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            printUsage();
+            return 1;
+        }
+        if (!strcmp(arg, "--dims")) {
+            options.dims = parseList<int>(value, toInt);
+        }
+        else if (!strcmp(arg, "--balls")) {
+            options.balls = parseList<int>(value, toInt);
+        }
+        else if (!strcmp(arg, "--motion")) {
+            options.motions = parseList<std::string>(value, toString);
+        }
+        else if (!strcmp(arg, "--mesher")) {
+            options.meshers = parseList<std::string>(value, toString);
+        }
+        else if (!strcmp(arg, "--seed")) {
+            options.seed = unsigned(std::strtoul(value, nullptr, 10));
+        }
+        else if (!strcmp(arg, "--frames")) {
+            options.frames = std::max(std::atoi(value), 1);
+        }
+        else if (!strcmp(arg, "--warmup")) {
+            options.warmup = std::max(std::atoi(value), 0);
+        }
+        else if (!strcmp(arg, "--out")) {
+            options.out = value;
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+        i++;
+    }
+    for (int dims : options.dims) {
+        if (dims < 32 || dims > 256) {
+            fprintf(stderr, "Dims %d is outside 32 to 256\n", dims);
+            return 1;
+        }
+    }
+
+    FILE * file = options.out ? fopen(options.out, "w") : stdout;
+    if (!file) {
+        fprintf(stderr, "Couldn't open %s\n", options.out);
+        return 1;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"seed\": %u,\n", options.seed);
+    fprintf(file, "  \"frames\": %d,\n", options.frames);
+    fprintf(file, "  \"threads\": %u,\n", ThreadPool::getNumThreads());
+    fprintf(file, "  \"simdWidth\": %d,\n", int(simd::Width));
+    fprintf(file, "  \"runs\": [\n");
+    bool first = true;
+    bool ok = true;
+    for (int dims : options.dims) {
+        for (int balls : options.balls) {
+            for (auto & motion : options.motions) {
+                for (auto & mesher : options.meshers) {
+                    ok = ok && runBenchmark(file, options, dims, balls, motion, mesher, first);
+                    first = false;
+                }
+            }
+        }
+    }
+    fprintf(file, "\n  ]\n}\n");
+
+    if (options.out) {
+        fclose(file);
+    }
+    ThreadPool::shutDown();
+    return ok ? 0 : 1;
+}
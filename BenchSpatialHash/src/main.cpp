@@ -0,0 +1,271 @@
+#include "Spatial/SpatialHash.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace neo;
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Options {
+    unsigned points = 100000;
+    /* Of each query type, per frame */
+    unsigned queries = 200;
+    float radius = 4.f;
+    unsigned k = 16;
+    float cellSize = 4.f;
+    /* Points per unit^3 */
+    float density = 0.5f;
+    /* Fraction of the points that move each frame, and how far */
+    float moving = 0.5f;
+    float speed = 0.5f;
+    /* Fraction of the points removed and reinserted elsewhere each frame */
+    float churn = 0.01f;
+    unsigned seed = 1234;
+    int frames = 20;
+};
+
+/* Every live point, what SpatialHash should be holding */
+struct Scene {
+    float halfWorld;
+    std::vector<glm::vec3> positions;
+    std::vector<bool> live;
+};
+
+/* Milliseconds spent in each query type, hashed and brute force */
+struct Timings {
+    double hash[3] = { 0.0, 0.0, 0.0 };
+    double brute[3] = { 0.0, 0.0, 0.0 };
+};
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+bool sameIDs(std::vector<unsigned> & a, std::vector<unsigned> & b) {
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    return a == b;
+}
+
+/* Ties can come back in either order, so only the distances have to agree, and the ids wherever the
+ * distances don't tie */
+bool sameNearest(const std::vector<std::pair<unsigned, float>> & a, const std::vector<std::pair<unsigned, float>> & b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::abs(a[i].second - b[i].second) > 1e-4f * std::max(1.f, b[i].second)) {
+            return false;
+        }
+        const bool tied = (i > 0 && b[i - 1].second == b[i].second) || (i + 1 < b.size() && b[i + 1].second == b[i].second);
+        if (!tied && a[i].first != b[i].first) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void printUsage() {
+    fprintf(stderr,
+        "BenchSpatialHash [options]\n"
+        "  --points 100000\n"
+        "  --queries 200             of each type per frame\n"
+        "  --radius 4                radius and AABB half size\n"
+        "  --k 16                    nearest neighbours\n"
+        "  --cell 4                  cell size\n"
+        "  --density 0.5             points per unit^3\n"
+        "  --moving 0.5              fraction of points moving each frame\n"
+        "  --speed 0.5               units moved per frame\n"
+        "  --churn 0.01              fraction removed and reinserted each frame\n"
+        "  --seed 1234\n"
+        "  --frames 20\n");
+}
+
+int main(int argc, char ** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char * arg = argv[i];
+        const char * value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            printUsage();
+            return 1;
+        }
+        if (!strcmp(arg, "--points")) {
+            options.points = unsigned(std::max(std::atoi(value), 1));
+        }
+        else if (!strcmp(arg, "--queries")) {
+            options.queries = unsigned(std::max(std::atoi(value), 1));
+        }
+        else if (!strcmp(arg, "--radius")) {
+            options.radius = std::max(float(std::atof(value)), 0.f);
+        }
+        else if (!strcmp(arg, "--k")) {
+            options.k = unsigned(std::max(std::atoi(value), 0));
+        }
+        else if (!strcmp(arg, "--cell")) {
+            options.cellSize = std::max(float(std::atof(value)), 1e-3f);
+        }
+        else if (!strcmp(arg, "--density")) {
+            options.density = std::max(float(std::atof(value)), 1e-6f);
+        }
+        else if (!strcmp(arg, "--moving")) {
+            options.moving = glm::clamp(float(std::atof(value)), 0.f, 1.f);
+        }
+        else if (!strcmp(arg, "--speed")) {
+            options.speed = float(std::atof(value));
+        }
+        else if (!strcmp(arg, "--churn")) {
+            options.churn = glm::clamp(float(std::atof(value)), 0.f, 1.f);
+        }
+        else if (!strcmp(arg, "--seed")) {
+            options.seed = unsigned(std::strtoul(value, nullptr, 10));
+        }
+        else if (!strcmp(arg, "--frames")) {
+            options.frames = std::max(std::atoi(value), 1);
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+        i++;
+    }
+
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    std::uniform_real_distribution<float> chance(0.f, 1.f);
+
+    Scene scene;
+    scene.halfWorld = 0.5f * std::cbrt(options.points / options.density);
+    auto randomPosition = [&]() {
+        return glm::vec3(unit(rng), unit(rng), unit(rng)) * scene.halfWorld;
+    };
+
+    SpatialHash hash(options.cellSize);
+    auto start = Clock::now();
+    for (unsigned id = 0; id < options.points; id++) {
+        scene.positions.push_back(randomPosition());
+        scene.live.push_back(true);
+        hash.insert(id, scene.positions.back());
+    }
+    const double insertMs = msSince(start);
+
+    Timings timings;
+    double updateMs = 0.0;
+    unsigned mismatches[3] = { 0, 0, 0 };
+    double results[3] = { 0.0, 0.0, 0.0 };
+    std::vector<unsigned> hashIDs, bruteIDs;
+    std::vector<std::pair<unsigned, float>> hashNearest, bruteNearest;
+    std::vector<std::pair<float, unsigned>> distances;
+
+    for (int frame = 0; frame < options.frames; frame++) {
+        /* Move some points, and take others out and put them back somewhere else, so freed ids get reused */
+        start = Clock::now();
+        for (unsigned id = 0; id < options.points; id++) {
+            if (chance(rng) < options.churn) {
+                if (scene.live[id]) {
+                    hash.remove(id);
+                    scene.live[id] = false;
+                }
+                else {
+                    scene.positions[id] = randomPosition();
+                    scene.live[id] = true;
+                    hash.insert(id, scene.positions[id]);
+                }
+            }
+            else if (scene.live[id] && chance(rng) < options.moving) {
+                scene.positions[id] = glm::clamp(scene.positions[id] + glm::vec3(unit(rng), unit(rng), unit(rng)) * options.speed,
+                    glm::vec3(-scene.halfWorld), glm::vec3(scene.halfWorld));
+                hash.update(id, scene.positions[id]);
+            }
+        }
+        updateMs += msSince(start);
+
+        for (unsigned query = 0; query < options.queries; query++) {
+            /* Centers reach a little outside the points, so the edges get queried too */
+            const glm::vec3 center = randomPosition() * 1.1f;
+            const float radius2 = options.radius * options.radius;
+            const glm::vec3 min = center - glm::vec3(options.radius);
+            const glm::vec3 max = center + glm::vec3(options.radius);
+
+            hashIDs.clear();
+            start = Clock::now();
+            hash.queryRadius(center, options.radius, hashIDs);
+            timings.hash[0] += msSince(start);
+            bruteIDs.clear();
+            start = Clock::now();
+            for (unsigned id = 0; id < options.points; id++) {
+                const glm::vec3 d = scene.positions[id] - center;
+                if (scene.live[id] && glm::dot(d, d) <= radius2) {
+                    bruteIDs.push_back(id);
+                }
+            }
+            timings.brute[0] += msSince(start);
+            results[0] += double(bruteIDs.size());
+            mismatches[0] += !sameIDs(hashIDs, bruteIDs);
+
+            hashIDs.clear();
+            start = Clock::now();
+            hash.queryAABB(min, max, hashIDs);
+            timings.hash[1] += msSince(start);
+            bruteIDs.clear();
+            start = Clock::now();
+            for (unsigned id = 0; id < options.points; id++) {
+                const glm::vec3 & p = scene.positions[id];
+                if (scene.live[id] && p.x >= min.x && p.y >= min.y && p.z >= min.z && p.x <= max.x && p.y <= max.y && p.z <= max.z) {
+                    bruteIDs.push_back(id);
+                }
+            }
+            timings.brute[1] += msSince(start);
+            results[1] += double(bruteIDs.size());
+            mismatches[1] += !sameIDs(hashIDs, bruteIDs);
+
+            hashNearest.clear();
+            start = Clock::now();
+            hash.queryNearest(center, options.k, hashNearest);
+            timings.hash[2] += msSince(start);
+            bruteNearest.clear();
+            start = Clock::now();
+            distances.clear();
+            for (unsigned id = 0; id < options.points; id++) {
+                if (scene.live[id]) {
+                    const glm::vec3 d = scene.positions[id] - center;
+                    distances.emplace_back(glm::dot(d, d), id);
+                }
+            }
+            const size_t k = std::min(size_t(options.k), distances.size());
+            std::partial_sort(distances.begin(), distances.begin() + k, distances.end());
+            for (size_t i = 0; i < k; i++) {
+                bruteNearest.emplace_back(distances[i].second, std::sqrt(distances[i].first));
+            }
+            timings.brute[2] += msSince(start);
+            results[2] += double(bruteNearest.size());
+            mismatches[2] += !sameNearest(hashNearest, bruteNearest);
+        }
+    }
+
+    const double queries = double(options.queries) * options.frames;
+    const char * names[3] = { "radius ", "AABB   ", "nearest" };
+    printf("%u points, density %.3f, cell %.2f, radius %.2f, k %u, seed %u\n",
+        options.points, options.density, options.cellSize, options.radius, options.k, options.seed);
+    printf("insert        %8.3f ms\n", insertMs);
+    printf("move/churn    %8.3f ms mean over %d frames, %u cells at the end\n", updateMs / options.frames, options.frames, hash.getNumCells());
+    for (int type = 0; type < 3; type++) {
+        printf("%s       %8.4f ms hashed, %8.4f ms brute force per query, %8.1f results, %u mismatches\n",
+            names[type], timings.hash[type] / queries, timings.brute[type] / queries, results[type] / queries, mismatches[type]);
+    }
+
+    const unsigned failed = mismatches[0] + mismatches[1] + mismatches[2];
+    if (failed) {
+        printf("FAILED: %u of %u queries differ from brute force\n", failed, unsigned(queries) * 3);
+        return 1;
+    }
+    return 0;
+}
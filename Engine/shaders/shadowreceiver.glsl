@@ -22,4 +22,14 @@ float getShadowVisibility(int pcfSize, sampler2D shadowMap, vec4 shadowCoord, fl
     }
 
     return visibility;
-}
\ No newline at end of file
+}
+
+// Cascade whose slice holds viewDepth, given the view depth where each one ends. -1 past the last
+int getShadowCascade(float viewDepth, vec4 splits, int numCascades) {
+    for (int i = 0; i < numCascades; i++) {
+        if (viewDepth <= splits[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -18,14 +18,15 @@ namespace neo {
         mViewMat(),
         mProjMat(),
         mViewMatDirty(true),
-        mProjMatDirty(true)
+        mProjMatDirty(true),
+        mSpatialReceiver()
     {}
 
     void CameraComponent::init() {
         mViewMatDirty = true;
         mProjMatDirty = true;
 
-        Messenger::addReceiver<SpatialChangeMessage>(mGameObject, [&](const Message & msg_) {
+        mSpatialReceiver = Messenger::addReceiver<SpatialChangeMessage>(mGameObject, [&](const SpatialChangeMessage & msg) {
             mViewMatDirty = true;
         });
     }
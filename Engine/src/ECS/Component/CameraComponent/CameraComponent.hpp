@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ECS/Component/Component.hpp"
+#include "Messaging/Messenger.hpp"
 
 #include <glm/glm.hpp>
 
@@ -35,6 +36,8 @@ namespace neo {
             mutable bool mViewMatDirty;
             mutable bool mProjMatDirty;
 
+        private:
+            Subscription mSpatialReceiver;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "ECS/Component/Component.hpp"
+#include "ECS/Component/CameraComponent/FrustumComponent.hpp"
+
+#include <glm/glm.hpp>
+#include "ext/imgui/imgui.h"
+
+#include <vector>
+
+namespace neo {
+
+    /* Splits the shadow camera's map into cascades along the source camera's view depth. Goes next to a
+     * FrustumFitReceiverComponent -- FrustaFittingSystem fits every cascade and FrustumCulling culls casters
+     * against each one. The cascades share the shadow map as a grid of mResolution tiles */
+    class CascadedShadowComponent : public Component {
+
+        public:
+            static const int MaxCascades = 4;
+
+            struct Cascade {
+                glm::mat4 mProj = glm::mat4(1.f);
+                glm::mat4 mView = glm::mat4(1.f);
+                /* View depth where this cascade ends */
+                float mSplit = 0.f;
+                /* Culled like any camera's frustum */
+                FrustumComponent mFrustum;
+
+                Cascade(GameObject *go) : mFrustum(go) {}
+            };
+
+            int mNumCascades;
+            /* Texels per side of each cascade's tile */
+            int mResolution;
+            /* Blend between uniform (0) and logarithmic (1) splits */
+            float mLambda;
+            /* How far behind each cascade casters still count */
+            float mCasterDepth;
+            std::vector<Cascade> mCascades;
+
+            CascadedShadowComponent(GameObject *go, int numCascades = MaxCascades, int resolution = 1024, float lambda = 0.75f, float casterDepth = 50.f) :
+                Component(go),
+                mNumCascades(numCascades),
+                mResolution(resolution),
+                mLambda(lambda),
+                mCasterDepth(casterDepth)
+            {
+                mCascades.reserve(MaxCascades);
+                for (int i = 0; i < MaxCascades; i++) {
+                    mCascades.emplace_back(go);
+                }
+            }
+
+            /* Grid of tiles in the shadow map */
+            glm::ivec2 getGrid() const {
+                return glm::ivec2(mNumCascades > 1 ? 2 : 1, mNumCascades > 2 ? 2 : 1);
+            }
+
+            /* Tile of a cascade in texels */
+            glm::ivec2 getTileOffset(int cascade) const {
+                return glm::ivec2(cascade % getGrid().x, cascade / getGrid().x) * mResolution;
+            }
+
+            virtual void imGuiEditor() override {
+                ImGui::SliderInt("Cascades", &mNumCascades, 1, MaxCascades);
+                ImGui::SliderFloat("Lambda", &mLambda, 0.f, 1.f);
+                ImGui::SliderFloat("Caster depth", &mCasterDepth, 0.f, 200.f);
+                for (int i = 0; i < mNumCascades; i++) {
+                    ImGui::Text("Cascade %d: %0.2f", i, mCascades[i].mSplit);
+                }
+            }
+    };
+}
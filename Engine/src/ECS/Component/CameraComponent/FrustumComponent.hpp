@@ -1,10 +1,17 @@
 #pragma once
 
 #include "ECS/Component/Component.hpp"
+#include "ECS/GameObject.hpp"
+
+#include <vector>
+#include <cstdint>
 
 namespace neo {
 
     class FrustumComponent : public Component {
+
+        friend class FrustumCulling;
+
         public:
             FrustumComponent(GameObject *go) :
                 Component(go)
@@ -28,6 +35,16 @@ namespace neo {
             glm::vec4 mNear;
             glm::vec4 mFar;
 
+            /* Extracts the planes from a projection * view matrix */
+            void setPlanes(const glm::mat4 & PV) {
+                mLeft = _normalizePlane(glm::vec4(PV[0][3] + PV[0][0], PV[1][3] + PV[1][0], PV[2][3] + PV[2][0], PV[3][3] + PV[3][0]));
+                mRight = _normalizePlane(glm::vec4(PV[0][3] - PV[0][0], PV[1][3] - PV[1][0], PV[2][3] - PV[2][0], PV[3][3] - PV[3][0]));
+                mBottom = _normalizePlane(glm::vec4(PV[0][3] + PV[0][1], PV[1][3] + PV[1][1], PV[2][3] + PV[2][1], PV[3][3] + PV[3][1]));
+                mTop = _normalizePlane(glm::vec4(PV[0][3] - PV[0][1], PV[1][3] - PV[1][1], PV[2][3] - PV[2][1], PV[3][3] - PV[3][1]));
+                mFar = _normalizePlane(glm::vec4(PV[0][3] - PV[0][2], PV[1][3] - PV[1][2], PV[2][3] - PV[2][2], PV[3][3] - PV[3][2]));
+                mNear = _normalizePlane(glm::vec4(PV[0][2], PV[1][2], PV[2][2], PV[3][2]));
+            }
+
             // Test if an object is inside the frustum
             bool isInFrustum(const glm::vec3 position, const float radius) {
                 return _distanceToPlane(mLeft, position)   > -radius &&
@@ -38,7 +55,34 @@ namespace neo {
                        _distanceToPlane(mFar, position)    > -radius;
             }
 
+            /* Culling result from FrustumCulling, one bit per GameObject ID. Empty until the first pass */
+            std::vector<uint64_t> mVisibility;
+
+            /* Objects OcclusionCulling found hidden behind occluders, one bit per GameObject ID */
+            std::vector<uint64_t> mOccluded;
+
+            bool isVisible(const GameObject & go) const {
+                const unsigned id = go.getID();
+                if (id / 64 < mOccluded.size() && ((mOccluded[id / 64] >> (id % 64)) & 1)) {
+                    return false;
+                }
+                if (id / 64 >= mVisibility.size()) {
+                    return true;
+                }
+                return (mVisibility[id / 64] >> (id % 64)) & 1;
+            }
+
         private:
+            /* Culling state kept between frames, by SceneBVH slot -- the last plane that rejected each object,
+             * and last pass's result */
+            std::vector<uint8_t> mRejectingPlane;
+            std::vector<uint64_t> mSlotVisibility;
+            glm::vec4 mCulledPlanes[6];
+            unsigned mCulledPass = 0;
+
+            static glm::vec4 _normalizePlane(const glm::vec4 & plane) {
+                return plane / glm::length(glm::vec3(plane));
+            }
 
             float _distanceToPlane(glm::vec4 plane, glm::vec3 position) {
                 return plane.x * position.x + plane.y * position.y + plane.z * position.z + plane.w;
@@ -10,8 +10,7 @@ namespace neo {
 
     MainCameraComponent::MainCameraComponent(GameObject *gameObject) :
         Component(gameObject) {
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [](const Message& _msg) {
-                const WindowFrameSizeMessage& msg = static_cast<const WindowFrameSizeMessage &>(_msg);
+            mFrameSizeReceiver = Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [](const WindowFrameSizeMessage &msg) {
                 auto comp = Engine::getSingleComponent<MainCameraComponent>();
                 if (auto camera = dynamic_cast<PerspectiveCameraComponent*>(comp->getGameObject().getComponentByType<CameraComponent>())) {
                     camera->setAspectRatio(Window::getAspectRatio());
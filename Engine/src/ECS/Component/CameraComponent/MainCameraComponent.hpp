@@ -1,11 +1,15 @@
 #pragma once
 
 #include "ECS/Component/Component.hpp"
+#include "Messaging/Messenger.hpp"
 
 namespace neo {
 
     class MainCameraComponent : public Component {
     public:
         MainCameraComponent(GameObject *go);
+
+    private:
+        Subscription mFrameSizeReceiver;
     };
 }
\ No newline at end of file
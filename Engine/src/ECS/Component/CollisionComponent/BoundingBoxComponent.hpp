@@ -5,6 +5,9 @@
 #include "ECS/Component/SpatialComponent/SpatialComponent.hpp"
 
 #include "Renderer/GLObjects/Mesh.hpp"
+#include "Messaging/Messenger.hpp"
+#include "Spatial/SceneBVH.hpp"
+#include "Spatial/WorldBounds.hpp"
 
 #include <glm/glm.hpp>
 #include "glm/gtc/matrix_transform.hpp"
@@ -12,17 +15,37 @@
 namespace neo {
 
     class BoundingBoxComponent : public Component {
+
+        friend SceneBVH;
+
     public:
+        /* Local bounds. Change them through setBounds so the world bounds follow */
         glm::vec3 mMin, mMax;
 
         BoundingBoxComponent(GameObject *go) :
             Component(go),
             mMin(0.f),
-            mMax(0.f) {
+            mMax(0.f),
+            mSceneIndex(~0u),
+            mSpatialReceiver() {
+        }
+
+        /* SceneBVH and the receiver hold on to this */
+        BoundingBoxComponent(BoundingBoxComponent &&) = delete;
+
+        virtual void init() override {
+            SceneBVH::insert(*this);
+            mSpatialReceiver = Messenger::addReceiver<SpatialChangeMessage>(mGameObject, [this](const SpatialChangeMessage &) {
+                SceneBVH::markMoved(*this);
+            });
+        }
+
+        virtual void kill() override {
+            SceneBVH::remove(*this);
         }
 
         BoundingBoxComponent(GameObject *go, std::vector<glm::vec3>& vertices) :
-            Component(go) {
+            BoundingBoxComponent(go) {
             mMin = glm::vec3(FLT_MAX);
             mMax = glm::vec3(FLT_MIN);
 
@@ -40,15 +63,47 @@ namespace neo {
             mMax = mesh.mMax;
         }
 
+        void setBounds(const glm::vec3 & min, const glm::vec3 & max) {
+            mMin = min;
+            mMax = max;
+            SceneBVH::markMoved(*this);
+        }
+
         float getRadius() const {
             return glm::distance(mMin, mMax) / 2.f;
         }
 
+        /* World space bounds, cached in WorldBounds and current as of the last SceneBVH::update */
+        glm::vec3 getWorldMin() const { return WorldBounds::getMin(mSceneIndex); }
+        glm::vec3 getWorldMax() const { return WorldBounds::getMax(mSceneIndex); }
+        glm::vec3 getWorldCenter() const { return WorldBounds::getCenter(mSceneIndex); }
+        glm::vec3 getWorldExtent() const { return WorldBounds::getExtent(mSceneIndex); }
+        float getWorldRadius() const { return WorldBounds::getRadius(mSceneIndex); }
+
+        /* Is the world space point inside the box */
         bool intersect(const glm::vec3 position) const {
-            auto spatial = mGameObject->getComponentByType<SpatialComponent>();
-            NEO_ASSERT(spatial, "BoundingBox has no SpatialComponent");
-            // TODO - this is broke?
-            return glm::length(glm::vec3(glm::inverse(spatial->getModelMatrix()) * glm::vec4(position, 1.f))) < getRadius();
+            const glm::vec3 local = _toLocal(glm::vec4(position, 1.f));
+            return glm::all(glm::greaterThanEqual(local, mMin)) && glm::all(glm::lessThanEqual(local, mMax));
+        }
+
+        /* Where the world space ray enters the box, or -1 if it misses before maxDist. The ray is taken into
+         * object space through the cached inverse transform, so rotated and scaled boxes are exact. Distances
+         * are in units of dir */
+        float intersect(const glm::vec3 & origin, const glm::vec3 & dir, float maxDist = FLT_MAX) const {
+            const glm::vec3 localDir = _toLocal(glm::vec4(dir, 0.f));
+            return BVH::intersectRay(mMin, mMax, _toLocal(glm::vec4(origin, 1.f)), 1.f / localDir, maxDist);
+        }
+
+    private:
+        /* Slot in the SceneBVH */
+        unsigned mSceneIndex;
+        Subscription mSpatialReceiver;
+
+        glm::vec3 _toLocal(const glm::vec4 & world) const {
+            if (auto spatial = mGameObject->getComponentByType<SpatialComponent>()) {
+                return glm::vec3(spatial->getInverseModelMatrix() * world);
+            }
+            return glm::vec3(world);
         }
     };
 }
\ No newline at end of file
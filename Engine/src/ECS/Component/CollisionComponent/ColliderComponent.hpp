@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ECS/Component/Component.hpp"
+#include "Spatial/SweepAndPrune.hpp"
+
+namespace neo {
+
+    /* Makes an object collide with other colliders -- see CollisionSystem. The shape is taken from the
+     * object's BoundingBoxComponent, which it needs: its world AABB, its bounding sphere, or its box oriented
+     * with the object */
+    class ColliderComponent : public Component {
+        public:
+            using Shape = SweepAndPrune::Shape;
+
+            Shape mShape;
+
+            ColliderComponent(GameObject *go, Shape shape = Shape::AABB) :
+                Component(go),
+                mShape(shape)
+            {}
+    };
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ECS/Component/Component.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace neo {
+
+    /* Simplified geometry that OcclusionCulling rasterizes to hide whatever is behind it. It has to stay
+     * inside the object it stands in for, or it will hide things that should show -- an inner box or a handful
+     * of big triangles is plenty. Object space, placed by the GameObject's SpatialComponent */
+    class OccluderComponent : public Component {
+        public:
+            std::vector<glm::vec3> mVertices;
+            /* Triangle list */
+            std::vector<unsigned> mIndices;
+
+            OccluderComponent(GameObject *go, const std::vector<glm::vec3> & vertices, const std::vector<unsigned> & indices) :
+                Component(go),
+                mVertices(vertices),
+                mIndices(indices)
+            {}
+
+            /* Box occluder */
+            OccluderComponent(GameObject *go, const glm::vec3 & min, const glm::vec3 & max) :
+                Component(go),
+                mVertices({
+                    { min.x, min.y, min.z }, { max.x, min.y, min.z }, { max.x, max.y, min.z }, { min.x, max.y, min.z },
+                    { min.x, min.y, max.z }, { max.x, min.y, max.z }, { max.x, max.y, max.z }, { min.x, max.y, max.z } }),
+                mIndices({
+                    0, 2, 1,  0, 3, 2,
+                    4, 5, 6,  4, 6, 7,
+                    0, 1, 5,  0, 5, 4,
+                    3, 7, 6,  3, 6, 2,
+                    0, 4, 7,  0, 7, 3,
+                    1, 2, 6,  1, 6, 5 })
+            {}
+    };
+}
@@ -2,10 +2,13 @@
 #include "SpatialComponent.hpp"
 
 #include "Messaging/Messenger.hpp"
+#include "Util/SIMD.hpp"
+#include "Util/ThreadPool.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 
 #include "ext/imgui/imgui.h"
+#include "ext/microprofile.h"
 
 namespace neo {
 
@@ -16,8 +19,10 @@ namespace neo {
         mScale(1.f),
         mModelMatrix(),
         mNormalMatrix(),
+        mInverseModelMatrix(),
         mModelMatrixDirty(true),
-        mNormalMatrixDirty(true)
+        mNormalMatrixDirty(true),
+        mInverseModelMatrixDirty(true)
     {}
 
     SpatialComponent::SpatialComponent(GameObject *go, const glm::vec3 & p) :
@@ -52,6 +57,7 @@ namespace neo {
 
         mPosition += delta;
         mModelMatrixDirty = true;
+        mInverseModelMatrixDirty = true;
         Messenger::sendMessage<SpatialChangeMessage>(mGameObject, *this);
     }
 
@@ -62,6 +68,7 @@ namespace neo {
 
         mScale *= glm::clamp(factor, glm::vec3(0.f), factor);
         mModelMatrixDirty = true;
+        mInverseModelMatrixDirty = true;
         mNormalMatrixDirty = true;
         Messenger::sendMessage<SpatialChangeMessage>(mGameObject, *this);
     }
@@ -69,6 +76,15 @@ namespace neo {
     void SpatialComponent::rotate(const glm::mat3 & mat) {
         Orientable::rotate(mat);
         mModelMatrixDirty = true;
+        mInverseModelMatrixDirty = true;
+        mNormalMatrixDirty = true;
+        Messenger::sendMessage<SpatialChangeMessage>(mGameObject, *this);
+    }
+
+    void SpatialComponent::rotate(const glm::quat & q) {
+        Orientable::rotate(q);
+        mModelMatrixDirty = true;
+        mInverseModelMatrixDirty = true;
         mNormalMatrixDirty = true;
         Messenger::sendMessage<SpatialChangeMessage>(mGameObject, *this);
     }
@@ -80,6 +96,7 @@ namespace neo {
 
         mPosition = loc;
         mModelMatrixDirty = true;
+        mInverseModelMatrixDirty = true;
         Messenger::sendMessage<SpatialChangeMessage>(mGameObject, *this);
     }
 
@@ -90,6 +107,7 @@ namespace neo {
 
         this->mScale = scale;
         mModelMatrixDirty = true;
+        mInverseModelMatrixDirty = true;
         mNormalMatrixDirty = true;
         Messenger::sendMessage<SpatialChangeMessage>(mGameObject, *this);
     }
@@ -101,6 +119,15 @@ namespace neo {
     void SpatialComponent::setOrientation(const glm::mat3 & orient) {
         Orientable::setOrientation(orient);
         mModelMatrixDirty = true;
+        mInverseModelMatrixDirty = true;
+        mNormalMatrixDirty = true;
+        Messenger::sendMessage<SpatialChangeMessage>(mGameObject, *this);
+    }
+
+    void SpatialComponent::setOrientation(const glm::quat & orient) {
+        Orientable::setOrientation(orient);
+        mModelMatrixDirty = true;
+        mInverseModelMatrixDirty = true;
         mNormalMatrixDirty = true;
         Messenger::sendMessage<SpatialChangeMessage>(mGameObject, *this);
     }
@@ -108,12 +135,14 @@ namespace neo {
     void SpatialComponent::setUVW(const glm::vec3 & u, const glm::vec3 & v, const glm::vec3 & w) {
         Orientable::setUVW(u, v, w);
         mModelMatrixDirty = true;
+        mInverseModelMatrixDirty = true;
         mNormalMatrixDirty = true;
         Messenger::sendMessage<SpatialChangeMessage>(mGameObject, *this);
     }
 
     void SpatialComponent::setDirty() {
         mModelMatrixDirty = true;
+        mInverseModelMatrixDirty = true;
         mNormalMatrixDirty = true;
     }
         
@@ -131,21 +160,129 @@ namespace neo {
         return mNormalMatrix;
     }
 
+    const glm::mat4 & SpatialComponent::getInverseModelMatrix() const {
+        if (mInverseModelMatrixDirty) {
+            _detInverseModelMatrix();
+        }
+        return mInverseModelMatrix;
+    }
+
     void SpatialComponent::_detModelMatrix() const {
-        mModelMatrix = glm::scale(glm::translate(glm::mat4(), mPosition) * glm::mat4(getOrientation()), mScale);
+        /* translate * orientation * scale, written out -- the upper 3x3 is each orientation column times its scale */
+        const glm::mat3 & orientation = getOrientation();
+        for (int col = 0; col < 3; col++) {
+            mModelMatrix[col] = glm::vec4(orientation[col] * mScale[col], 0.f);
+        }
+        mModelMatrix[3] = glm::vec4(mPosition, 1.f);
         mModelMatrixDirty = false;
     }
 
     void SpatialComponent::_detNormalMatrix() const {
-        if (mScale.x == mScale.y && mScale.y == mScale.z) {
-            mNormalMatrix = glm::mat3(getModelMatrix());
-        }
-        else {
-            mNormalMatrix = getOrientation() * glm::mat3(glm::scale(glm::mat4(), 1.0f / mScale));
+        /* orientation / scale, or the model's 3x3 when scale is uniform */
+        const glm::mat3 & orientation = getOrientation();
+        const bool uniform = mScale.x == mScale.y && mScale.y == mScale.z;
+        for (int col = 0; col < 3; col++) {
+            mNormalMatrix[col] = orientation[col] * (uniform ? mScale[col] : 1.f / mScale[col]);
         }
         mNormalMatrixDirty = false;
     }
 
+    void SpatialComponent::_detInverseModelMatrix() const {
+        /* Undo translate, rotate, scale in reverse -- no general inverse needed */
+        const glm::mat3 inverseRS = glm::mat3(glm::scale(glm::mat4(), 1.f / mScale)) * glm::transpose(getOrientation());
+        mInverseModelMatrix = glm::mat4(inverseRS);
+        mInverseModelMatrix[3] = glm::vec4(-(inverseRS * mPosition), 1.f);
+        mInverseModelMatrixDirty = false;
+    }
+
+    void SpatialComponent::updateMatrices(const std::vector<SpatialComponent *> & spatials) {
+        MICROPROFILE_SCOPEI("SpatialComponent", "updateMatrices", MP_AUTO);
+#ifdef NEO_QUAT_ORIENTATION
+        /* A SIMD batch of dirty spatials at a time. Each lane only reads its quaternion and scale, and expands the
+         * quaternion to the rotation columns the same way glm::mat3_cast does */
+        auto build = [](const SpatialComponent * const * batch, unsigned lanes) {
+            float in[7][simd::Width];
+            for (unsigned lane = 0; lane < simd::Width; lane++) {
+                const glm::quat q = lane < lanes ? batch[lane]->getQuaternion() : glm::quat(1.f, 0.f, 0.f, 0.f);
+                const glm::vec3 scale = lane < lanes ? batch[lane]->mScale : glm::vec3(1.f);
+                in[0][lane] = q.x;
+                in[1][lane] = q.y;
+                in[2][lane] = q.z;
+                in[3][lane] = q.w;
+                for (int axis = 0; axis < 3; axis++) {
+                    in[4 + axis][lane] = scale[axis];
+                }
+            }
+
+            const simd::vfloat one = simd::set1(1.f);
+            const simd::vfloat x = simd::load(in[0]), y = simd::load(in[1]), z = simd::load(in[2]), w = simd::load(in[3]);
+            const simd::vfloat x2 = x + x, y2 = y + y, z2 = z + z;
+            const simd::vfloat xx = x * x2, yy = y * y2, zz = z * z2;
+            const simd::vfloat xy = x * y2, xz = x * z2, yz = y * z2;
+            const simd::vfloat wx = w * x2, wy = w * y2, wz = w * z2;
+            const simd::vfloat orientation[9] = {
+                one - (yy + zz), xy + wz, xz - wy,
+                xy - wz, one - (xx + zz), yz + wx,
+                xz + wy, yz - wx, one - (xx + yy)
+            };
+
+            /* Model columns are orientation times scale, normal columns orientation over scale unless it's uniform */
+            const simd::vfloat scale[3] = { simd::load(in[4]), simd::load(in[5]), simd::load(in[6]) };
+            const simd::vfloat uniform = (scale[0] == scale[1]) & (scale[1] == scale[2]);
+            float model[9][simd::Width], normal[9][simd::Width];
+            for (int col = 0; col < 3; col++) {
+                const simd::vfloat normalScale = simd::select(uniform, scale[col], one / scale[col]);
+                for (int row = 0; row < 3; row++) {
+                    simd::store(model[col * 3 + row], orientation[col * 3 + row] * scale[col]);
+                    simd::store(normal[col * 3 + row], orientation[col * 3 + row] * normalScale);
+                }
+            }
+
+            for (unsigned lane = 0; lane < lanes; lane++) {
+                const SpatialComponent & spatial = *batch[lane];
+                for (int col = 0; col < 3; col++) {
+                    spatial.mModelMatrix[col] = glm::vec4(model[col * 3][lane], model[col * 3 + 1][lane], model[col * 3 + 2][lane], 0.f);
+                    spatial.mNormalMatrix[col] = glm::vec3(normal[col * 3][lane], normal[col * 3 + 1][lane], normal[col * 3 + 2][lane]);
+                }
+                spatial.mModelMatrix[3] = glm::vec4(spatial.mPosition, 1.f);
+                spatial.mModelMatrixDirty = false;
+                spatial.mNormalMatrixDirty = false;
+            }
+        };
+
+        ThreadPool::parallelFor(unsigned(spatials.size()), 1024, [&spatials, &build](unsigned begin, unsigned end) {
+            const SpatialComponent * batch[simd::Width];
+            unsigned lanes = 0;
+            for (unsigned i = begin; i < end; i++) {
+                const SpatialComponent * spatial = spatials[i];
+                if (!spatial->mModelMatrixDirty && !spatial->mNormalMatrixDirty) {
+                    continue;
+                }
+                batch[lanes++] = spatial;
+                if (lanes == simd::Width) {
+                    build(batch, lanes);
+                    lanes = 0;
+                }
+            }
+            if (lanes) {
+                build(batch, lanes);
+            }
+        });
+#else
+        ThreadPool::parallelFor(unsigned(spatials.size()), 1024, [&spatials](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end; i++) {
+                const SpatialComponent & spatial = *spatials[i];
+                if (spatial.mModelMatrixDirty) {
+                    spatial._detModelMatrix();
+                }
+                if (spatial.mNormalMatrixDirty) {
+                    spatial._detNormalMatrix();
+                }
+            }
+        });
+#endif
+    }
+
     void SpatialComponent::imGuiEditor() {
         glm::vec3 moveAmount(0.f);
         glm::vec3 scaleAmount(1.f);
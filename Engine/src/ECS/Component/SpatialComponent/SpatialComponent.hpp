@@ -5,6 +5,8 @@
 
 #include <glm/glm.hpp>
 
+#include <vector>
+
 namespace neo {
 
     class SpatialComponent : public Component, public Orientable {
@@ -23,6 +25,7 @@ namespace neo {
             void move(const glm::vec3 &);
             void resize(const glm::vec3 &);
             void rotate(const glm::mat3 &);
+            void rotate(const glm::quat &);
             virtual void imGuiEditor() override;
 
             /* Setters */
@@ -30,6 +33,7 @@ namespace neo {
             void setScale(const glm::vec3 &);
             void setScale(const float);
             void setOrientation(const glm::mat3 &);
+            void setOrientation(const glm::quat &);
             void setUVW(const glm::vec3 &, const glm::vec3 &, const glm::vec3 &);
             void setDirty();
 
@@ -38,6 +42,12 @@ namespace neo {
             const glm::vec3 getScale() const { return mScale; }
             const glm::mat4 & getModelMatrix() const;
             const glm::mat3 & getNormalMatrix() const;
+            /* World to object space. Cached like the model matrix */
+            const glm::mat4 & getInverseModelMatrix() const;
+
+            /* Rebuilds every dirty model and normal matrix across the ThreadPool. Run once before rendering so draw
+             * loops only read cached matrices -- the getters still fall back to building one lazily */
+            static void updateMatrices(const std::vector<SpatialComponent *> &);
 
         private:
             glm::vec3 mPosition;
@@ -45,10 +55,13 @@ namespace neo {
 
             void _detModelMatrix() const;
             void _detNormalMatrix() const;
+            void _detInverseModelMatrix() const;
             mutable glm::mat4 mModelMatrix;
             mutable glm::mat3 mNormalMatrix;
+            mutable glm::mat4 mInverseModelMatrix;
             mutable bool mModelMatrixDirty;
             mutable bool mNormalMatrixDirty;
+            mutable bool mInverseModelMatrixDirty;
     };
 
 };
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ECS/Component/Component.hpp"
+
+#include "Messaging/Messenger.hpp"
+#include "Spatial/SceneSpatialHash.hpp"
+
+namespace neo {
+
+    /* Puts the GameObject's SpatialComponent position in SceneSpatialHash. Opt in, so only objects that are
+     * actually looked up by position pay for rehashing when they move. Add it after the SpatialComponent */
+    class SpatialHashComponent : public Component {
+
+        friend SceneSpatialHash;
+
+    public:
+        SpatialHashComponent(GameObject *go) :
+            Component(go),
+            mSceneHashID(~0u),
+            mSpatialReceiver() {
+        }
+
+        /* SceneSpatialHash and the receiver hold on to this */
+        SpatialHashComponent(SpatialHashComponent &&) = delete;
+
+        virtual void init() override {
+            SceneSpatialHash::insert(*this);
+            mSpatialReceiver = Messenger::addReceiver<SpatialChangeMessage>(mGameObject, [this](const SpatialChangeMessage &) {
+                SceneSpatialHash::markMoved(*this);
+            });
+        }
+
+        virtual void kill() override {
+            SceneSpatialHash::remove(*this);
+        }
+
+    private:
+        /* Slot in the SceneSpatialHash */
+        unsigned mSceneHashID;
+        Subscription mSpatialReceiver;
+    };
+
+}
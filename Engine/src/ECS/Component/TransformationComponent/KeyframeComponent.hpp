@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ECS/Component/Component.hpp"
+#include "ECS/Systems/TranslationSystems/AnimationSystem.hpp"
+
+#include <glm/glm.hpp>
+#include "ext/imgui/imgui.h"
+
+#include <vector>
+
+namespace neo {
+
+    /* Loops a position curve through keyframes, linearly between them. Keys are sorted by time and the loop
+     * runs from the first key's time to the last's. With a SinTranslateComponent on the same object the curve
+     * takes the place of its base position. Animated by AnimationSystem */
+    class KeyframeComponent : public Component {
+
+    public:
+        struct Keyframe {
+            float mTime;
+            glm::vec3 mPosition;
+        };
+
+        KeyframeComponent(GameObject *go, const std::vector<Keyframe> & keyframes) :
+            Component(go),
+            mKeyframes(keyframes)
+        {}
+
+        virtual void imGuiEditor() override {
+            bool changed = false;
+            for (int i = 0; i < int(mKeyframes.size()); i++) {
+                ImGui::PushID(i);
+                changed |= ImGui::SliderFloat3("Position", &mKeyframes[i].mPosition[0], -100.f, 100.f);
+                ImGui::PopID();
+            }
+            if (changed) {
+                AnimationSystem::markDirty();
+            }
+        }
+
+        std::vector<Keyframe> mKeyframes;
+    };
+}
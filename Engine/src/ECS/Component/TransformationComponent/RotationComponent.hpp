@@ -2,6 +2,7 @@
 
 #include "ECS/Component/Component.hpp"
 #include "ECS/Component/SpatialComponent/SpatialComponent.hpp"
+#include "ECS/Systems/TranslationSystems/AnimationSystem.hpp"
 
 #include "ECS/GameObject.hpp"
 
@@ -13,6 +14,7 @@
 
 namespace neo {
 
+    /* Constant angular velocity in radians per second about x, then y, then z. Animated by AnimationSystem */
     class RotationComponent : public Component {
 
     public:
@@ -22,11 +24,13 @@ namespace neo {
         {}
 
         virtual void imGuiEditor() override {
-            ImGui::SliderFloat3("Speed", &mSpeed[0], -5.f, 5.f);
+            if (ImGui::SliderFloat3("Speed", &mSpeed[0], -5.f, 5.f)) {
+                AnimationSystem::markDirty();
+            }
         }
 
         glm::vec3 mSpeed;
 
     };
 
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 
 #include "ECS/Component/Component.hpp"
 #include "ECS/Component/SpatialComponent/SpatialComponent.hpp"
+#include "ECS/Systems/TranslationSystems/AnimationSystem.hpp"
 
 #include "ECS/GameObject.hpp"
 
@@ -12,21 +13,33 @@
 
 namespace neo {
 
+    /* Oscillates around a base position -- base + cos(frequency * time + phase) * offset. Animated by
+     * AnimationSystem */
     class SinTranslateComponent : public Component {
 
     public:
-        SinTranslateComponent(GameObject *go, glm::vec3 offset, glm::vec3 base) :
+        SinTranslateComponent(GameObject *go, glm::vec3 offset, glm::vec3 base, float frequency = 1.f, float phase = 0.f) :
             Component(go),
             mOffset(offset),
-            mBasePosition(base)
+            mBasePosition(base),
+            mFrequency(frequency),
+            mPhase(phase)
         {}
 
         virtual void imGuiEditor() override {
-            ImGui::SliderFloat3("Offset", &mOffset[0], -10.f, 10.f);
-            ImGui::SliderFloat3("Base position", &mBasePosition[0], -100.f, 100.f);
+            bool changed = false;
+            changed |= ImGui::SliderFloat3("Offset", &mOffset[0], -10.f, 10.f);
+            changed |= ImGui::SliderFloat3("Base position", &mBasePosition[0], -100.f, 100.f);
+            changed |= ImGui::SliderFloat("Frequency", &mFrequency, 0.f, 10.f);
+            changed |= ImGui::SliderFloat("Phase", &mPhase, 0.f, 6.283f);
+            if (changed) {
+                AnimationSystem::markDirty();
+            }
         }
 
         glm::vec3 mOffset;
         glm::vec3 mBasePosition;
+        float mFrequency;
+        float mPhase;
     };
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 
 #include "Component/CameraComponent/CameraControllerComponent.hpp"
 #include "Component/CameraComponent/CameraComponent.hpp"
+#include "Component/CameraComponent/CascadedShadowComponent.hpp"
 #include "Component/CameraComponent/FrustumComponent.hpp"
 #include "Component/CameraComponent/FrustumFitReceiverComponent.hpp"
 #include "Component/CameraComponent/FrustumFitSourceComponent.hpp"
@@ -11,10 +12,13 @@
 #include "Component/CameraComponent/ShadowCameraComponent.hpp"
 
 #include "Component/CollisionComponent/BoundingBoxComponent.hpp"
+#include "Component/CollisionComponent/ColliderComponent.hpp"
+#include "Component/CollisionComponent/OccluderComponent.hpp"
 
 #include "Component/LightComponent/LightComponent.hpp"
 
 #include "Component/SpatialComponent/SpatialComponent.hpp"
+#include "Component/SpatialComponent/SpatialHashComponent.hpp"
 
 #include "Component/RenderableComponent/MeshComponent.hpp"
 #include "Component/RenderableComponent/LineMeshComponent.hpp"
@@ -30,5 +34,6 @@
 #include "Component/SelectingComponent/SelectableComponent.hpp"
 #include "Component/SelectingComponent/SelectedComponent.hpp"
 
+#include "Component/TransformationComponent/KeyframeComponent.hpp"
 #include "Component/TransformationComponent/RotationComponent.hpp"
 #include "Component/TransformationComponent/SinTranslateComponent.hpp"
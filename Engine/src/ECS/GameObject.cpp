@@ -4,9 +4,14 @@
 
 namespace neo {
 
+    /* 0 is left for messages sent without a GameObject */
+    unsigned GameObject::mNextID = 1;
+
     GameObject::GameObject() :
+        mID(mNextID++),
         mComponents(),
-        mComponentsByType()
+        mComponentsByType(),
+        mPendingMessages()
     {}
 
     void GameObject::addComponent(Component & component, std::type_index typeI) {
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <unordered_map>
-#include <functional>
+#include <vector>
 #include <typeindex>
 
 #include "ext/microprofile.h"
@@ -11,7 +11,6 @@ namespace neo {
     class Engine;
     class Messenger;
     class Component;
-    struct Message;
 
     class GameObject {
 
@@ -31,17 +30,10 @@ namespace neo {
             /* Get First component by type */
             template <typename CompT> CompT * getComponentByType() const;
 
+            /* Unique and increasing in creation order */
+            unsigned getID() const { return mID; }
+
             const std::vector<Component *> getAllComponents() const { return mComponents; }
-            int getNumReceiverTypes() { return mReceivers.size(); }
-            int getNumReceivers() {
-                int count = 0;
-                auto it = mReceivers.begin();
-                while (it != mReceivers.end()) {
-                    count += it->second.size();
-                    it++;
-                }
-                return count;
-            }
 
         private:
             /* Used by the engine */
@@ -50,10 +42,20 @@ namespace neo {
             void removeComponent(Component &, std::type_index);
             std::unordered_map<std::type_index, std::vector<Component *>> getComponentsMap() { return mComponentsByType ; }
 
+            const unsigned mID;
+            static unsigned mNextID;
+
             /* Containers */
             std::vector<Component *> mComponents;
             std::unordered_map<std::type_index, std::vector<Component *>> mComponentsByType;
-            std::unordered_map<std::type_index, std::vector<std::function<void (const Message &)>>> mReceivers;
+            /* Indexed by the Messenger's message type ID */
+            std::vector<unsigned> mPendingMessages;
+            unsigned & _getPendingMessage(unsigned typeID) {
+                if (mPendingMessages.size() <= typeID) {
+                    mPendingMessages.resize(typeID + 1, ~0u);
+                }
+                return mPendingMessages[typeID];
+            }
     };
 
     /* Template implementation */
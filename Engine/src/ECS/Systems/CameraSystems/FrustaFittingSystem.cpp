@@ -5,8 +5,11 @@
 #include "ECS/Component/CameraComponent/CameraComponent.hpp"
 #include "ECS/Component/SpatialComponent/SpatialComponent.hpp"
 
+#include "Util/ThreadPool.hpp"
+
 #include <algorithm>
 #include <limits>
+#include <cmath>
 
 namespace neo {
 
@@ -121,5 +124,82 @@ namespace neo {
         orthoCamera->setOrthoBounds(glm::vec2(-boxWidth, boxWidth), glm::vec2(-boxHeight, boxHeight));
         orthoCamera->setNearFar(-boxDepth, boxDepth);
 
+        if (auto cascaded = receiverCamera->mGameObject.getComponentByType<CascadedShadowComponent>()) {
+            _fitCascades(*cascaded, shadowToWorld, zNear, zFar, lightDir, up);
+        }
+    }
+
+    void FrustaFittingSystem::_fitCascades(CascadedShadowComponent & cascaded, const glm::mat4 & shadowToWorld, float zNear, float zFar, const glm::vec3 & lightDir, const glm::vec3 & up) {
+        /* Texels kept clear around each tile so filtering never reads a neighbouring cascade */
+        const float Border = 8.f;
+
+        const int numCascades = glm::clamp(cascaded.mNumCascades, 1, CascadedShadowComponent::MaxCascades);
+        cascaded.mNumCascades = numCascades;
+
+        /* Rays through the corners of the scene camera's frustum. Depth is linear along them */
+        glm::vec3 nearCorners[4], farCorners[4];
+        for (int i = 0; i < 4; i++) {
+            const glm::vec2 ndc(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f);
+            const glm::vec4 nearPos = shadowToWorld * glm::vec4(ndc, -1.f, 1.f);
+            const glm::vec4 farPos = shadowToWorld * glm::vec4(ndc, 1.f, 1.f);
+            nearCorners[i] = glm::vec3(nearPos) / nearPos.w;
+            farCorners[i] = glm::vec3(farPos) / farPos.w;
+        }
+
+        /* Practical split scheme -- logarithmic splits give even texel density but crowd near the camera,
+         * so blend them with uniform ones */
+        float splits[CascadedShadowComponent::MaxCascades + 1];
+        splits[0] = zNear;
+        for (int i = 1; i <= numCascades; i++) {
+            const float t = float(i) / numCascades;
+            const float logSplit = zNear * std::pow(zFar / zNear, t);
+            const float uniformSplit = zNear + (zFar - zNear) * t;
+            splits[i] = glm::mix(uniformSplit, logSplit, cascaded.mLambda);
+        }
+
+        /* Light space is only rotated, so moving the camera slides each cascade along its own texel grid */
+        const glm::mat4 worldToLight = glm::lookAt(glm::vec3(0.f), lightDir, up);
+        const float resolution = float(cascaded.mResolution);
+        const float casterDepth = cascaded.mCasterDepth;
+
+        ThreadPool::parallelFor(unsigned(numCascades), 1, [&](unsigned begin, unsigned end) {
+            for (unsigned c = begin; c < end; c++) {
+                const float tNear = (splits[c] - zNear) / (zFar - zNear);
+                const float tFar = (splits[c + 1] - zNear) / (zFar - zNear);
+                glm::vec3 corners[8];
+                glm::vec3 center(0.f);
+                for (int i = 0; i < 4; i++) {
+                    corners[i] = glm::mix(nearCorners[i], farCorners[i], tNear);
+                    corners[i + 4] = glm::mix(nearCorners[i], farCorners[i], tFar);
+                    center += corners[i] + corners[i + 4];
+                }
+                center /= 8.f;
+
+                /* Bound the slice with a sphere so the cascade's size doesn't change as the camera turns.
+                 * Rounding the radius keeps float noise from resizing it */
+                float radius = 0.f;
+                for (const auto & corner : corners) {
+                    radius = glm::max(radius, glm::length(corner - center));
+                }
+                radius = std::ceil(radius * 16.f) / 16.f;
+
+                /* Snap the center to whole texels so edges don't shimmer as the camera moves */
+                const float halfSize = radius * resolution / (resolution - 2.f * Border);
+                const float texel = 2.f * halfSize / resolution;
+                glm::vec3 lightCenter = glm::vec3(worldToLight * glm::vec4(center, 1.f));
+                lightCenter.x = std::floor(lightCenter.x / texel) * texel;
+                lightCenter.y = std::floor(lightCenter.y / texel) * texel;
+
+                /* Casters between the light and the slice still shadow it */
+                auto & cascade = cascaded.mCascades[c];
+                cascade.mView = worldToLight;
+                cascade.mProj = glm::ortho(
+                    lightCenter.x - halfSize, lightCenter.x + halfSize,
+                    lightCenter.y - halfSize, lightCenter.y + halfSize,
+                    -(lightCenter.z + radius + casterDepth), -(lightCenter.z - radius));
+                cascade.mSplit = splits[c + 1];
+                cascade.mFrustum.setPlanes(cascade.mProj * cascade.mView);
+            }
+        });
     }
 }
@@ -2,9 +2,14 @@
 
 #include "ECS/Systems/System.hpp"
 
+#include <glm/glm.hpp>
 
 namespace neo {
 
+    class CascadedShadowComponent;
+
+    /* Fits the receiver's ortho camera around the source camera's frustum as seen from the light. With a
+     * CascadedShadowComponent, each cascade is also fit around its own slice of the frustum */
     class FrustaFittingSystem : public System {
 
     public:
@@ -14,5 +19,8 @@ namespace neo {
         }
 
         virtual void update(const float dt) override;
+
+    private:
+        void _fitCascades(CascadedShadowComponent &, const glm::mat4 & shadowToWorld, float zNear, float zFar, const glm::vec3 & lightDir, const glm::vec3 & up);
     };
 }
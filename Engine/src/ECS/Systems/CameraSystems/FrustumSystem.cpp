@@ -47,41 +47,7 @@ namespace neo {
             }
 
             // Update frustum planes
-            frustum->mLeft.x = PV[0][3] + PV[0][0];
-            frustum->mLeft.y = PV[1][3] + PV[1][0];
-            frustum->mLeft.z = PV[2][3] + PV[2][0];
-            frustum->mLeft.w = PV[3][3] + PV[3][0];
-            frustum->mLeft /= glm::length(glm::vec3(frustum->mLeft));
-
-            frustum->mRight.x = PV[0][3] - PV[0][0];
-            frustum->mRight.y = PV[1][3] - PV[1][0];
-            frustum->mRight.z = PV[2][3] - PV[2][0];
-            frustum->mRight.w = PV[3][3] - PV[3][0];
-            frustum->mRight /= glm::length(glm::vec3(frustum->mRight));
-
-            frustum->mBottom.x = PV[0][3] + PV[0][1];
-            frustum->mBottom.y = PV[1][3] + PV[1][1];
-            frustum->mBottom.z = PV[2][3] + PV[2][1];
-            frustum->mBottom.w = PV[3][3] + PV[3][1];
-            frustum->mBottom /= glm::length(glm::vec3(frustum->mBottom));
-
-            frustum->mTop.x = PV[0][3] - PV[0][1];
-            frustum->mTop.y = PV[1][3] - PV[1][1];
-            frustum->mTop.z = PV[2][3] - PV[2][1];
-            frustum->mTop.w = PV[3][3] - PV[3][1];
-            frustum->mTop /= glm::length(glm::vec3(frustum->mTop));
-
-            frustum->mFar.x = PV[0][3] - PV[0][2];
-            frustum->mFar.y = PV[1][3] - PV[1][2];
-            frustum->mFar.z = PV[2][3] - PV[2][2];
-            frustum->mFar.w = PV[3][3] - PV[3][2];
-            frustum->mFar /= glm::length(glm::vec3(frustum->mFar));
-
-            frustum->mNear.x = PV[0][2];
-            frustum->mNear.y = PV[1][2];
-            frustum->mNear.z = PV[2][2];
-            frustum->mNear.w = PV[3][2];
-            frustum->mNear /= glm::length(glm::vec3(frustum->mNear));
+            frustum->setPlanes(PV);
         }
     }
 }
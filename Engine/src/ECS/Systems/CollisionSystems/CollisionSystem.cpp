@@ -0,0 +1,135 @@
+#include <Engine.hpp>
+#include "CollisionSystem.hpp"
+
+#include "Spatial/SceneBVH.hpp"
+
+#include <algorithm>
+
+namespace neo {
+
+    namespace {
+        enum CollisionCounter {
+            Colliders,
+            CandidatePairs,
+            Contacts,
+            Enters,
+            Exits,
+            NumCounters
+        };
+
+        unsigned _counter(CollisionCounter counter) {
+            static const unsigned counters[NumCounters] = {
+                Counters::add("Collision", "Colliders"),
+                Counters::add("Collision", "Candidate pairs"),
+                Counters::add("Collision", "Contacts"),
+                Counters::add("Collision", "Enters"),
+                Counters::add("Collision", "Exits"),
+            };
+            return counters[counter];
+        }
+    }
+
+    GameObject * CollisionSystem::_findObject(unsigned id) const {
+        return id < mObjects.size() ? mObjects[id] : nullptr;
+    }
+
+    void CollisionSystem::_gather() {
+        MICROPROFILE_SCOPEI("CollisionSystem", "_gather", MP_AUTO);
+        /* Brings WorldBounds up to date with everything that has moved */
+        SceneBVH::update();
+
+        const glm::vec3 worldAxes[3] = { glm::vec3(1.f, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f), glm::vec3(0.f, 0.f, 1.f) };
+        mColliders.clear();
+        std::fill(mObjects.begin(), mObjects.end(), nullptr);
+        for (auto collider : Engine::getComponents<ColliderComponent>()) {
+            GameObject & gameObject = collider->getGameObject();
+            auto box = gameObject.getComponentByType<BoundingBoxComponent>();
+            if (!box) {
+                continue;
+            }
+
+            SweepAndPrune::Collider c;
+            c.mID = gameObject.getID();
+            c.mShape = collider->mShape;
+            c.mCenter = box->getWorldCenter();
+            c.mExtent = box->getWorldExtent();
+            c.mRadius = box->getWorldRadius();
+            c.mAxes[0] = worldAxes[0];
+            c.mAxes[1] = worldAxes[1];
+            c.mAxes[2] = worldAxes[2];
+            c.mHalfSize = c.mExtent;
+            if (c.mShape == ColliderComponent::Shape::OBB) {
+                const glm::vec3 localExtent = (box->mMax - box->mMin) * 0.5f;
+                if (auto spatial = gameObject.getComponentByType<SpatialComponent>()) {
+                    const glm::mat4 & M = spatial->getModelMatrix();
+                    for (int i = 0; i < 3; i++) {
+                        const float scale = glm::length(glm::vec3(M[i]));
+                        c.mAxes[i] = scale > 0.f ? glm::vec3(M[i]) / scale : worldAxes[i];
+                        c.mHalfSize[i] = localExtent[i] * scale;
+                    }
+                }
+                else {
+                    c.mHalfSize = localExtent;
+                }
+            }
+
+            /* The bounding sphere reaches past the box's edges */
+            if (c.mShape == ColliderComponent::Shape::Sphere) {
+                c.mExtent = glm::vec3(c.mRadius);
+            }
+
+            if (c.mID >= mObjects.size()) {
+                mObjects.resize(std::max(size_t(c.mID) + 1, mObjects.size() * 2), nullptr);
+            }
+            mObjects[c.mID] = &gameObject;
+            mColliders.push_back(c);
+        }
+        Counters::increment(_counter(Colliders), mColliders.size());
+    }
+
+    void CollisionSystem::_sendMessages() {
+        MICROPROFILE_SCOPEI("CollisionSystem", "_sendMessages", MP_AUTO);
+        for (auto key : mSweepAndPrune.getEntered()) {
+            GameObject * a = _findObject(unsigned(key >> 32));
+            GameObject * b = _findObject(unsigned(key));
+            Messenger::sendMessage<CollisionEnterMessage>(a, a, b);
+            Messenger::sendMessage<CollisionEnterMessage>(b, b, a);
+        }
+        for (auto key : mSweepAndPrune.getExited()) {
+            /* Either side may have been removed since */
+            GameObject * a = _findObject(unsigned(key >> 32));
+            GameObject * b = _findObject(unsigned(key));
+            if (a) {
+                Messenger::sendMessage<CollisionExitMessage>(a, a, b);
+            }
+            if (b) {
+                Messenger::sendMessage<CollisionExitMessage>(b, b, a);
+            }
+        }
+
+        const auto & keys = mSweepAndPrune.getContacts();
+        mContacts.resize(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            mContacts[i] = { _findObject(unsigned(keys[i] >> 32)), _findObject(unsigned(keys[i])) };
+        }
+        Counters::increment(_counter(CandidatePairs), mSweepAndPrune.getNumCandidates());
+        Counters::increment(_counter(Contacts), mContacts.size());
+        Counters::increment(_counter(Enters), mSweepAndPrune.getEntered().size());
+        Counters::increment(_counter(Exits), mSweepAndPrune.getExited().size());
+    }
+
+    void CollisionSystem::update(const float dt) {
+        MICROPROFILE_SCOPEI("CollisionSystem", "update", MP_AUTO);
+        _gather();
+        mSweepAndPrune.update(mColliders);
+        _sendMessages();
+    }
+
+    void CollisionSystem::imguiEditor() {
+        ImGui::Text("Colliders: %llu", (unsigned long long)Counters::getLastFrame(_counter(Colliders)));
+        ImGui::Text("Candidate pairs: %llu", (unsigned long long)Counters::getLastFrame(_counter(CandidatePairs)));
+        ImGui::Text("Contacts: %llu", (unsigned long long)Counters::getLastFrame(_counter(Contacts)));
+        ImGui::Text("Enters / exits: %llu / %llu", (unsigned long long)Counters::getLastFrame(_counter(Enters)), (unsigned long long)Counters::getLastFrame(_counter(Exits)));
+    }
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ECS/Systems/System.hpp"
+#include "ECS/Component/CollisionComponent/ColliderComponent.hpp"
+#include "Spatial/SweepAndPrune.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <utility>
+
+namespace neo {
+
+    class GameObject;
+
+    /* Finds touching ColliderComponents every update with a SweepAndPrune over their world bounds, and keeps
+     * them as a persistent contact list. Pairs that start or stop touching get a CollisionEnterMessage or
+     * CollisionExitMessage, sent to both objects */
+    class CollisionSystem : public System {
+
+        public:
+            CollisionSystem() :
+                System("Collision System")
+            {}
+
+            virtual void update(const float dt) override;
+            virtual void imguiEditor() override;
+
+            /* Pairs touching as of the last update, lower GameObject ID first */
+            const std::vector<std::pair<GameObject *, GameObject *>> & getContacts() const { return mContacts; }
+
+        private:
+            SweepAndPrune mSweepAndPrune;
+            std::vector<SweepAndPrune::Collider> mColliders;
+            /* Collider GameObjects by ID, or null */
+            std::vector<GameObject *> mObjects;
+            std::vector<std::pair<GameObject *, GameObject *>> mContacts;
+
+            void _gather();
+            void _sendMessages();
+            GameObject * _findObject(unsigned id) const;
+    };
+}
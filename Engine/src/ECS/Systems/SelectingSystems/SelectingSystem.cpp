@@ -1,6 +1,8 @@
 #include <Engine.hpp>
 #include "SelectingSystem.hpp"
 
+#include "Spatial/SceneBVH.hpp"
+
 namespace neo {
 
     void SelectingSystem::init() {
@@ -13,46 +15,24 @@ namespace neo {
     void SelectingSystem::update(const float dt) {
         if (auto mouseRay = Engine::getSingleComponent<MouseRayComponent>()) {
 
-            SelectableComponent* selectedSelectable = nullptr;
-            float intersectDist = 0.f;
             float maxDistance = mMaxDist;
             auto mainCamera = Engine::getComponentTuple<MainCameraComponent, CameraComponent>();
             if (mainCamera) {
                 maxDistance = glm::min(maxDistance, mainCamera->get<CameraComponent>()->getNearFar().y);
             }
+            const auto cameraFrustum = mainCamera ? mainCamera->mGameObject.getComponentByType<FrustumComponent>() : nullptr;
 
-
-            // Select a new object
-            for (auto& selectable : Engine::getComponentTuples<SelectableComponent, BoundingBoxComponent, SpatialComponent>()) {
-                auto selectableSpatial = selectable->get<SpatialComponent>();
-                auto selectableBox = selectable->get<BoundingBoxComponent>();
-
-                // Frustum culling
-                if (mainCamera) {
-                    if (const auto& frustumPlanes = mainCamera->mGameObject.getComponentByType<FrustumComponent>()) {
-                        float radius = glm::max(glm::max(selectableSpatial->getScale().x, selectableSpatial->getScale().y), selectableSpatial->getScale().z) * selectableBox->getRadius();
-                        if (!frustumPlanes->isInFrustum(selectableSpatial->getPosition(), radius)) {
-                            continue;
-                        }
-                    }
-                }
-
-
-                // Ray march
-                for (float i = 0.f; i < maxDistance; i += maxDistance / static_cast<float>(mMaxMarches)) {
-                    glm::vec3 raySample = mouseRay->mPosition + mouseRay->mDirection * i;
-                    if (selectableBox->intersect(raySample)) {
-                        selectedSelectable = selectable->get<SelectableComponent>();
-                        intersectDist = i;
-                        break;
-                    }
-                }
-                if (selectedSelectable) {
-                    break;
-                }
+            // Select the nearest visible selectable under the mouse
+            float intersectDist = 0.f;
+            SelectableComponent* selectedSelectable = nullptr;
+            GameObject* hit = SceneBVH::raycast(mouseRay->mPosition, mouseRay->mDirection, maxDistance, intersectDist, [&](const GameObject& gameObject) {
+                return gameObject.getComponentByType<SelectableComponent>() && gameObject.getComponentByType<SpatialComponent>() &&
+                    (!cameraFrustum || cameraFrustum->isVisible(gameObject));
+            });
+            if (hit) {
+                selectedSelectable = hit->getComponentByType<SelectableComponent>();
             }
 
-
             SelectedComponent* selected = nullptr;
             if (selectedSelectable) {
                 selected = selectedSelectable->getGameObject().getComponentByType<SelectedComponent>();
@@ -16,7 +16,6 @@ namespace neo {
     public:
         SelectingSystem(
             std::string name = "Selecting System",
-            int maxMarches = 100,
             float maxDist = 100.f,
             std::function<bool(SelectedComponent*)> removeDecider = [](SelectedComponent*) { return true; },
             std::function<void(SelectableComponent*)> resetOperation = [](SelectableComponent*) {},
@@ -24,7 +23,6 @@ namespace neo {
             std::function<void(std::vector<SelectedComponent*>&)> editorOperation = [](std::vector<SelectedComponent*>&) {}) :
 
             System(name),
-            mMaxMarches(maxMarches),
             mMaxDist(maxDist),
             mRemoveDecider(removeDecider),
             mResetOperation(resetOperation),
@@ -38,7 +36,6 @@ namespace neo {
         virtual void imguiEditor() override;
 
     private:
-        const int mMaxMarches;
         const float mMaxDist;
         const std::function<bool(SelectedComponent*)> mRemoveDecider;
         const std::function<void(SelectableComponent*)> mResetOperation;
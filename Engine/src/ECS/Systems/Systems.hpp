@@ -5,9 +5,10 @@
 #include "CameraSystems/FrustumSystem.hpp"
 #include "CameraSystems/FrustumToLineSystem.hpp"
 
+#include "CollisionSystems/CollisionSystem.hpp"
+
 #include "SelectingSystems/EditorSystem.hpp"
 #include "SelectingSystems/MouseRaySystem.hpp"
 #include "SelectingSystems/SelectingSystem.hpp"
 
-#include "TranslationSystems/RotationSystem.hpp"
-#include "TranslationSystems/SinTranslateSystem.hpp"
\ No newline at end of file
+#include "TranslationSystems/AnimationSystem.hpp"
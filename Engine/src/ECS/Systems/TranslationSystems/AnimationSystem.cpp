@@ -0,0 +1,254 @@
+#include <Engine.hpp>
+#include "AnimationSystem.hpp"
+
+#include "Util/SIMD.hpp"
+#include "Util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace neo {
+
+    bool AnimationSystem::mDirty = true;
+
+    namespace {
+        enum AnimationCounter {
+            Spinning,
+            Translating,
+            NumCounters
+        };
+
+        unsigned _counter(AnimationCounter counter) {
+            static const unsigned counters[NumCounters] = {
+                Counters::add("Animation", "Spinning"),
+                Counters::add("Animation", "Translating"),
+            };
+            return counters[counter];
+        }
+
+        /* Objects each task animates */
+        const unsigned ObjectsPerTask = 2048;
+
+        unsigned _padded(unsigned count) {
+            return (count + simd::Width - 1) / simd::Width * simd::Width;
+        }
+    }
+
+    bool AnimationSystem::_changed() const {
+        return mDirty ||
+            Engine::getComponents<RotationComponent>() != mRotationComponents ||
+            Engine::getComponents<SinTranslateComponent>() != mSinComponents ||
+            Engine::getComponents<KeyframeComponent>() != mKeyframeComponents;
+    }
+
+    void AnimationSystem::_pack() {
+        MICROPROFILE_SCOPEI("AnimationSystem", "_pack", MP_AUTO);
+        mRotationComponents = Engine::getComponents<RotationComponent>();
+        mSinComponents = Engine::getComponents<SinTranslateComponent>();
+        mKeyframeComponents = Engine::getComponents<KeyframeComponent>();
+        mDirty = false;
+
+        mSpinning.clear();
+        std::vector<glm::vec3> speeds;
+        for (auto rotation : mRotationComponents) {
+            if (auto spatial = rotation->getGameObject().getComponentByType<SpatialComponent>()) {
+                mSpinning.push_back(spatial);
+                speeds.push_back(rotation->mSpeed);
+            }
+        }
+        mSpinStride = _padded(unsigned(mSpinning.size()));
+        mSpin.assign(NumSpinRows * mSpinStride, 0.f);
+        for (unsigned i = 0; i < speeds.size(); i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                mSpin[(SpeedX + axis) * mSpinStride + i] = speeds[i][axis];
+            }
+        }
+
+        /* An object with both an oscillation and a curve is one translating object -- the curve replaces its base */
+        mTranslating.clear();
+        std::vector<const SinTranslateComponent *> sins;
+        std::vector<const KeyframeComponent *> curves;
+        std::unordered_map<const SpatialComponent *, unsigned> indices;
+        for (auto sin : mSinComponents) {
+            if (auto spatial = sin->getGameObject().getComponentByType<SpatialComponent>()) {
+                indices[spatial] = unsigned(mTranslating.size());
+                mTranslating.push_back(spatial);
+                sins.push_back(sin);
+                curves.push_back(nullptr);
+            }
+        }
+        for (auto curve : mKeyframeComponents) {
+            auto spatial = curve->getGameObject().getComponentByType<SpatialComponent>();
+            if (!spatial || curve->mKeyframes.empty()) {
+                continue;
+            }
+            const auto found = indices.find(spatial);
+            if (found != indices.end()) {
+                curves[found->second] = curve;
+                continue;
+            }
+            mTranslating.push_back(spatial);
+            sins.push_back(nullptr);
+            curves.push_back(curve);
+        }
+
+        const unsigned count = unsigned(mTranslating.size());
+        mTranslateStride = _padded(count);
+        mTranslate.assign(NumTranslateRows * mTranslateStride, 0.f);
+        mCurves.assign(count, Curve());
+        mKeyTimes.clear();
+        mKeyPositions.clear();
+        auto row = [&](TranslateRow r) { return &mTranslate[r * mTranslateStride]; };
+        for (unsigned i = 0; i < count; i++) {
+            if (const auto sin = sins[i]) {
+                for (int axis = 0; axis < 3; axis++) {
+                    row(TranslateRow(BaseX + axis))[i] = sin->mBasePosition[axis];
+                    row(TranslateRow(OffsetX + axis))[i] = sin->mOffset[axis];
+                }
+                row(Frequency)[i] = sin->mFrequency;
+                row(Phase)[i] = sin->mPhase;
+            }
+            if (const auto curve = curves[i]) {
+                auto keyframes = curve->mKeyframes;
+                std::stable_sort(keyframes.begin(), keyframes.end(), [](const KeyframeComponent::Keyframe & a, const KeyframeComponent::Keyframe & b) {
+                    return a.mTime < b.mTime;
+                });
+                mCurves[i].mBegin = unsigned(mKeyTimes.size());
+                mCurves[i].mCount = unsigned(keyframes.size());
+                mCurves[i].mDuration = keyframes.back().mTime - keyframes.front().mTime;
+                for (auto & keyframe : keyframes) {
+                    mKeyTimes.push_back(keyframe.mTime);
+                    mKeyPositions.push_back(keyframe.mPosition);
+                }
+            }
+        }
+    }
+
+    void AnimationSystem::_spin(float dt) {
+        MICROPROFILE_SCOPEI("AnimationSystem", "_spin", MP_AUTO);
+        const unsigned count = unsigned(mSpinning.size());
+        const unsigned tasks = (count + ObjectsPerTask - 1) / ObjectsPerTask;
+        ThreadPool::parallelFor(tasks, 1, [&](unsigned begin, unsigned end) {
+            const simd::vfloat halfDt = simd::set1(0.5f * dt);
+            const simd::vfloat one = simd::set1(1.f);
+            for (unsigned i = begin * ObjectsPerTask; i < std::min(count, end * ObjectsPerTask); i += simd::Width) {
+                const unsigned lanes = std::min(unsigned(simd::Width), count - i);
+
+                /* The turn this frame, qx * qy * qz like RotationComponent's axes, expanded with no zero terms */
+                simd::vfloat s[3], c[3];
+                for (int axis = 0; axis < 3; axis++) {
+                    simd::sincos(simd::load(&mSpin[(SpeedX + axis) * mSpinStride + i]) * halfDt, s[axis], c[axis]);
+                }
+                const simd::vfloat xyW = c[0] * c[1], xyX = s[0] * c[1], xyY = c[0] * s[1], xyZ = s[0] * s[1];
+                const simd::vfloat rW = xyW * c[2] - xyZ * s[2];
+                const simd::vfloat rX = xyX * c[2] + xyY * s[2];
+                const simd::vfloat rY = xyY * c[2] - xyX * s[2];
+                const simd::vfloat rZ = xyZ * c[2] + xyW * s[2];
+
+                /* With NEO_QUAT_ORIENTATION these read and write the stored quaternion, no matrix round trip */
+                float q[4][simd::Width];
+                for (unsigned lane = 0; lane < simd::Width; lane++) {
+                    const glm::quat orientation = lane < lanes ? mSpinning[i + lane]->getQuaternion() : glm::quat(1.f, 0.f, 0.f, 0.f);
+                    q[0][lane] = orientation.x;
+                    q[1][lane] = orientation.y;
+                    q[2][lane] = orientation.z;
+                    q[3][lane] = orientation.w;
+                }
+                const simd::vfloat qX = simd::load(q[0]), qY = simd::load(q[1]), qZ = simd::load(q[2]), qW = simd::load(q[3]);
+
+                /* r * q, renormalized so drift doesn't build up */
+                simd::vfloat x = rW * qX + rX * qW + rY * qZ - rZ * qY;
+                simd::vfloat y = rW * qY - rX * qZ + rY * qW + rZ * qX;
+                simd::vfloat z = rW * qZ + rX * qY - rY * qX + rZ * qW;
+                simd::vfloat w = rW * qW - rX * qX - rY * qY - rZ * qZ;
+                const simd::vfloat inverseLength = one / simd::sqrt(x * x + y * y + z * z + w * w);
+                simd::store(q[0], x * inverseLength);
+                simd::store(q[1], y * inverseLength);
+                simd::store(q[2], z * inverseLength);
+                simd::store(q[3], w * inverseLength);
+                for (unsigned lane = 0; lane < lanes; lane++) {
+                    mSpinning[i + lane]->setOrientation(glm::quat(q[3][lane], q[0][lane], q[1][lane], q[2][lane]));
+                }
+            }
+        });
+        Counters::increment(_counter(Spinning), count);
+    }
+
+    glm::vec3 AnimationSystem::_evaluateCurve(Curve & curve, float time) {
+        const float * times = &mKeyTimes[curve.mBegin];
+        const glm::vec3 * positions = &mKeyPositions[curve.mBegin];
+        if (curve.mDuration <= 0.f) {
+            return positions[0];
+        }
+
+        float local = std::fmod(time - times[0], curve.mDuration);
+        local = times[0] + (local < 0.f ? local + curve.mDuration : local);
+        if (times[curve.mCursor] > local) {
+            curve.mCursor = 0;
+        }
+        while (curve.mCursor + 2 < curve.mCount && times[curve.mCursor + 1] <= local) {
+            curve.mCursor++;
+        }
+        const unsigned key = curve.mCursor;
+        const float span = times[key + 1] - times[key];
+        const float t = span > 0.f ? glm::clamp((local - times[key]) / span, 0.f, 1.f) : 1.f;
+        return glm::mix(positions[key], positions[key + 1], t);
+    }
+
+    void AnimationSystem::_translate(float time) {
+        MICROPROFILE_SCOPEI("AnimationSystem", "_translate", MP_AUTO);
+        const unsigned count = unsigned(mTranslating.size());
+        const unsigned tasks = (count + ObjectsPerTask - 1) / ObjectsPerTask;
+        ThreadPool::parallelFor(tasks, 1, [&](unsigned begin, unsigned end) {
+            const simd::vfloat t = simd::set1(time);
+            auto row = [&](TranslateRow r, unsigned i) { return &mTranslate[r * mTranslateStride + i]; };
+            for (unsigned i = begin * ObjectsPerTask; i < std::min(count, end * ObjectsPerTask); i += simd::Width) {
+                const unsigned lanes = std::min(unsigned(simd::Width), count - i);
+
+                /* Curves are walked one object at a time, and stand in for the packed base */
+                float base[3][simd::Width];
+                for (int axis = 0; axis < 3; axis++) {
+                    simd::store(base[axis], simd::load(row(TranslateRow(BaseX + axis), i)));
+                }
+                for (unsigned lane = 0; lane < lanes; lane++) {
+                    Curve & curve = mCurves[i + lane];
+                    if (curve.mCount) {
+                        const glm::vec3 position = _evaluateCurve(curve, time);
+                        for (int axis = 0; axis < 3; axis++) {
+                            base[axis][lane] = position[axis];
+                        }
+                    }
+                }
+
+                simd::vfloat s, c;
+                simd::sincos(simd::load(row(Frequency, i)) * t + simd::load(row(Phase, i)), s, c);
+                float position[3][simd::Width];
+                for (int axis = 0; axis < 3; axis++) {
+                    simd::store(position[axis], simd::load(base[axis]) + c * simd::load(row(TranslateRow(OffsetX + axis), i)));
+                }
+                for (unsigned lane = 0; lane < lanes; lane++) {
+                    mTranslating[i + lane]->setPosition(glm::vec3(position[0][lane], position[1][lane], position[2][lane]));
+                }
+            }
+        });
+        Counters::increment(_counter(Translating), count);
+    }
+
+    void AnimationSystem::update(const float dt) {
+        MICROPROFILE_SCOPEI("AnimationSystem", "update", MP_AUTO);
+        if (_changed()) {
+            _pack();
+        }
+
+        /* One after the other, so no object is written from two tasks at once */
+        _spin(dt);
+        _translate(float(Util::getRunTime()));
+    }
+
+    void AnimationSystem::imguiEditor() {
+        ImGui::Text("Spinning: %llu", (unsigned long long)Counters::getLastFrame(_counter(Spinning)));
+        ImGui::Text("Translating: %llu", (unsigned long long)Counters::getLastFrame(_counter(Translating)));
+    }
+
+}
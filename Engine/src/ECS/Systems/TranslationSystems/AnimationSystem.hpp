@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ECS/Systems/System.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace neo {
+
+    class SpatialComponent;
+    class RotationComponent;
+    class SinTranslateComponent;
+    class KeyframeComponent;
+
+    /* Animates every RotationComponent, SinTranslateComponent and KeyframeComponent in one pass. Their
+     * parameters are packed into SoA rows whenever the set of components changes, then each update evaluates
+     * a SIMD batch of objects at a time across the ThreadPool and writes the transforms straight back. Spins
+     * turn each object by its angular velocity times dt; oscillations and curves set its position from the
+     * run time */
+    class AnimationSystem : public System {
+
+        public:
+            AnimationSystem() :
+                System("Animation System")
+            {}
+
+            virtual void update(const float dt) override;
+            virtual void imguiEditor() override;
+
+            /* Repack on the next update -- for parameters edited in place */
+            static void markDirty() { mDirty = true; }
+
+        private:
+            static bool mDirty;
+
+            /* Components packed last, to notice ones added or removed */
+            std::vector<RotationComponent *> mRotationComponents;
+            std::vector<SinTranslateComponent *> mSinComponents;
+            std::vector<KeyframeComponent *> mKeyframeComponents;
+
+            enum SpinRow {
+                SpeedX, SpeedY, SpeedZ,
+                NumSpinRows
+            };
+            enum TranslateRow {
+                BaseX, BaseY, BaseZ,
+                OffsetX, OffsetY, OffsetZ,
+                Frequency,
+                Phase,
+                NumTranslateRows
+            };
+
+            /* Rows padded to whole SIMD batches */
+            std::vector<SpatialComponent *> mSpinning;
+            std::vector<float> mSpin;
+            unsigned mSpinStride = 0;
+            std::vector<SpatialComponent *> mTranslating;
+            std::vector<float> mTranslate;
+            unsigned mTranslateStride = 0;
+
+            /* Keyframes of every curve back to back, and each translating object's range. Cursors keep the last
+             * key found so lookups walk forward from it */
+            struct Curve {
+                unsigned mBegin = 0;
+                unsigned mCount = 0;
+                unsigned mCursor = 0;
+                float mDuration = 0.f;
+            };
+            std::vector<Curve> mCurves;
+            std::vector<float> mKeyTimes;
+            std::vector<glm::vec3> mKeyPositions;
+
+            bool _changed() const;
+            void _pack();
+            void _spin(float dt);
+            void _translate(float time);
+            glm::vec3 _evaluateCurve(Curve &, float time);
+    };
+}
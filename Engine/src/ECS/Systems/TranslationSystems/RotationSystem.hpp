@@ -1,17 +0,0 @@
-#pragma once
-
-#include "ECS/Systems/System.hpp"
-
-namespace neo {
-
-    class RotationSystem : public System {
-
-    public:
-        RotationSystem() :
-            System("Rotation System")
-        {}
-
-        virtual void update(const float dt) override;
-
-    };
-}
\ No newline at end of file
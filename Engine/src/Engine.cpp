@@ -13,6 +13,13 @@ extern "C" {
 
 #include "ECS/GameObject.hpp"
 #include "Messaging/Messenger.hpp"
+#include "Spatial/SceneBVH.hpp"
+#include "Spatial/SceneSpatialHash.hpp"
+#include "Spatial/FrustumCulling.hpp"
+#include "Spatial/OcclusionCulling.hpp"
+#include "Renderer/OcclusionQueries.hpp"
+#include "Renderer/GLObjects/Meshlet.hpp"
+#include "Util/ThreadPool.hpp"
 
 #include "Loader/Loader.hpp"
 #include "Loader/MeshGenerator.hpp"
@@ -160,8 +167,13 @@ namespace neo {
             /* Render */
             // TODO - only run this at 60FPS in its own thread
             // TODO - should this go after processkillqueue?
+            SpatialComponent::updateMatrices(getComponents<SpatialComponent>());
+            FrustumCulling::cull();
+            OcclusionCulling::cull();
+            OcclusionQueries::cull();
             Renderer::render((float)Util::mTimeStep);
 
+            Counters::newFrame();
             MicroProfileFlip(0);
         }
 
@@ -223,12 +235,18 @@ namespace neo {
     }
 
     void Engine::shutDown() {
+        if (mConfig.countersFile.size() && !Counters::exportCSV(mConfig.countersFile)) {
+            std::cerr << "Failed writing counters to " << mConfig.countersFile << std::endl;
+        }
+
         // Clean up GameObjects and components
         for (auto& gameObject : mGameObjects) {
             removeGameObject(*gameObject);
         }
         _processKillQueue();
 
+        ThreadPool::shutDown();
+
         // Clean up Renderer
         Renderer::shutDown();
 
@@ -330,6 +348,34 @@ namespace neo {
                 if (ImGui::Button("VSync")) {
                     Window::toggleVSync();
                 }
+                if (ImGui::TreeNode("Counters")) {
+                    Counters::imguiEditor();
+                    ImGui::TreePop();
+                }
+                if (ImGui::TreeNode("Scene BVH")) {
+                    SceneBVH::imguiEditor();
+                    ImGui::TreePop();
+                }
+                if (ImGui::TreeNode("Scene spatial hash")) {
+                    SceneSpatialHash::imguiEditor();
+                    ImGui::TreePop();
+                }
+                if (ImGui::TreeNode("Frustum culling")) {
+                    FrustumCulling::imguiEditor();
+                    ImGui::TreePop();
+                }
+                if (ImGui::TreeNode("Occlusion culling")) {
+                    OcclusionCulling::imguiEditor();
+                    ImGui::TreePop();
+                }
+                if (ImGui::TreeNode("Occlusion queries")) {
+                    OcclusionQueries::imguiEditor();
+                    ImGui::TreePop();
+                }
+                if (ImGui::TreeNode("Meshlets")) {
+                    Meshlets::imguiEditor();
+                    ImGui::TreePop();
+                }
                 ImGui::EndMenu();
             }
             if (ImGui::BeginMenu("ECS")) {
@@ -7,6 +7,7 @@
 #include "Renderer/Renderer.hpp"
 #include "Loader/Library.hpp"
 #include "Util/Util.hpp"
+#include "Util/Counters.hpp"
 
 #include "ECS/ComponentTuple.hpp"
 #include "ECS/Components.hpp"
@@ -33,6 +34,8 @@ namespace neo {
         int width = 1920;
         int height = 1080;
         bool attachEditor = true;
+        /* If set, the counter history is written here as CSV on shut down */
+        std::string countersFile = "";
     };
 
     class Engine {
@@ -96,6 +99,9 @@ namespace neo {
             static std::unordered_map<std::type_index, std::unique_ptr<std::vector<std::unique_ptr<Component>>>> mComponents;
             static std::vector<std::pair<std::type_index, std::unique_ptr<System>>> mSystems;
 
+            /* Counts a getComponentTuple(s) call and how many GameObjects it matched */
+            template <typename CompT, typename... CompTs> static void _countQuery(std::size_t matches);
+
             /* ImGui */
             static std::unordered_map<std::string, std::function<void()>> mImGuiFuncs;
             static void _runImGui();
@@ -114,7 +120,8 @@ namespace neo {
         static_assert(std::is_base_of<SuperT, CompT>::value, "CompT must be derived from SuperT");
         static_assert(!std::is_same<CompT, Component>::value, "CompT must be a derived component type");
 
-        mComponentInitQueue.emplace_back(typeid(SuperT), std::make_unique<CompT>(CompT(gameObject, std::forward<Args>(args)...)));
+        /* Built in place -- components that register themselves can't be moved */
+        mComponentInitQueue.emplace_back(typeid(SuperT), std::make_unique<CompT>(gameObject, std::forward<Args>(args)...));
         return static_cast<CompT &>(*mComponentInitQueue.back().second);
     }
 
@@ -193,9 +200,11 @@ namespace neo {
         MICROPROFILE_SCOPEI("Engine", "getComponentTuple", MP_AUTO);
         for (auto comp : getComponents<CompT>()) {
             if (auto tuple = getComponentTuple<CompT, CompTs...>(comp->getGameObject())) {
+                _countQuery<CompT, CompTs...>(1);
                 return tuple;
             }
         }
+        _countQuery<CompT, CompTs...>(0);
         return nullptr;
     }
  
@@ -209,6 +218,7 @@ namespace neo {
             }
         }
 
+        _countQuery<CompT, CompTs...>(tuples.size());
         return tuples;
     }
 
@@ -226,5 +236,17 @@ namespace neo {
         return nullptr;
     }
 
+    template <typename CompT, typename... CompTs>
+    void Engine::_countQuery(std::size_t matches) {
+        static const std::string name = (std::string(typeid(CompT).name()) + ... + (std::string(", ") + typeid(CompTs).name()));
+        static const unsigned executedCounter = Counters::add("Queries executed", name);
+        static const unsigned matchesCounter = Counters::add("Query matches", name);
+
+        Counters::increment(Counters::QueriesExecuted);
+        Counters::increment(Counters::QueryMatches, matches);
+        Counters::increment(executedCounter);
+        Counters::increment(matchesCounter, matches);
+    }
+
 
 }
\ No newline at end of file
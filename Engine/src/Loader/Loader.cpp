@@ -23,6 +23,7 @@ namespace neo {
     void Loader::init(const std::string &res, bool v) {
         RES_DIR = res;
         mVerbose = v;
+        MeshCache::mDirectory = RES_DIR + "cache/";
     }
 
     Mesh* Loader::loadMesh(const std::string &fileName, bool doResize) {
@@ -31,6 +32,18 @@ namespace neo {
         /* Create mesh */
         Mesh* mesh = new Mesh;
 
+        /* A cache file from an earlier run skips parsing altogether */
+        unsigned cachedVertices = 0;
+        if (MeshCache::load(RES_DIR + fileName, doResize, [&](const MeshCache::Streams& streams) {
+            _upload(mesh, streams);
+            cachedVertices = streams.mPositionCount / 3;
+        })) {
+            if (mVerbose) {
+                std::cout << "Loaded cached mesh (" << cachedVertices << " vertices): " << fileName << std::endl;
+            }
+            return mesh;
+        }
+
         /* If mesh was not found in map, read it in */
         std::vector<tinyobj::shape_t> shapes;
         std::vector<tinyobj::material_t> objMaterials;
@@ -64,22 +77,31 @@ namespace neo {
         /* Optional resize and find min/max */
         _resize(mesh, vertices, doResize);
 
-        /* Upload */
-        mesh->mPrimitiveType = GL_TRIANGLE_STRIP;
-        if (vertices.size()) {
-            mesh->addVertexBuffer(VertexType::Position, 0, 3, vertices);
-        }
-        if (normals.size()) {
-            mesh->addVertexBuffer(VertexType::Normal, 1, 3, normals);
-        }
-        if (texCoords.size()) {
-            mesh->addVertexBuffer(VertexType::Texture0, 2, 2, texCoords);
-        }
-        if (indices.size()) {
-            mesh->mPrimitiveType = GL_TRIANGLES;
-            mesh->addElementBuffer(indices);
+        /* Big meshes are split into meshlets so the draw can skip what the camera can't see. This
+         * reorders the indices, so it happens before they're uploaded */
+        std::vector<Meshlet> meshlets;
+        if (indices.size() / 3 >= Meshlets::MinTriangles) {
+            meshlets = Meshlets::build(vertices, indices);
         }
 
+        /* Upload, and keep what was uploaded for next time */
+        MeshCache::Streams streams;
+        streams.mPositions = vertices.data();
+        streams.mPositionCount = unsigned(vertices.size());
+        streams.mNormals = normals.data();
+        streams.mNormalCount = unsigned(normals.size());
+        streams.mTexCoords = texCoords.data();
+        streams.mTexCoordCount = unsigned(texCoords.size());
+        streams.mIndices = indices.data();
+        streams.mIndexCount = unsigned(indices.size());
+        streams.mMeshlets = meshlets.data();
+        streams.mMeshletCount = unsigned(meshlets.size());
+        streams.mPrimitiveType = indices.size() ? GL_TRIANGLES : GL_TRIANGLE_STRIP;
+        streams.mMin = mesh->mMin;
+        streams.mMax = mesh->mMax;
+        _upload(mesh, streams);
+        MeshCache::store(RES_DIR + fileName, doResize, streams);
+
         if (mVerbose) {
             std::cout << "Loaded mesh (" << vertCount << " vertices): " << fileName << std::endl;
         }
@@ -220,6 +242,25 @@ namespace neo {
         stbi_image_free(data);
     }
 
+    void Loader::_upload(Mesh* mesh, const MeshCache::Streams& streams) {
+        mesh->mMin = streams.mMin;
+        mesh->mMax = streams.mMax;
+        mesh->mPrimitiveType = streams.mPrimitiveType;
+        if (streams.mPositionCount) {
+            mesh->addVertexBuffer(VertexType::Position, 0, 3, streams.mPositions, streams.mPositionCount);
+        }
+        if (streams.mNormalCount) {
+            mesh->addVertexBuffer(VertexType::Normal, 1, 3, streams.mNormals, streams.mNormalCount);
+        }
+        if (streams.mTexCoordCount) {
+            mesh->addVertexBuffer(VertexType::Texture0, 2, 2, streams.mTexCoords, streams.mTexCoordCount);
+        }
+        if (streams.mIndexCount) {
+            mesh->addElementBuffer(streams.mIndices, streams.mIndexCount);
+            mesh->mMeshlets.assign(streams.mMeshlets, streams.mMeshlets + streams.mMeshletCount);
+        }
+    }
+
     /* Provided function to resize a mesh so all vertex positions are [0, 1.f] */
     void Loader::_resize(Mesh* mesh, std::vector<float>& vertices, bool doResize) {
         float minX, minY, minZ;
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 
+#include "Loader/MeshCache.hpp"
 #include "Renderer/GLObjects/Texture2D.hpp"
 #include "Renderer/GLObjects/TextureCubeMap.hpp"
 
@@ -34,7 +35,7 @@ namespace neo {
         public:
             static void init(const std::string &, bool);
 
-            /* Load Mesh pointer from an .obj file */
+            /* Load Mesh pointer from an .obj file, or from MeshCache if it's been loaded before */
             static Mesh* loadMesh(const std::string &, bool = false);
             static std::vector<Asset> loadMultiAsset(const std::string &);
 
@@ -45,6 +46,8 @@ namespace neo {
         private:
             /* Resize mesh vertex buffers so all the vertices are [-1, 1] */
             static void _resize(Mesh*, std::vector<float>&, bool);
+            /* Create the mesh's buffers and copy over its bounds and meshlets */
+            static void _upload(Mesh*, const MeshCache::Streams&);
 
             /* Load a single texture file */
             static uint8_t* _loadTextureData(int&, int&, int&, const std::string&, TextureFormat, bool = true);
@@ -0,0 +1,270 @@
+#include "MeshCache.hpp"
+
+#include "Renderer/GLObjects/Meshlet.hpp"
+
+#include "ext/microprofile.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace neo {
+
+    bool MeshCache::mEnabled = true;
+    std::string MeshCache::mDirectory = "cache/";
+
+    namespace {
+        static_assert(std::is_trivially_copyable<Meshlet>::value, "Meshlets are written to the cache as they are");
+
+        /* Everything is native byte order -- the cache never leaves the machine that wrote it */
+        struct Header {
+            char mMagic[4];
+            uint32_t mVersion;
+            uint64_t mSourceSize;
+            int64_t mSourceTime;
+            uint64_t mSourceHash;
+            uint32_t mPrimitiveType;
+            uint32_t mMeshletSize;
+            float mMin[3];
+            float mMax[3];
+            uint32_t mPositionCount;
+            uint32_t mNormalCount;
+            uint32_t mTexCoordCount;
+            uint32_t mIndexCount;
+            uint32_t mMeshletCount;
+            uint32_t mPadding;
+        };
+        const char Magic[4] = { 'N', 'E', 'O', 'M' };
+
+        /* A whole file mapped read only, or nothing if it couldn't be */
+        class MappedFile {
+
+            public:
+                MappedFile(const std::string & path) {
+#ifdef _WIN32
+                    mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                    LARGE_INTEGER size;
+                    if (mFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(mFile, &size) || !size.QuadPart) {
+                        return;
+                    }
+                    mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                    if (!mMapping) {
+                        return;
+                    }
+                    mData = static_cast<const uint8_t *>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+                    mSize = mData ? size_t(size.QuadPart) : 0;
+#else
+                    const int file = open(path.c_str(), O_RDONLY);
+                    struct stat info;
+                    if (file < 0) {
+                        return;
+                    }
+                    if (!fstat(file, &info) && info.st_size) {
+                        void * data = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+                        if (data != MAP_FAILED) {
+                            mData = static_cast<const uint8_t *>(data);
+                            mSize = size_t(info.st_size);
+                        }
+                    }
+                    close(file);
+#endif
+                }
+
+                ~MappedFile() {
+#ifdef _WIN32
+                    if (mData) {
+                        UnmapViewOfFile(mData);
+                    }
+                    if (mMapping) {
+                        CloseHandle(mMapping);
+                    }
+                    if (mFile != INVALID_HANDLE_VALUE) {
+                        CloseHandle(mFile);
+                    }
+#else
+                    if (mData) {
+                        munmap(const_cast<uint8_t *>(mData), mSize);
+                    }
+#endif
+                }
+
+                MappedFile(const MappedFile &) = delete;
+                MappedFile & operator=(const MappedFile &) = delete;
+
+                const uint8_t * getData() const { return mData; }
+                size_t getSize() const { return mSize; }
+
+            private:
+#ifdef _WIN32
+                HANDLE mFile = INVALID_HANDLE_VALUE;
+                HANDLE mMapping = nullptr;
+#endif
+                const uint8_t * mData = nullptr;
+                size_t mSize = 0;
+        };
+
+        /* FNV-1a */
+        uint64_t _hash(const uint8_t * data, size_t size, uint64_t hash = 14695981039346656037ull) {
+            for (size_t i = 0; i < size; i++) {
+                hash = (hash ^ data[i]) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        uint64_t _hashFile(const std::string & path) {
+            MappedFile file(path);
+            return _hash(file.getData(), file.getSize());
+        }
+
+        /* The source's size and modification time, or false if it's gone */
+        bool _getSourceInfo(const std::string & source, uint64_t & size, int64_t & time) {
+            std::error_code error;
+            size = uint64_t(std::filesystem::file_size(source, error));
+            if (error) {
+                return false;
+            }
+            time = int64_t(std::filesystem::last_write_time(source, error).time_since_epoch().count());
+            return !error;
+        }
+
+        size_t _getFileSize(const Header & header) {
+            return sizeof(Header) +
+                (size_t(header.mPositionCount) + header.mNormalCount + header.mTexCoordCount) * sizeof(float) +
+                size_t(header.mIndexCount) * sizeof(unsigned) +
+                size_t(header.mMeshletCount) * sizeof(Meshlet);
+        }
+    }
+
+    std::string MeshCache::_getCachePath(const std::string & source, bool resized) {
+        std::error_code error;
+        const std::string key = std::filesystem::absolute(source, error).generic_string() + (resized ? "|resized" : "");
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.mesh", (unsigned long long)_hash(reinterpret_cast<const uint8_t *>(key.data()), key.size()));
+        return mDirectory + name;
+    }
+
+    bool MeshCache::load(const std::string & source, bool resized, const std::function<void(const Streams &)> & upload) {
+        MICROPROFILE_SCOPEI("MeshCache", "load", MP_AUTO);
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        if (!mEnabled || !_getSourceInfo(source, sourceSize, sourceTime)) {
+            return false;
+        }
+
+        const std::string path = _getCachePath(source, resized);
+        bool touched = false;
+        Header header;
+        {
+            MappedFile file(path);
+            if (file.getSize() < sizeof(Header)) {
+                return false;
+            }
+            memcpy(&header, file.getData(), sizeof(Header));
+            if (memcmp(header.mMagic, Magic, sizeof(Magic)) || header.mVersion != Version || header.mMeshletSize != sizeof(Meshlet) || _getFileSize(header) != file.getSize()) {
+                return false;
+            }
+
+            /* A source that was touched but not changed -- a fresh checkout, say -- is still a match */
+            if (header.mSourceSize != sourceSize || header.mSourceTime != sourceTime) {
+                if (header.mSourceSize != sourceSize || header.mSourceHash != _hashFile(source)) {
+                    return false;
+                }
+                touched = true;
+            }
+
+            /* Streams follow the header back to back. Every one is a whole number of 4 byte values, and the
+             * mapping is page aligned, so they can be used in place */
+            const uint8_t * data = file.getData() + sizeof(Header);
+            Streams streams;
+            auto take = [&data](auto *& out, unsigned count) {
+                out = reinterpret_cast<std::remove_reference_t<decltype(out)>>(data);
+                data += count * sizeof(*out);
+            };
+            take(streams.mPositions, streams.mPositionCount = header.mPositionCount);
+            take(streams.mNormals, streams.mNormalCount = header.mNormalCount);
+            take(streams.mTexCoords, streams.mTexCoordCount = header.mTexCoordCount);
+            take(streams.mIndices, streams.mIndexCount = header.mIndexCount);
+            take(streams.mMeshlets, streams.mMeshletCount = header.mMeshletCount);
+            streams.mPrimitiveType = header.mPrimitiveType;
+            streams.mMin = glm::vec3(header.mMin[0], header.mMin[1], header.mMin[2]);
+            streams.mMax = glm::vec3(header.mMax[0], header.mMax[1], header.mMax[2]);
+            upload(streams);
+        }
+
+        /* Remember the new time so the hash isn't needed next launch */
+        if (touched) {
+            header.mSourceTime = sourceTime;
+            if (FILE * file = fopen(path.c_str(), "r+b")) {
+                fwrite(&header, sizeof(Header), 1, file);
+                fclose(file);
+            }
+        }
+        return true;
+    }
+
+    void MeshCache::store(const std::string & source, bool resized, const Streams & streams) {
+        MICROPROFILE_SCOPEI("MeshCache", "store", MP_AUTO);
+        Header header = {};
+        if (!mEnabled || !_getSourceInfo(source, header.mSourceSize, header.mSourceTime)) {
+            return;
+        }
+        memcpy(header.mMagic, Magic, sizeof(Magic));
+        header.mVersion = Version;
+        header.mSourceHash = _hashFile(source);
+        header.mPrimitiveType = streams.mPrimitiveType;
+        header.mMeshletSize = sizeof(Meshlet);
+        for (int axis = 0; axis < 3; axis++) {
+            header.mMin[axis] = streams.mMin[axis];
+            header.mMax[axis] = streams.mMax[axis];
+        }
+        header.mPositionCount = streams.mPositionCount;
+        header.mNormalCount = streams.mNormalCount;
+        header.mTexCoordCount = streams.mTexCoordCount;
+        header.mIndexCount = streams.mIndexCount;
+        header.mMeshletCount = streams.mMeshletCount;
+
+        std::error_code error;
+        std::filesystem::create_directories(mDirectory, error);
+        if (error) {
+            return;
+        }
+
+        /* Written beside the real file and renamed over it, so a half-written cache is never picked up */
+        const std::string path = _getCachePath(source, resized);
+        const std::string temporary = path + ".tmp";
+        FILE * file = fopen(temporary.c_str(), "wb");
+        if (!file) {
+            return;
+        }
+        bool written = fwrite(&header, sizeof(Header), 1, file) == 1;
+        auto put = [&](const auto * data, unsigned count) {
+            written = written && (!count || fwrite(data, sizeof(*data), count, file) == count);
+        };
+        put(streams.mPositions, streams.mPositionCount);
+        put(streams.mNormals, streams.mNormalCount);
+        put(streams.mTexCoords, streams.mTexCoordCount);
+        put(streams.mIndices, streams.mIndexCount);
+        put(streams.mMeshlets, streams.mMeshletCount);
+        written = !fclose(file) && written;
+
+        if (written) {
+            std::filesystem::rename(temporary, path, error);
+        }
+        if (!written || error) {
+            std::filesystem::remove(temporary, error);
+        }
+    }
+}
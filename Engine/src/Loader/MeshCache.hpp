@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <string>
+
+namespace neo {
+
+    struct Meshlet;
+
+    /* Loader's finished meshes on disk, so later launches skip parsing. Each source file and resize setting gets
+     * one cache file holding the streams exactly as they're uploaded, the meshlets over them, the bounds, and the
+     * primitive type. A cache file is used while its source has the size and modification time it was written
+     * with -- or, if those changed, the same content hash. It's memory mapped, and the streams go to GL straight
+     * from the mapping */
+    class MeshCache {
+
+        public:
+            /* Bump when the file layout changes, or what Loader does to a mesh before upload */
+            static const unsigned Version = 1;
+
+            static bool mEnabled;
+            /* Where cache files go. Set by Loader::init */
+            static std::string mDirectory;
+
+            /* A mesh ready for upload. Arrays aren't owned, and on load only live for the upload callback */
+            struct Streams {
+                const float * mPositions = nullptr;
+                unsigned mPositionCount = 0;
+                const float * mNormals = nullptr;
+                unsigned mNormalCount = 0;
+                const float * mTexCoords = nullptr;
+                unsigned mTexCoordCount = 0;
+                const unsigned * mIndices = nullptr;
+                unsigned mIndexCount = 0;
+                const Meshlet * mMeshlets = nullptr;
+                unsigned mMeshletCount = 0;
+                unsigned mPrimitiveType = 0;
+                glm::vec3 mMin = glm::vec3(0.f);
+                glm::vec3 mMax = glm::vec3(0.f);
+            };
+
+            /* Maps source's cache file and hands its streams to upload. False if there's no current one */
+            static bool load(const std::string & source, bool resized, const std::function<void(const Streams &)> & upload);
+            /* Writes source's cache file. Failing to is harmless -- the next launch just parses again */
+            static void store(const std::string & source, bool resized, const Streams & streams);
+
+        private:
+            static std::string _getCachePath(const std::string & source, bool resized);
+    };
+}
@@ -21,29 +21,48 @@
 // game object and message type. This is for efficient inter-component
 // communication.
 //
-// The scene keeps a list of messages, and what type they were, until it's time
-// to relay the messages. This happens before and after every system update.
-// The system will only relay messages to any receivers of the corresponding
-// type. A receiver is a std::function<void (const Message &)> . To add a
-// receiver, do...
+// The scene keeps a queue of messages per message type, holding the messages
+// by value, until it's time to relay the messages. This happens before and
+// after every system update. Messages are relayed one type at a time, in the
+// order each type was first used, and in the order they were sent within a
+// type. A receiver is any callable taking (const MessageType &) that fits in
+// a Delegate -- a few pointers' worth of captures, never heap allocated. To
+// add a receiver, do...
 //
-//     Scene::addReceiver<MessageType>([nullptr | gameobject], receiver);
+//     mSubscription = Scene::addReceiver<MessageType>([nullptr | gameobject], receiver);
+//
+// The receiver stays registered until the returned Subscription is destroyed
+// or released, so keep it as a member of whatever the receiver captures.
+// Receivers live in the message type's queue, sorted by gameobject -- game
+// objects don't carry any receiver storage themselves.
 //
 // Here, if gameobject is null, the receiver will receive all messages of the
 // specified type. If gameobject is not null, the receiver will only receive
 // messages of the specified type that have been sent to that object. This is
 // how you do efficient inter-component communication.
 //
-// For receiver, can pass either a function pointer or a lambda. Note, you can
-// technically bind a method to a std::function, but it's ugly. For adding
+// For receiver, can pass either a function pointer or a lambda. For adding
 // receivers from objects that can reference that object, I reccommend using a
 // lambda, like so...
 //    
-//    auto receiver = [&](const Message & msg_) {
-//        const MessageIWantType & msg(static_cast<const MessageIWantType &>(msg_));
+//    auto receiver = [&](const MessageIWantType & msg) {
 //        ...
 //    };
-//    Scene::addReceiver<MessageIWantType>(receiver);
+//    mSubscription = Scene::addReceiver<MessageIWantType>(nullptr, receiver);
+//
+// Messages are stored by value, so keep them small and copyable.
+//
+// A message type can opt in to coalescing by setting Coalesce to true. Then
+// only the latest message of that type sent to each gameobject (or to nullptr)
+// is kept until the next relay -- it takes the place of the first one that was
+// sent. This is for messages where receivers only care that something changed,
+// like SpatialChangeMessage. Coalesced messages must be copy assignable.
+//
+// Messages can be sent from worker threads. Each thread pushes into its own
+// buffer, and the buffers are merged on the main thread at the next relay --
+// after the main thread's messages, sorted by gameobject creation order.
+// Receivers are still added and called on the main thread only, and relaying
+// must not overlap with workers that are sending.
 //
 //------------------------------------------------------------------------------
 
@@ -57,7 +76,8 @@ namespace neo {
 
 
     struct Message {
-        virtual ~Message() = default;
+        /* Keep only the latest message per gameobject between relays */
+        static constexpr bool Coalesce = false;
     };
 
 
@@ -65,12 +85,28 @@ namespace neo {
 
     /* A spatiality was changed in some way */
     struct SpatialChangeMessage : public Message {
-        const SpatialComponent & spatial;
-        SpatialChangeMessage(const SpatialComponent & spatial) : spatial(spatial) {}
+        static constexpr bool Coalesce = true;
+        const SpatialComponent * spatial;
+        SpatialChangeMessage(const SpatialComponent & spatial) : spatial(&spatial) {}
+    };
+
+    /* Two colliders started touching. Sent to each of them in turn as object */
+    struct CollisionEnterMessage : public Message {
+        const GameObject * object;
+        const GameObject * other;
+        CollisionEnterMessage(const GameObject * object, const GameObject * other) : object(object), other(other) {}
+    };
+
+    /* Two colliders stopped touching. other is null if it was removed */
+    struct CollisionExitMessage : public Message {
+        const GameObject * object;
+        const GameObject * other;
+        CollisionExitMessage(const GameObject * object, const GameObject * other) : object(object), other(other) {}
     };
 
     /* The window was resized */
     struct WindowFrameSizeMessage : public Message {
+        static constexpr bool Coalesce = true;
         glm::uvec2 frameSize;
         WindowFrameSizeMessage(const glm::uvec2 & frameSize) : frameSize(frameSize) {}
     };
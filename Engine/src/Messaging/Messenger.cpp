@@ -6,41 +6,61 @@
 
 namespace neo {
 
-    std::vector<std::tuple<const GameObject *, std::type_index, std::unique_ptr<Message>>> Messenger::mMessages;
-    std::unordered_map<std::type_index, std::vector<std::function<void (const Message &)>>> Messenger::mReceivers;
+    std::vector<Messenger::MessageQueueBase *> * Messenger::mQueues = new std::vector<Messenger::MessageQueueBase *>;
+    std::mutex Messenger::mQueuesMutex;
+    /* Static init happens on the main thread */
+    const std::thread::id Messenger::mMainThread = std::this_thread::get_id();
+
+    unsigned Messenger::_registerQueue(MessageQueueBase * queue) {
+        std::lock_guard<std::mutex> lock(mQueuesMutex);
+        mQueues->push_back(queue);
+        return unsigned(mQueues->size() - 1);
+    }
+
+    Subscription::Subscription(Subscription && other) noexcept :
+        mTypeID(other.mTypeID),
+        mObjectID(other.mObjectID),
+        mReceiverID(other.mReceiverID) {
+        other.mReceiverID = 0;
+    }
+
+    Subscription & Subscription::operator=(Subscription && other) noexcept {
+        if (this != &other) {
+            release();
+            mTypeID = other.mTypeID;
+            mObjectID = other.mObjectID;
+            mReceiverID = other.mReceiverID;
+            other.mReceiverID = 0;
+        }
+        return *this;
+    }
+
+    void Subscription::release() {
+        if (!mReceiverID) {
+            return;
+        }
+        assert(Messenger::_isMainThread());
+        (*Messenger::mQueues)[mTypeID]->removeReceiver(mObjectID, mReceiverID);
+        mReceiverID = 0;
+    }
 
     void Messenger::relayMessages() {
         MICROPROFILE_SCOPEI("Messenger", "relayMessages()", MP_AUTO);
-        static std::vector<std::tuple<const GameObject *, std::type_index, std::unique_ptr<Message>>> messageBuffer;
-
-        if (mMessages.size()) {
-            /* Corrections for messages sent from receivers */
-            std::swap(mMessages, messageBuffer);
-
-            for (auto & message : messageBuffer) {
-                const GameObject * gameObject(std::get<0>(message));
-                std::type_index msgTypeI(std::get<1>(message));
-                auto & msg(std::get<2>(message));
-
-                /* Send object-level messages */
-                if (gameObject) {
-                    auto objectReceivers(gameObject->mReceivers.find(msgTypeI));
-                    if (objectReceivers != gameObject->mReceivers.end()) {
-                        for (auto & receiver : objectReceivers->second) {
-                            receiver(*msg);
-                        }
-                    }
-                }
-
-                /* Send scene-level messages */
-                auto localReceivers(mReceivers.find(msgTypeI));
-                if (localReceivers != mReceivers.end()) {
-                    for (auto & receiver : localReceivers->second) {
-                        receiver(*msg);
-                    }
-                }
-            }
-            messageBuffer.clear();
+        assert(_isMainThread());
+
+        /* Worker messages land after the main thread's */
+        for (unsigned i = 0; i < mQueues->size(); i++) {
+            (*mQueues)[i]->mergeProducers();
+        }
+
+        /* Corrections for messages sent from receivers -- they're held until the next relay */
+        for (auto queue : *mQueues) {
+            queue->swapBuffers();
+        }
+
+        /* Receivers may touch a message type for the first time, so don't hold iterators */
+        for (unsigned i = 0; i < mQueues->size(); i++) {
+            (*mQueues)[i]->relay();
         }
     }
 }
\ No newline at end of file
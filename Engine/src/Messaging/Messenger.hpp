@@ -2,47 +2,430 @@
 
 #include "Message.hpp"
 
+#include "ECS/GameObject.hpp"
+#include "Util/Delegate.hpp"
+#include "Util/Counters.hpp"
+#include "Util/ThreadPool.hpp"
+
 #include <vector>
-#include <unordered_map>
-#include <typeindex>
 #include <memory>
-#include <functional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+#include <iterator>
+#include <typeinfo>
+#include <cassert>
 
 namespace neo {
 
-    class GameObject;
+    /* Keeps a receiver registered for as long as it's alive. Hold it next to whatever the receiver captures,
+     * usually as a member of the component or shader, so the receiver goes away with it */
+    class Subscription {
+
+        friend class Messenger;
+
+        public:
+            Subscription() = default;
+            ~Subscription() { release(); }
+
+            Subscription(Subscription && other) noexcept;
+            Subscription & operator=(Subscription && other) noexcept;
+            Subscription(const Subscription &) = delete;
+            Subscription & operator=(const Subscription &) = delete;
+
+            /* Removes the receiver now. Safe to call from inside a receiver */
+            void release();
+            explicit operator bool() const { return mReceiverID != 0; }
+
+        private:
+            Subscription(unsigned typeID, unsigned objectID, unsigned receiverID) :
+                mTypeID(typeID),
+                mObjectID(objectID),
+                mReceiverID(receiverID)
+            {}
+
+            unsigned mTypeID = 0;
+            unsigned mObjectID = 0;
+            unsigned mReceiverID = 0;
+    };
 
     class Messenger {
 
+        friend Subscription;
+
         public:
             /* Sends out a message for any receivers of that message type to pick up
-             * If gameObject is not null, first sends the message locally to receivers of only that object. */
+             * If gameObject is not null, first sends the message locally to receivers of only that object.
+             * If MsgT::Coalesce is set, replaces any message of that type already queued for gameObject
+             * Safe to call from worker threads. Messages sent off the main thread or from inside a ThreadPool task
+             * are buffered per thread and merged on the next relay, after the main thread's other messages. They're
+             * ordered by GameObject creation order, then by the task that sent them, then send order -- so which
+             * thread ran which task doesn't matter. Threads outside the ThreadPool keep their own send order, but
+             * how their messages interleave with each other's is undefined */
             template <typename MsgT, typename... Args> static void sendMessage(const GameObject * gameObject, Args &&... args);
 
-            /* Adds a receiver for a message type. If gameObject is null, the function will be called for all messages 
-            of that type. If gameObject is not null, the function will be called for only messages of that type sent to that object */
-            template <typename MsgT> static void addReceiver(const GameObject * gameObject, const std::function<void(const Message &)> & func);
+            /* Adds a receiver for a message type. If gameObject is null, the function will be called for all messages
+            of that type. If gameObject is not null, the function will be called for only messages of that type sent to that object
+            The receiver is stored inline (see Delegate) and stays registered until the returned Subscription dies.
+            Receivers added during a relay start receiving on the next one */
+            template <typename MsgT, typename F> [[nodiscard]] static Subscription addReceiver(const GameObject * gameObject, F && func);
 
+            /* Main thread only, and never while workers are sending */
             static void relayMessages();
 
         private:
-            static std::vector<std::tuple<const GameObject *, std::type_index, std::unique_ptr<Message>>> mMessages;
-            static std::unordered_map<std::type_index, std::vector<std::function<void(const Message &)>>> mReceivers;
+            /* Every message type gets its own queue that holds messages by value. The base
+             * is only used to walk all of the queues once per relay -- never once per message */
+            struct MessageQueueBase {
+                virtual ~MessageQueueBase() = default;
+                virtual void mergeProducers() = 0;
+                virtual void swapBuffers() = 0;
+                virtual void relay() = 0;
+                virtual void removeReceiver(unsigned objectID, unsigned receiverID) = 0;
+            };
+
+            /* Receivers of every type live in their queue, sorted by the ID of the GameObject they listen to.
+             * Scene-level receivers use 0 so they sort first */
+            template <typename MsgT>
+            struct Receiver {
+                unsigned mObjectID;
+                /* 0 once removed -- removed receivers are only erased at the start of a relay */
+                unsigned mID;
+                Delegate<void(const MsgT &)> mFunc;
+            };
+
+            /* Messages sent from a worker thread. Each buffer is written by one thread at a time and only read
+             * by the main thread during relay, so pushing a message is a plain vector append */
+            template <typename MsgT>
+            struct ProducerBuffer {
+                std::vector<std::pair<const GameObject *, MsgT>> mMessages;
+                /* The ThreadPool task each run of mMessages was sent from, and where the run starts */
+                std::vector<std::pair<uint64_t, unsigned>> mTasks;
+                std::atomic<bool> mClaimed = true;
+                ProducerBuffer * mNext = nullptr;
+            };
+
+            /* A run of one buffer's messages, all sent from the same task */
+            template <typename MsgT>
+            struct ProducerRun {
+                uint64_t mTask;
+                std::pair<const GameObject *, MsgT> * mBegin;
+                std::pair<const GameObject *, MsgT> * mEnd;
+            };
+
+            /* Releases a thread's buffer for reuse when the thread exits */
+            template <typename MsgT>
+            struct ProducerClaim {
+                ProducerBuffer<MsgT> * mBuffer = nullptr;
+                ~ProducerClaim() { if (mBuffer) { mBuffer->mClaimed.store(false, std::memory_order_release); } }
+            };
+
+            template <typename MsgT>
+            struct MessageQueue : public MessageQueueBase {
+                MessageQueue();
+                virtual void mergeProducers() override { Messenger::_mergeProducers(*this); }
+                virtual void swapBuffers() override { std::swap(mMessages, mRelayBuffer); }
+                virtual void relay() override { Messenger::_relay(*this); }
+                virtual void removeReceiver(unsigned objectID, unsigned receiverID) override { Messenger::_removeReceiver(*this, objectID, receiverID); }
+
+                const unsigned mTypeID;
+                std::vector<std::pair<const GameObject *, MsgT>> mMessages;
+                std::vector<std::pair<const GameObject *, MsgT>> mRelayBuffer;
+                std::vector<Receiver<MsgT>> mReceivers;
+                /* Held until the next relay so the sorted list never changes while it's being walked */
+                std::vector<Receiver<MsgT>> mAddedReceivers;
+                unsigned mNextReceiverID;
+                unsigned mRemovedReceivers;
+                /* Main thread sends since the last relay. Counters are registered on the first relay, since
+                 * the queue itself may be created on a worker */
+                unsigned mNumSent;
+                unsigned mSentCounter;
+                unsigned mRelayedCounter;
+                /* Index into mMessages of the last coalesced message sent without a GameObject */
+                unsigned mGlobalPending;
+                /* Lock-free list of worker buffers -- only ever grows, buffers are reused once their thread exits */
+                std::atomic<ProducerBuffer<MsgT> *> mProducers;
+                /* Merge scratch, kept between relays so merging doesn't allocate */
+                std::vector<ProducerRun<MsgT>> mRuns;
+                std::vector<std::pair<unsigned, std::pair<const GameObject *, MsgT> *>> mMerged;
+                std::vector<std::pair<unsigned, std::pair<const GameObject *, MsgT> *>> mSorted;
+                std::vector<unsigned> mOffsets;
+            };
+
+            template <typename MsgT> static MessageQueue<MsgT> & _getQueue();
+            template <typename MsgT> static ProducerBuffer<MsgT> & _getProducerBuffer(MessageQueue<MsgT> &);
+            template <typename MsgT> static void _enqueue(MessageQueue<MsgT> &, const GameObject *, MsgT &&);
+            template <typename MsgT> static void _mergeProducers(MessageQueue<MsgT> &);
+            template <typename MsgT> static void _relay(MessageQueue<MsgT> &);
+            template <typename MsgT> static void _updateReceivers(MessageQueue<MsgT> &);
+            template <typename MsgT> static void _removeReceiver(MessageQueue<MsgT> &, unsigned objectID, unsigned receiverID);
+            /* Returns where a coalesced message for gameObject should be written, and whether it's already queued */
+            template <typename MsgT> static std::pair<unsigned, bool> _findPending(MessageQueue<MsgT> &, const GameObject *);
+
+            /* Queues are created on first use, which may be on a worker */
+            static unsigned _registerQueue(MessageQueueBase *);
+            static bool _isMainThread() { return std::this_thread::get_id() == mMainThread; }
+
+            /* Never destroyed, so Subscriptions held by other statics can still release at exit */
+            static std::vector<MessageQueueBase *> * mQueues;
+            static std::mutex mQueuesMutex;
+            static const std::thread::id mMainThread;
     };
 
+    /* Template implementation */
+    template <typename MsgT>
+    Messenger::MessageQueue<MsgT>::MessageQueue() :
+        mTypeID(_registerQueue(this)),
+        mMessages(),
+        mRelayBuffer(),
+        mReceivers(),
+        mAddedReceivers(),
+        mNextReceiverID(1),
+        mRemovedReceivers(0),
+        mNumSent(0),
+        mSentCounter(~0u),
+        mRelayedCounter(~0u),
+        mGlobalPending(0),
+        mProducers(nullptr),
+        mRuns(),
+        mMerged(),
+        mSorted(),
+        mOffsets()
+    {}
+
+    template <typename MsgT>
+    Messenger::MessageQueue<MsgT> & Messenger::_getQueue() {
+        /* Leaked on purpose along with mQueues */
+        static MessageQueue<MsgT> * queue = new MessageQueue<MsgT>;
+        return *queue;
+    }
+
+    template <typename MsgT>
+    Messenger::ProducerBuffer<MsgT> & Messenger::_getProducerBuffer(MessageQueue<MsgT> & queue) {
+        thread_local ProducerClaim<MsgT> claim;
+        if (claim.mBuffer) {
+            return *claim.mBuffer;
+        }
+
+        /* Reuse a buffer left behind by a thread that has exited */
+        for (ProducerBuffer<MsgT> * buffer = queue.mProducers.load(std::memory_order_acquire); buffer; buffer = buffer->mNext) {
+            bool claimed = false;
+            if (buffer->mClaimed.compare_exchange_strong(claimed, true, std::memory_order_acquire)) {
+                claim.mBuffer = buffer;
+                return *buffer;
+            }
+        }
+
+        /* Otherwise push a new one to the front of the list */
+        ProducerBuffer<MsgT> * buffer = new ProducerBuffer<MsgT>;
+        buffer->mNext = queue.mProducers.load(std::memory_order_relaxed);
+        while (!queue.mProducers.compare_exchange_weak(buffer->mNext, buffer, std::memory_order_release, std::memory_order_relaxed));
+        claim.mBuffer = buffer;
+        return *buffer;
+    }
+
     template <typename MsgT, typename... Args>
     void Messenger::sendMessage(const GameObject *gameObject, Args &&... args) {
         static_assert(std::is_base_of<Message, MsgT>::value, "MsgT must be a message type");
-        mMessages.emplace_back(gameObject, typeid(MsgT), std::make_unique<MsgT>(std::forward<Args>(args)...));
+        static_assert(!MsgT::Coalesce || std::is_copy_assignable<MsgT>::value, "Coalesced messages must be copy assignable");
+
+        auto & queue = _getQueue<MsgT>();
+        const uint64_t task = ThreadPool::getCurrentTask();
+        if (!_isMainThread() || task != ThreadPool::NoTask) {
+            /* Coalescing touches the GameObject, so it's deferred to the merge */
+            auto & buffer = _getProducerBuffer(queue);
+            if (buffer.mTasks.empty() || buffer.mTasks.back().first != task) {
+                buffer.mTasks.emplace_back(task, unsigned(buffer.mMessages.size()));
+            }
+            buffer.mMessages.emplace_back(gameObject, MsgT(std::forward<Args>(args)...));
+            return;
+        }
+        _enqueue(queue, gameObject, MsgT(std::forward<Args>(args)...));
+    }
+
+    template <typename MsgT>
+    void Messenger::_enqueue(MessageQueue<MsgT> & queue, const GameObject * gameObject, MsgT && msg) {
+        queue.mNumSent++;
+        if constexpr (MsgT::Coalesce) {
+            auto pending = _findPending(queue, gameObject);
+            if (pending.second) {
+                queue.mMessages[pending.first].second = std::move(msg);
+                return;
+            }
+        }
+        queue.mMessages.emplace_back(gameObject, std::move(msg));
     }
 
     template <typename MsgT>
-    void Messenger::addReceiver(const GameObject *gameObject, const std::function<void(const Message &)> & func) {
+    void Messenger::_mergeProducers(MessageQueue<MsgT> & queue) {
+        /* Gather run by run in task order. Runs from outside the ThreadPool go last, in no particular order */
+        auto & runs = queue.mRuns;
+        runs.clear();
+        for (ProducerBuffer<MsgT> * buffer = queue.mProducers.load(std::memory_order_acquire); buffer; buffer = buffer->mNext) {
+            auto & messages = buffer->mMessages;
+            for (unsigned i = 0; i < buffer->mTasks.size(); i++) {
+                const unsigned end = i + 1 < buffer->mTasks.size() ? buffer->mTasks[i + 1].second : unsigned(messages.size());
+                runs.push_back({ buffer->mTasks[i].first, messages.data() + buffer->mTasks[i].second, messages.data() + end });
+            }
+        }
+        if (runs.empty()) {
+            return;
+        }
+        std::stable_sort(runs.begin(), runs.end(), [](const ProducerRun<MsgT> & a, const ProducerRun<MsgT> & b) { return a.mTask < b.mTask; });
+
+        auto & merged = queue.mMerged;
+        merged.clear();
+        unsigned maxID = 0;
+        for (auto & run : runs) {
+            for (auto message = run.mBegin; message != run.mEnd; ++message) {
+                const unsigned id = message->first ? message->first->getID() : 0;
+                maxID = std::max(maxID, id);
+                merged.emplace_back(id, message);
+            }
+        }
+
+        /* Then a stable sort by the object each message was sent to, leaving each object's messages in task
+         * order. Radix sort on the ID 16 bits at a time, unless there are too few messages to be worth it */
+        auto byObject = [](const std::pair<unsigned, std::pair<const GameObject *, MsgT> *> & a, const std::pair<unsigned, std::pair<const GameObject *, MsgT> *> & b) {
+            return a.first < b.first;
+        };
+        if (merged.size() < 1024) {
+            std::stable_sort(merged.begin(), merged.end(), byObject);
+        }
+        else {
+            auto & sorted = queue.mSorted;
+            auto & offsets = queue.mOffsets;
+            sorted.resize(merged.size());
+            for (unsigned shift = 0; shift < 32 && (maxID >> shift); shift += 16) {
+                offsets.assign((1 << 16) + 1, 0);
+                for (auto & entry : merged) {
+                    offsets[((entry.first >> shift) & 0xFFFF) + 1]++;
+                }
+                for (unsigned i = 1; i < offsets.size(); i++) {
+                    offsets[i] += offsets[i - 1];
+                }
+                for (auto & entry : merged) {
+                    sorted[offsets[(entry.first >> shift) & 0xFFFF]++] = entry;
+                }
+                std::swap(merged, sorted);
+            }
+        }
+
+        for (auto & entry : merged) {
+            _enqueue(queue, entry.second->first, std::move(entry.second->second));
+        }
+
+        for (ProducerBuffer<MsgT> * buffer = queue.mProducers.load(std::memory_order_acquire); buffer; buffer = buffer->mNext) {
+            buffer->mMessages.clear();
+            buffer->mTasks.clear();
+        }
+    }
+
+    template <typename MsgT, typename F>
+    Subscription Messenger::addReceiver(const GameObject *gameObject, F && func) {
         static_assert(std::is_base_of<Message, MsgT>::value, "MsgT must be a message type");
+        assert(_isMainThread());
+
+        auto & queue = _getQueue<MsgT>();
+        const unsigned objectID = gameObject ? gameObject->getID() : 0;
+        const unsigned receiverID = queue.mNextReceiverID++;
+        queue.mAddedReceivers.push_back({ objectID, receiverID, Delegate<void(const MsgT &)>(std::forward<F>(func)) });
+        return Subscription(queue.mTypeID, objectID, receiverID);
+    }
+
+    template <typename MsgT>
+    void Messenger::_removeReceiver(MessageQueue<MsgT> & queue, unsigned objectID, unsigned receiverID) {
+        for (auto it = queue.mAddedReceivers.begin(); it != queue.mAddedReceivers.end(); ++it) {
+            if (it->mID == receiverID) {
+                queue.mAddedReceivers.erase(it);
+                return;
+            }
+        }
+
+        /* Might be mid-relay, so only mark it */
+        auto it = std::lower_bound(queue.mReceivers.begin(), queue.mReceivers.end(), objectID, [](const Receiver<MsgT> & r, unsigned id) { return r.mObjectID < id; });
+        for (; it != queue.mReceivers.end() && it->mObjectID == objectID; ++it) {
+            if (it->mID == receiverID) {
+                it->mID = 0;
+                queue.mRemovedReceivers++;
+                return;
+            }
+        }
+    }
+
+    template <typename MsgT>
+    void Messenger::_updateReceivers(MessageQueue<MsgT> & queue) {
+        auto & receivers = queue.mReceivers;
+        if (queue.mRemovedReceivers) {
+            receivers.erase(std::remove_if(receivers.begin(), receivers.end(), [](const Receiver<MsgT> & r) { return !r.mID; }), receivers.end());
+            queue.mRemovedReceivers = 0;
+        }
+
+        if (queue.mAddedReceivers.size()) {
+            auto byObject = [](const Receiver<MsgT> & a, const Receiver<MsgT> & b) { return a.mObjectID < b.mObjectID; };
+            const std::size_t sorted = receivers.size();
+            std::move(queue.mAddedReceivers.begin(), queue.mAddedReceivers.end(), std::back_inserter(receivers));
+            queue.mAddedReceivers.clear();
+            std::stable_sort(receivers.begin() + sorted, receivers.end(), byObject);
+            std::inplace_merge(receivers.begin(), receivers.begin() + sorted, receivers.end(), byObject);
+        }
+    }
+
+    template <typename MsgT>
+    std::pair<unsigned, bool> Messenger::_findPending(MessageQueue<MsgT> & queue, const GameObject * gameObject) {
+        const unsigned next = unsigned(queue.mMessages.size());
+        unsigned & slot = gameObject ? const_cast<GameObject *>(gameObject)->_getPendingMessage(queue.mTypeID) : queue.mGlobalPending;
+
+        /* Slots aren't reset on relay. A stale slot either points past the end or at another object's message */
+        if (slot < next && queue.mMessages[slot].first == gameObject) {
+            return { slot, true };
+        }
+        slot = next;
+        return { next, false };
+    }
+
+    template <typename MsgT>
+    void Messenger::_relay(MessageQueue<MsgT> & queue) {
+        _updateReceivers(queue);
+
+        if (queue.mSentCounter == ~0u) {
+            queue.mSentCounter = Counters::add("Messages sent", typeid(MsgT).name());
+            queue.mRelayedCounter = Counters::add("Messages relayed", typeid(MsgT).name());
+        }
+        Counters::increment(Counters::MessagesSent, queue.mNumSent);
+        Counters::increment(queue.mSentCounter, queue.mNumSent);
+        Counters::increment(Counters::MessagesRelayed, queue.mRelayBuffer.size());
+        Counters::increment(queue.mRelayedCounter, queue.mRelayBuffer.size());
+        queue.mNumSent = 0;
+
+        auto byObject = [](const Receiver<MsgT> & r, unsigned id) { return r.mObjectID < id; };
+        const auto begin = queue.mReceivers.cbegin();
+        const auto end = queue.mReceivers.cend();
+        const auto sceneEnd = std::lower_bound(begin, end, 1u, byObject);
+
+        for (auto & message : queue.mRelayBuffer) {
+            const GameObject * gameObject(message.first);
+            const MsgT & msg(message.second);
 
-        auto & receiver =  gameObject ? const_cast<GameObject *>(gameObject)->mReceivers : mReceivers;
-        receiver[std::type_index(typeid(MsgT))].emplace_back(func);
+            /* Send object-level messages */
+            if (gameObject && sceneEnd != end) {
+                const unsigned id = gameObject->getID();
+                for (auto it = std::lower_bound(sceneEnd, end, id, byObject); it != end && it->mObjectID == id; ++it) {
+                    if (it->mID) {
+                        it->mFunc(msg);
+                    }
+                }
+            }
 
+            /* Send scene-level messages */
+            for (auto it = begin; it != sceneEnd; ++it) {
+                if (it->mID) {
+                    it->mFunc(msg);
+                }
+            }
+        }
+        queue.mRelayBuffer.clear();
     }
 
 }
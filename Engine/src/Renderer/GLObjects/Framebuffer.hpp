@@ -7,6 +7,8 @@
 
 #include "Texture2D.hpp"
 
+#include "Util/Counters.hpp"
+
 #include <vector>
 
 namespace neo {
@@ -23,6 +25,7 @@ namespace neo {
         }
         
         void bind() {
+            Counters::increment(Counters::FBOSwitches);
             CHECK_GL(glBindFramebuffer(GL_FRAMEBUFFER, mFBOID));
         }
         
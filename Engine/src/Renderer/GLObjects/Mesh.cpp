@@ -6,6 +6,7 @@
 #include "Renderer/GLObjects/GLHelper.hpp"
 
 #include "Util/Util.hpp"
+#include "Util/Counters.hpp"
 
 namespace neo {
 
@@ -25,20 +26,65 @@ namespace neo {
     void Mesh::draw(unsigned size) const {
         const auto& positions = getVBO(VertexType::Position);
 
+        unsigned count;
         CHECK_GL(glBindVertexArray(mVAOID));
         if (mElementVBO) {
-            CHECK_GL(glDrawElements(mPrimitiveType, size ? size : mElementVBO->bufferSize, GL_UNSIGNED_INT, nullptr));
+            count = size ? size : mElementVBO->bufferSize;
+            CHECK_GL(glDrawElements(mPrimitiveType, count, GL_UNSIGNED_INT, nullptr));
         }
         else if (size) {
+            count = size;
             CHECK_GL(glDrawArrays(mPrimitiveType, 0, size));
         }
         else {
-            CHECK_GL(glDrawArrays(mPrimitiveType, 0, positions.bufferSize / positions.stride));
+            count = positions.bufferSize / positions.stride;
+            CHECK_GL(glDrawArrays(mPrimitiveType, 0, count));
         }
         CHECK_GL(glBindVertexArray(0));
+
+        Counters::increment(Counters::DrawCalls);
+        if (mPrimitiveType == GL_TRIANGLES) {
+            Counters::increment(Counters::Triangles, count / 3);
+        }
+        else if (mPrimitiveType == GL_TRIANGLE_STRIP && count >= 3) {
+            Counters::increment(Counters::Triangles, count - 2);
+        }
+    }
+
+    void Mesh::draw(const glm::mat4 & P, const glm::mat4 & V, const glm::mat4 & M) const {
+        if (mMeshlets.empty() || !mElementVBO || !Meshlets::mEnabled) {
+            draw();
+            return;
+        }
+
+        /* The camera in object space -- its position, or the way back toward it for orthographic projections */
+        const bool orthographic = P[3][3] == 1.f;
+        const glm::vec4 eye = glm::inverse(V * M) * (orthographic ? glm::vec4(0.f, 0.f, 1.f, 0.f) : glm::vec4(0.f, 0.f, 0.f, 1.f));
+
+        Meshlets::cull(mMeshlets, P * V * M, eye, mFirstIndices, mIndexCounts);
+        if (mFirstIndices.empty()) {
+            return;
+        }
+        mOffsets.resize(mFirstIndices.size());
+        unsigned count = 0;
+        for (unsigned i = 0; i < mFirstIndices.size(); i++) {
+            mOffsets[i] = (const void *)(size_t(mFirstIndices[i]) * sizeof(unsigned));
+            count += mIndexCounts[i];
+        }
+
+        CHECK_GL(glBindVertexArray(mVAOID));
+        CHECK_GL(glMultiDrawElements(mPrimitiveType, (const GLsizei *)mIndexCounts.data(), GL_UNSIGNED_INT, mOffsets.data(), GLsizei(mFirstIndices.size())));
+        CHECK_GL(glBindVertexArray(0));
+
+        Counters::increment(Counters::DrawCalls);
+        Counters::increment(Counters::Triangles, count / 3);
     }
 
     void Mesh::addVertexBuffer(VertexType type, unsigned attribArray, unsigned stride, const std::vector<float>& buffer) {
+        addVertexBuffer(type, attribArray, stride, buffer.data(), unsigned(buffer.size()));
+    }
+
+    void Mesh::addVertexBuffer(VertexType type, unsigned attribArray, unsigned stride, const float* data, unsigned size) {
         {
             const auto& vbo = mVBOs.find(type);
             NEO_ASSERT(vbo == mVBOs.end(), "Attempting to add a VertexBuffer that already exists");
@@ -47,14 +93,15 @@ namespace neo {
         auto vertexBuffer = VertexBuffer{};
         vertexBuffer.attribArray = attribArray;
         vertexBuffer.stride = stride;
-        vertexBuffer.bufferSize = buffer.size();
+        vertexBuffer.bufferSize = size;
 
         CHECK_GL(glBindVertexArray(mVAOID));
         CHECK_GL(glGenBuffers(1, (GLuint *)&vertexBuffer.vboID));
         CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer.vboID));
 
-        if (buffer.size()) {
-            CHECK_GL(glBufferData(GL_ARRAY_BUFFER, buffer.size() * sizeof(float), &buffer[0], GL_STATIC_DRAW));
+        if (size) {
+            CHECK_GL(glBufferData(GL_ARRAY_BUFFER, size * sizeof(float), data, GL_STATIC_DRAW));
+            Counters::increment(Counters::BufferBytesUploaded, size * sizeof(float));
         }
         CHECK_GL(glEnableVertexAttribArray(attribArray));
         CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer.vboID));
@@ -79,6 +126,7 @@ namespace neo {
         CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer.vboID));
         if (buffer.size()) {
             CHECK_GL(glBufferData(GL_ARRAY_BUFFER, buffer.size() * sizeof(float), &buffer[0], GL_STATIC_DRAW));
+            Counters::increment(Counters::BufferBytesUploaded, buffer.size() * sizeof(float));
         }
         CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, 0));
         CHECK_GL(glBindVertexArray(0));
@@ -120,17 +168,22 @@ namespace neo {
     }
 
     void Mesh::addElementBuffer(const std::vector<unsigned>& buffer) {
+        addElementBuffer(buffer.data(), unsigned(buffer.size()));
+    }
+
+    void Mesh::addElementBuffer(const unsigned* data, unsigned size) {
         NEO_ASSERT(!mElementVBO.has_value(), "Attempting to add 2 ElementBuffers");
 
         mElementVBO = std::make_optional<VertexBuffer>();
-        mElementVBO->bufferSize = buffer.size();
+        mElementVBO->bufferSize = size;
 
         CHECK_GL(glBindVertexArray(mVAOID));
 
         CHECK_GL(glGenBuffers(1, (GLuint *)&mElementVBO->vboID));
         CHECK_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementVBO->vboID));
-        if (buffer.size()) {
-            CHECK_GL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.size() * sizeof(unsigned), &buffer[0], GL_STATIC_DRAW));
+        if (size) {
+            CHECK_GL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, size * sizeof(unsigned), data, GL_STATIC_DRAW));
+            Counters::increment(Counters::BufferBytesUploaded, size * sizeof(unsigned));
         }
         CHECK_GL(glBindVertexArray(0));
 
@@ -140,13 +193,16 @@ namespace neo {
         MICROPROFILE_SCOPEI("Mesh", "updateElementBuffer", MP_AUTO);
         MICROPROFILE_SCOPEGPUI("Mesh::updateEBO", MP_AUTO);
 
-        NEO_ASSERT(mElementVBO.has_value() && buffer.size(), "Attempting to update an ElementBuffer that doesn't exist");
+        NEO_ASSERT(mElementVBO.has_value(), "Attempting to update an ElementBuffer that doesn't exist");
         mElementVBO->bufferSize = buffer.size();
+        /* New indices, so the old clusters no longer match */
+        mMeshlets.clear();
 
         CHECK_GL(glBindVertexArray(mVAOID));
         CHECK_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementVBO->vboID));
         if (buffer.size()) {
             CHECK_GL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.size() * sizeof(unsigned), &buffer[0], GL_STATIC_DRAW));
+            Counters::increment(Counters::BufferBytesUploaded, buffer.size() * sizeof(unsigned));
         }
         CHECK_GL(glBindVertexArray(0));
     }
@@ -158,6 +214,7 @@ namespace neo {
         NEO_ASSERT(mElementVBO.has_value(), "Attempting to update an ElementBuffer that doesn't exist");
         NEO_ASSERT(size, "Attempting to update an ElementBuffer with no data");
         mElementVBO->bufferSize = size;
+        mMeshlets.clear();
 
         CHECK_GL(glBindVertexArray(mVAOID));
         CHECK_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementVBO->vboID));
@@ -166,6 +223,7 @@ namespace neo {
     }
 
     void Mesh::removeElementBuffer() {
+        mMeshlets.clear();
         if (mElementVBO.has_value()) {
             CHECK_GL(glBindVertexArray(mVAOID));
             CHECK_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementVBO->vboID));
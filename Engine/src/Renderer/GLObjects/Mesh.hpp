@@ -2,6 +2,8 @@
 
 #include "glm/glm.hpp"
 
+#include "Renderer/GLObjects/Meshlet.hpp"
+
 #include <vector>
 #include <unordered_map>
 #include <optional>
@@ -49,11 +51,14 @@ namespace neo {
 
             /* VBOs */
             void addVertexBuffer(VertexType type, unsigned attribArray, unsigned stride, const std::vector<float>& buffer = {});
+            /* Uploads straight from memory someone else owns, like a mapped file */
+            void addVertexBuffer(VertexType type, unsigned attribArray, unsigned stride, const float* data, unsigned size);
             void updateVertexBuffer(VertexType type, const std::vector<float>& buffer);
             void updateVertexBuffer(VertexType type, unsigned size);
             void removeVertexBuffer(VertexType type);
 
             void addElementBuffer(const std::vector<unsigned>& buffer = {});
+            void addElementBuffer(const unsigned* data, unsigned size);
             void updateElementBuffer(const std::vector<unsigned>& buffer);
             void updateElementBuffer(unsigned size);
             void removeElementBuffer();
@@ -65,6 +70,11 @@ namespace neo {
 
             /* Call the appropriate draw function */
             void draw(unsigned = 0) const;
+            /* Draw only the meshlets the camera can see, or everything if there are none */
+            void draw(const glm::mat4 & P, const glm::mat4 & V, const glm::mat4 & M) const;
+
+            /* Clusters over the element buffer, set by whoever built it */
+            std::vector<Meshlet> mMeshlets;
 
             /* Remove */
             void clear();
@@ -73,6 +83,10 @@ namespace neo {
         private:
             std::unordered_map<VertexType, VertexBuffer> mVBOs;
             std::optional<VertexBuffer> mElementVBO;
+
+            /* Culled draw's meshlet lists, kept so their memory is reused */
+            mutable std::vector<unsigned> mFirstIndices, mIndexCounts;
+            mutable std::vector<const void *> mOffsets;
             
     };
 }
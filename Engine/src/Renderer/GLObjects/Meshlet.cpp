@@ -0,0 +1,234 @@
+#include "Meshlet.hpp"
+
+#include "Util/Util.hpp"
+#include "Util/Counters.hpp"
+
+#include "ext/imgui/imgui.h"
+#include "ext/microprofile.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace neo {
+
+    bool Meshlets::mEnabled = true;
+
+    namespace {
+        enum MeshletCounter {
+            Tested,
+            FrustumCulled,
+            BackfaceCulled,
+            NumCounters
+        };
+
+        unsigned _counter(MeshletCounter counter) {
+            static const unsigned counters[NumCounters] = {
+                Counters::add("Meshlets", "Tested"),
+                Counters::add("Meshlets", "Frustum culled"),
+                Counters::add("Meshlets", "Backface culled"),
+            };
+            return counters[counter];
+        }
+
+        /* Cones wider than this are more likely to cost a test than save a draw */
+        const float MinConeCos = 0.1f;
+
+        glm::vec3 _position(const std::vector<float> & positions, unsigned index) {
+            return glm::vec3(positions[index * 3 + 0], positions[index * 3 + 1], positions[index * 3 + 2]);
+        }
+
+        glm::vec4 _normalizePlane(const glm::vec4 & plane) {
+            return plane / glm::length(glm::vec3(plane));
+        }
+    }
+
+    std::vector<Meshlet> Meshlets::build(const std::vector<float> & positions, std::vector<unsigned> & indices) {
+        MICROPROFILE_SCOPEI("Meshlets", "build", MP_AUTO);
+        const unsigned triangleCount = unsigned(indices.size() / 3);
+        const unsigned vertexCount = unsigned(positions.size() / 3);
+        std::vector<Meshlet> meshlets;
+        if (!triangleCount) {
+            return meshlets;
+        }
+
+        /* Triangles around each vertex */
+        std::vector<unsigned> offsets(vertexCount + 1, 0);
+        for (auto index : indices) {
+            NEO_ASSERT(index < vertexCount, "Meshlet index out of range");
+            offsets[index + 1]++;
+        }
+        for (unsigned v = 0; v < vertexCount; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+        std::vector<unsigned> adjacency(indices.size());
+        {
+            std::vector<unsigned> cursor(offsets.begin(), offsets.end() - 1);
+            for (unsigned i = 0; i < indices.size(); i++) {
+                adjacency[cursor[indices[i]]++] = i / 3;
+            }
+        }
+
+        /* Grow each cluster breadth first over shared vertices, starting from the first unclaimed triangle,
+         * so its triangles stay close together and mostly face the same way */
+        std::vector<bool> claimed(triangleCount, false);
+        std::vector<unsigned> order;
+        order.reserve(triangleCount);
+        std::vector<unsigned> frontier;
+        unsigned seed = 0;
+        while (order.size() < triangleCount) {
+            while (claimed[seed]) {
+                seed++;
+            }
+            const unsigned begin = unsigned(order.size());
+            frontier.clear();
+            frontier.push_back(seed);
+            claimed[seed] = true;
+            for (unsigned next = 0; next < frontier.size() && order.size() - begin < MaxTriangles; next++) {
+                const unsigned triangle = frontier[next];
+                order.push_back(triangle);
+                for (int corner = 0; corner < 3; corner++) {
+                    const unsigned vertex = indices[triangle * 3 + corner];
+                    for (unsigned a = offsets[vertex]; a < offsets[vertex + 1]; a++) {
+                        if (!claimed[adjacency[a]]) {
+                            claimed[adjacency[a]] = true;
+                            frontier.push_back(adjacency[a]);
+                        }
+                    }
+                }
+            }
+            /* Whatever the frontier reached past the limit goes back for the next cluster */
+            for (unsigned i = unsigned(order.size() - begin); i < frontier.size(); i++) {
+                claimed[frontier[i]] = false;
+            }
+
+            Meshlet meshlet;
+            meshlet.mFirstIndex = begin * 3;
+            meshlet.mIndexCount = unsigned(order.size() - begin) * 3;
+            meshlets.push_back(meshlet);
+        }
+
+        std::vector<unsigned> reordered(indices.size());
+        for (unsigned i = 0; i < triangleCount; i++) {
+            for (int corner = 0; corner < 3; corner++) {
+                reordered[i * 3 + corner] = indices[order[i] * 3 + corner];
+            }
+        }
+        indices.swap(reordered);
+
+        for (auto & meshlet : meshlets) {
+            glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+            for (unsigned i = meshlet.mFirstIndex; i < meshlet.mFirstIndex + meshlet.mIndexCount; i++) {
+                const glm::vec3 p = _position(positions, indices[i]);
+                min = glm::min(min, p);
+                max = glm::max(max, p);
+            }
+            meshlet.mCenter = (min + max) * 0.5f;
+            float radius2 = 0.f;
+            for (unsigned i = meshlet.mFirstIndex; i < meshlet.mFirstIndex + meshlet.mIndexCount; i++) {
+                const glm::vec3 offset = _position(positions, indices[i]) - meshlet.mCenter;
+                radius2 = std::max(radius2, glm::dot(offset, offset));
+            }
+            meshlet.mRadius = std::sqrt(radius2);
+
+            /* The cone around the face normals. Winding decides facing, so these come from the triangles
+             * themselves rather than the vertex normals */
+            std::vector<glm::vec3> normals;
+            glm::vec3 axis(0.f);
+            for (unsigned i = meshlet.mFirstIndex; i < meshlet.mFirstIndex + meshlet.mIndexCount; i += 3) {
+                const glm::vec3 a = _position(positions, indices[i + 0]);
+                const glm::vec3 normal = glm::cross(_position(positions, indices[i + 1]) - a, _position(positions, indices[i + 2]) - a);
+                const float length = glm::length(normal);
+                if (length > 0.f) {
+                    normals.push_back(normal / length);
+                    axis += normals.back();
+                }
+            }
+            const float axisLength = glm::length(axis);
+            if (normals.empty() || axisLength < 1e-6f) {
+                continue;
+            }
+            meshlet.mConeAxis = axis / axisLength;
+            float coneCos = 1.f;
+            for (auto & normal : normals) {
+                coneCos = std::min(coneCos, glm::dot(normal, meshlet.mConeAxis));
+            }
+            if (coneCos > MinConeCos) {
+                meshlet.mConeCos = coneCos;
+                meshlet.mConeSin = std::sqrt(std::max(0.f, 1.f - coneCos * coneCos));
+            }
+        }
+
+        return meshlets;
+    }
+
+    void Meshlets::cull(const std::vector<Meshlet> & meshlets, const glm::mat4 & PVM, const glm::vec4 & eye, std::vector<unsigned> & firstIndices, std::vector<unsigned> & indexCounts) {
+        MICROPROFILE_SCOPEI("Meshlets", "cull", MP_AUTO);
+        firstIndices.clear();
+        indexCounts.clear();
+
+        /* Frustum planes in object space, so the meshlets' own bounds are tested as they are */
+        const glm::vec4 planes[6] = {
+            _normalizePlane(glm::vec4(PVM[0][3] + PVM[0][0], PVM[1][3] + PVM[1][0], PVM[2][3] + PVM[2][0], PVM[3][3] + PVM[3][0])),
+            _normalizePlane(glm::vec4(PVM[0][3] - PVM[0][0], PVM[1][3] - PVM[1][0], PVM[2][3] - PVM[2][0], PVM[3][3] - PVM[3][0])),
+            _normalizePlane(glm::vec4(PVM[0][3] + PVM[0][1], PVM[1][3] + PVM[1][1], PVM[2][3] + PVM[2][1], PVM[3][3] + PVM[3][1])),
+            _normalizePlane(glm::vec4(PVM[0][3] - PVM[0][1], PVM[1][3] - PVM[1][1], PVM[2][3] - PVM[2][1], PVM[3][3] - PVM[3][1])),
+            _normalizePlane(glm::vec4(PVM[0][3] - PVM[0][2], PVM[1][3] - PVM[1][2], PVM[2][3] - PVM[2][2], PVM[3][3] - PVM[3][2])),
+            _normalizePlane(glm::vec4(PVM[0][2], PVM[1][2], PVM[2][2], PVM[3][2])),
+        };
+        const bool orthographic = eye.w == 0.f;
+        const glm::vec3 eyePosition(eye);
+
+        uint64_t frustumCulled = 0, backfaceCulled = 0;
+        for (auto & meshlet : meshlets) {
+            bool inside = true;
+            for (auto & plane : planes) {
+                if (glm::dot(glm::vec3(plane), meshlet.mCenter) + plane.w < -meshlet.mRadius) {
+                    inside = false;
+                    break;
+                }
+            }
+            if (!inside) {
+                frustumCulled++;
+                continue;
+            }
+
+            /* Every normal in the cone points away from every point of the sphere as seen from the eye. With
+             * the angle between the view direction and the axis as theta, the normal nearest the eye is at
+             * theta + the cone's half angle */
+            if (meshlet.mConeCos > 0.f) {
+                const glm::vec3 view = orthographic ? -eyePosition : meshlet.mCenter - eyePosition;
+                const float distance = glm::length(view);
+                if (distance > 0.f) {
+                    const float cosTheta = glm::dot(view, meshlet.mConeAxis) / distance;
+                    const float sinTheta = std::sqrt(std::max(0.f, 1.f - cosTheta * cosTheta));
+                    const float cosNearest = cosTheta * meshlet.mConeCos - sinTheta * meshlet.mConeSin;
+                    if (cosNearest > 0.f && (orthographic || distance * cosNearest >= meshlet.mRadius)) {
+                        backfaceCulled++;
+                        continue;
+                    }
+                }
+            }
+
+            if (!firstIndices.empty() && firstIndices.back() + indexCounts.back() == meshlet.mFirstIndex) {
+                indexCounts.back() += meshlet.mIndexCount;
+            }
+            else {
+                firstIndices.push_back(meshlet.mFirstIndex);
+                indexCounts.push_back(meshlet.mIndexCount);
+            }
+        }
+
+        Counters::increment(_counter(Tested), meshlets.size());
+        Counters::increment(_counter(FrustumCulled), frustumCulled);
+        Counters::increment(_counter(BackfaceCulled), backfaceCulled);
+    }
+
+    void Meshlets::imguiEditor() {
+        ImGui::Checkbox("Enabled", &mEnabled);
+        ImGui::Text("Tested: %d", int(Counters::getLastFrame(_counter(Tested))));
+        ImGui::Text("Frustum culled: %d", int(Counters::getLastFrame(_counter(FrustumCulled))));
+        ImGui::Text("Backface culled: %d", int(Counters::getLastFrame(_counter(BackfaceCulled))));
+    }
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace neo {
+
+    /* A cluster of nearby triangles, contiguous in its mesh's element buffer. Bounds are in object space. The
+     * normal cone holds every triangle's normal -- within acos(mConeCos) of mConeAxis. Clusters bent too far
+     * for a cone to help have mConeCos <= 0 */
+    struct Meshlet {
+        unsigned mFirstIndex = 0;
+        unsigned mIndexCount = 0;
+        glm::vec3 mCenter = glm::vec3(0.f);
+        float mRadius = 0.f;
+        glm::vec3 mConeAxis = glm::vec3(0.f);
+        float mConeCos = -1.f;
+        float mConeSin = 0.f;
+    };
+
+    /* Splits large meshes into meshlets and culls them per draw. Loader builds them for any indexed triangle
+     * mesh over MinTriangles, and Mesh::draw(P, V, M) skips whole clusters that are outside the frustum or
+     * face entirely away from the camera, then draws what's left as merged index ranges */
+    class Meshlets {
+
+        public:
+            static const unsigned MaxTriangles = 128;
+            static const unsigned MinTriangles = 4 * MaxTriangles;
+
+            static bool mEnabled;
+
+            /* Regroups a triangle list's indices cluster by cluster, growing each one across shared vertices
+             * from the first unclaimed triangle */
+            static std::vector<Meshlet> build(const std::vector<float> & positions, std::vector<unsigned> & indices);
+
+            /* Index ranges of the meshlets that survive, with neighbouring ranges merged. The eye is in object
+             * space -- a point, or with w = 0 the direction back toward an orthographic camera */
+            static void cull(const std::vector<Meshlet> & meshlets, const glm::mat4 & PVM, const glm::vec4 & eye, std::vector<unsigned> & firstIndices, std::vector<unsigned> & indexCounts);
+
+            static void imguiEditor();
+    };
+
+}
@@ -6,6 +6,7 @@
 #include "Renderer/GLObjects/GLHelper.hpp"
 
 #include "Util/Util.hpp"
+#include "Util/Counters.hpp"
 
 namespace neo {
 
@@ -23,6 +24,7 @@ namespace neo {
     }
 
     void Texture::bind() const {
+        Counters::increment(Counters::TextureBinds);
         CHECK_GL(glActiveTexture(GL_TEXTURE0 + mTextureID));
         _bind();
     }
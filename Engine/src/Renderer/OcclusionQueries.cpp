@@ -0,0 +1,273 @@
+#include "OcclusionQueries.hpp"
+
+#include "Engine.hpp"
+#include "ECS/GameObject.hpp"
+#include "ECS/Component/CameraComponent/CameraComponent.hpp"
+#include "ECS/Component/CameraComponent/FrustumComponent.hpp"
+#include "ECS/Component/CameraComponent/MainCameraComponent.hpp"
+#include "ECS/Component/CollisionComponent/BoundingBoxComponent.hpp"
+#include "ECS/Component/SpatialComponent/SpatialComponent.hpp"
+#include "Loader/Library.hpp"
+#include "Renderer/GLObjects/GLHelper.hpp"
+#include "Renderer/Shader/Shader.hpp"
+#include "Spatial/SceneBVH.hpp"
+#include "Spatial/WorldBounds.hpp"
+
+#include "ext/imgui/imgui.h"
+#include "ext/microprofile.h"
+
+#include <algorithm>
+
+namespace neo {
+
+    bool OcclusionQueries::mEnabled = false;
+    int OcclusionQueries::mVisibleInterval = 8;
+    int OcclusionQueries::mBatchSize = 8;
+    std::vector<OcclusionQueries::Node> OcclusionQueries::mNodes;
+    std::vector<OcclusionQueries::Query> OcclusionQueries::mPending;
+    std::vector<unsigned> OcclusionQueries::mPendingSlots;
+    std::vector<unsigned> OcclusionQueries::mFreeQueries;
+    std::unique_ptr<Shader> OcclusionQueries::mBoxShader;
+    unsigned OcclusionQueries::mFrame = 0;
+
+    namespace {
+        enum QueryCounter {
+            QueriesIssued,
+            ObjectsQueried,
+            StallsAvoided,
+            ObjectsCulled,
+            NumCounters
+        };
+
+        unsigned _counter(QueryCounter counter) {
+            static const unsigned counters[NumCounters] = {
+                Counters::add("Occlusion queries", "Queries issued"),
+                Counters::add("Occlusion queries", "Objects queried"),
+                Counters::add("Occlusion queries", "Stalls avoided"),
+                Counters::add("Occlusion queries", "Objects culled"),
+            };
+            return counters[counter];
+        }
+
+        /* Inside the frustum, whether or not anything occludes it */
+        bool _inFrustum(const FrustumComponent & frustum, unsigned id) {
+            return id / 64 >= frustum.mVisibility.size() || ((frustum.mVisibility[id / 64] >> (id % 64)) & 1);
+        }
+    }
+
+    FrustumComponent * OcclusionQueries::_getFrustum() {
+        auto mainCamera = Engine::getComponentTuple<MainCameraComponent, CameraComponent>();
+        return mainCamera ? mainCamera->mGameObject.getComponentByType<FrustumComponent>() : nullptr;
+    }
+
+    void OcclusionQueries::_reset() {
+        for (auto & query : mPending) {
+            mFreeQueries.push_back(query.mQuery);
+        }
+        mPending.clear();
+        mPendingSlots.clear();
+        mNodes.clear();
+    }
+
+    void OcclusionQueries::cull() {
+        MICROPROFILE_SCOPEI("OcclusionQueries", "cull", MP_AUTO);
+        FrustumComponent * frustum = _getFrustum();
+        if (!mEnabled || !frustum) {
+            if (!mPending.empty() || !mNodes.empty()) {
+                _reset();
+            }
+            return;
+        }
+        mFrame++;
+
+        /* Queries finish in the order they were issued, so stop at the first one still running rather than
+         * waiting on it. Everything from there on is left for a later frame */
+        unsigned finished = 0;
+        for (; finished < mPending.size(); finished++) {
+            const Query & query = mPending[finished];
+            GLuint available = 0;
+            CHECK_GL(glGetQueryObjectuiv(query.mQuery, GL_QUERY_RESULT_AVAILABLE, &available));
+            if (!available) {
+                break;
+            }
+            GLuint anySamples = 0;
+            CHECK_GL(glGetQueryObjectuiv(query.mQuery, GL_QUERY_RESULT, &anySamples));
+            for (unsigned i = query.mBegin; i < query.mBegin + query.mCount; i++) {
+                Node & node = mNodes[mPendingSlots[i]];
+                node.mPending = false;
+                node.mVisible = anySamples != 0;
+                /* Something in a visible multiquery is visible -- test each one on its own next time */
+                node.mLastTested = anySamples && query.mCount > 1 ? mFrame - mVisibleInterval : mFrame;
+            }
+            mFreeQueries.push_back(query.mQuery);
+        }
+        Counters::increment(_counter(StallsAvoided), mPending.size() - finished);
+        mPending.erase(mPending.begin(), mPending.begin() + finished);
+        if (!mPending.empty() && mPending.front().mBegin) {
+            const unsigned shift = mPending.front().mBegin;
+            mPendingSlots.erase(mPendingSlots.begin(), mPendingSlots.begin() + shift);
+            for (auto & query : mPending) {
+                query.mBegin -= shift;
+            }
+        }
+        else if (mPending.empty()) {
+            mPendingSlots.clear();
+        }
+
+        /* Reset the state of slots that now hold another object, and hide whatever is still classified hidden */
+        const auto & entries = SceneBVH::mEntries;
+        mNodes.resize(entries.size());
+        uint64_t culled = 0;
+        for (unsigned slot = 0; slot < entries.size(); slot++) {
+            if (!entries[slot].mBox) {
+                continue;
+            }
+            Node & node = mNodes[slot];
+            const unsigned id = entries[slot].mBox->getGameObject().getID();
+            if (node.mID != id) {
+                /* New objects start visible, with their first check spread over the interval */
+                const bool pending = node.mPending;
+                node = Node();
+                node.mID = id;
+                node.mPending = pending;
+                node.mLastTested = mFrame - slot % std::max(mVisibleInterval, 1);
+            }
+            if (node.mVisible || !_inFrustum(*frustum, id)) {
+                continue;
+            }
+            if (id / 64 >= frustum->mOccluded.size()) {
+                frustum->mOccluded.resize(id / 64 + 1, 0);
+            }
+            frustum->mOccluded[id / 64] |= uint64_t(1) << (id % 64);
+            culled++;
+        }
+        Counters::increment(_counter(ObjectsCulled), culled);
+    }
+
+    void OcclusionQueries::_beginQuery(const std::vector<unsigned> & slots) {
+        if (mFreeQueries.empty()) {
+            GLuint query;
+            CHECK_GL(glGenQueries(1, &query));
+            mFreeQueries.push_back(query);
+        }
+        Query query;
+        query.mQuery = mFreeQueries.back();
+        query.mBegin = unsigned(mPendingSlots.size());
+        query.mCount = unsigned(slots.size());
+        mFreeQueries.pop_back();
+
+        const Mesh * cube = Library::getMesh("cube");
+        CHECK_GL(glBeginQuery(GL_ANY_SAMPLES_PASSED, query.mQuery));
+        for (auto slot : slots) {
+            mBoxShader->loadUniform("center", WorldBounds::getCenter(slot));
+            mBoxShader->loadUniform("extent", WorldBounds::getExtent(slot));
+            cube->draw();
+            mNodes[slot].mPending = true;
+            mPendingSlots.push_back(slot);
+        }
+        CHECK_GL(glEndQuery(GL_ANY_SAMPLES_PASSED));
+        mPending.push_back(query);
+
+        Counters::increment(_counter(QueriesIssued));
+        Counters::increment(_counter(ObjectsQueried), slots.size());
+    }
+
+    void OcclusionQueries::issue() {
+        MICROPROFILE_SCOPEI("OcclusionQueries", "issue", MP_AUTO);
+        auto mainCamera = Engine::getComponentTuple<MainCameraComponent, CameraComponent>();
+        FrustumComponent * frustum = _getFrustum();
+        if (!mEnabled || !frustum) {
+            return;
+        }
+
+        if (!mBoxShader) {
+            /* The unit cube stretched over each world AABB */
+            mBoxShader = std::make_unique<Shader>("Occlusion Query Shader",
+                R"(
+                layout (location = 0) in vec3 vertPos;
+                uniform mat4 PV;
+                uniform vec3 center, extent;
+                void main() {
+                    gl_Position = PV * vec4(center + vertPos * 2.0 * extent, 1.0);
+                })",
+                R"(
+                void main() {
+                })"
+            );
+        }
+
+        const auto camera = mainCamera->get<CameraComponent>();
+        const auto cameraSpatial = mainCamera->mGameObject.getComponentByType<SpatialComponent>();
+        const glm::vec3 eye = cameraSpatial ? cameraSpatial->getPosition() : glm::vec3(0.f);
+        const float nearPlane = camera->getNearFar().x;
+
+        /* Boxes only touch the depth test. Both sides, since a box may be cut by the near plane */
+        CHECK_GL(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+        CHECK_GL(glDepthMask(GL_FALSE));
+        CHECK_GL(glDepthFunc(GL_LEQUAL));
+        CHECK_GL(glDisable(GL_CULL_FACE));
+        mBoxShader->bind();
+        mBoxShader->loadUniform("PV", camera->getProj() * camera->getView());
+
+        const auto & entries = SceneBVH::mEntries;
+        std::vector<unsigned> batch;
+        std::vector<unsigned> single(1);
+        for (unsigned slot = 0; slot < std::min(entries.size(), mNodes.size()); slot++) {
+            Node & node = mNodes[slot];
+            if (!entries[slot].mBox || node.mPending || node.mID != entries[slot].mBox->getGameObject().getID() || !_inFrustum(*frustum, node.mID)) {
+                continue;
+            }
+
+            /* The eye inside a box would see none of its faces */
+            const glm::vec3 offset = glm::abs(eye - WorldBounds::getCenter(slot));
+            if (glm::all(glm::lessThanEqual(offset, WorldBounds::getExtent(slot) + nearPlane))) {
+                node.mVisible = true;
+                node.mLastTested = mFrame;
+                continue;
+            }
+
+            if (!node.mVisible) {
+                batch.push_back(slot);
+                if (int(batch.size()) >= std::max(mBatchSize, 1)) {
+                    _beginQuery(batch);
+                    batch.clear();
+                }
+            }
+            else if (int(mFrame - node.mLastTested) >= mVisibleInterval) {
+                single[0] = slot;
+                _beginQuery(single);
+            }
+        }
+        if (!batch.empty()) {
+            _beginQuery(batch);
+        }
+
+        mBoxShader->unbind();
+        CHECK_GL(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+        CHECK_GL(glDepthMask(GL_TRUE));
+        CHECK_GL(glDepthFunc(GL_LESS));
+        CHECK_GL(glEnable(GL_CULL_FACE));
+    }
+
+    void OcclusionQueries::shutDown() {
+        _reset();
+        if (!mFreeQueries.empty()) {
+            CHECK_GL(glDeleteQueries(GLsizei(mFreeQueries.size()), mFreeQueries.data()));
+            mFreeQueries.clear();
+        }
+        if (mBoxShader) {
+            mBoxShader->cleanUp();
+            mBoxShader.reset();
+        }
+    }
+
+    void OcclusionQueries::imguiEditor() {
+        ImGui::Checkbox("Enabled", &mEnabled);
+        ImGui::SliderInt("Visible interval", &mVisibleInterval, 1, 32);
+        ImGui::SliderInt("Batch size", &mBatchSize, 1, 32);
+        ImGui::Text("Queries issued: %d (%d objects)", int(Counters::getLastFrame(_counter(QueriesIssued))), int(Counters::getLastFrame(_counter(ObjectsQueried))));
+        ImGui::Text("Stalls avoided: %d", int(Counters::getLastFrame(_counter(StallsAvoided))));
+        ImGui::Text("Culled: %d", int(Counters::getLastFrame(_counter(ObjectsCulled))));
+    }
+
+}
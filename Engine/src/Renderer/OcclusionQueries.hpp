@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace neo {
+
+    class Shader;
+    class FrustumComponent;
+
+    /* Hardware occlusion queries for the main camera, in the spirit of CHC++. Visibility is kept per SceneBVH
+     * slot across frames. After the scene shaders fill the depth buffer, objects hidden last time are queried
+     * with their world bounding boxes, several at a time in one multiquery, and visible ones are re-checked
+     * every few frames one at a time. Results are only read when they're already available -- usually a frame
+     * later -- so the CPU never waits on the GPU, and an object keeps its last classification until its
+     * answer comes back. Hidden objects are marked in the camera FrustumComponent's mOccluded bits. Disabled
+     * by default; works alongside OcclusionCulling and on software GL */
+    class OcclusionQueries {
+
+        public:
+            /* Reads finished queries and marks hidden objects. Run after OcclusionCulling */
+            static void cull();
+            /* Issues this frame's queries against the scene's depth buffer. Run by the Renderer after the scene
+             * shaders, with their framebuffer still bound */
+            static void issue();
+
+            static void shutDown();
+            static void imguiEditor();
+
+            static bool mEnabled;
+            /* Frames a visible object goes between re-checks */
+            static int mVisibleInterval;
+            /* Hidden objects sharing one query */
+            static int mBatchSize;
+
+        private:
+            struct Node {
+                /* GameObject this slot's state belongs to, or 0 */
+                unsigned mID = 0;
+                bool mVisible = true;
+                bool mPending = false;
+                unsigned mLastTested = 0;
+            };
+
+            /* A query in flight and the slots it covers, in mPendingSlots */
+            struct Query {
+                unsigned mQuery;
+                unsigned mBegin, mCount;
+            };
+
+            static std::vector<Node> mNodes;
+            static std::vector<Query> mPending;
+            static std::vector<unsigned> mPendingSlots;
+            static std::vector<unsigned> mFreeQueries;
+            static std::unique_ptr<Shader> mBoxShader;
+            static unsigned mFrame;
+
+            static FrustumComponent * _getFrustum();
+            static void _reset();
+            static void _beginQuery(const std::vector<unsigned> & slots);
+    };
+
+}
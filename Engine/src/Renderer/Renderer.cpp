@@ -1,5 +1,6 @@
 #include "Renderer.hpp"
 #include "Renderer/GLObjects/GLHelper.hpp"
+#include "Renderer/OcclusionQueries.hpp"
 
 #include "Engine.hpp"
 #include "Window/Window.hpp"
@@ -35,6 +36,7 @@ namespace neo {
     std::vector<std::pair<std::type_index, std::unique_ptr<Shader>>> Renderer::mSceneShaders;
     std::vector<std::pair<std::type_index, std::unique_ptr<Shader>>> Renderer::mPostShaders;
     glm::vec3 Renderer::mClearColor;
+    std::vector<Subscription> Renderer::mFrameSizeReceivers;
 
     void Renderer::init(const std::string &dir, glm::vec3 clearColor) {
         APP_SHADER_DIR = dir;
@@ -45,10 +47,9 @@ namespace neo {
 
         /* Init GL window */
         CHECK_GL(glViewport(0, 0, Window::getFrameSize().x, Window::getFrameSize().y));
-        Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const Message &msg) {
-            const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-            CHECK_GL(glViewport(0, 0, m.frameSize.x, m.frameSize.y));
-        });
+        mFrameSizeReceivers.push_back(Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const WindowFrameSizeMessage &msg) {
+            CHECK_GL(glViewport(0, 0, msg.frameSize.x, msg.frameSize.y));
+        }));
 
         /* Set max work gruop */
         CHECK_GL(glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 0, &NEO_MAX_COMPUTE_GROUP_SIZE.x));
@@ -57,6 +58,7 @@ namespace neo {
     }
 
     void Renderer::shutDown() {
+        OcclusionQueries::shutDown();
         for (auto& shader : mComputeShaders) {
             shader.second->cleanUp();
         }
@@ -69,6 +71,7 @@ namespace neo {
         for (auto& shader : mPostShaders) {
             shader.second->cleanUp();
         }
+        mFrameSizeReceivers.clear();
     }
 
     void Renderer::resetState() {
@@ -161,6 +164,21 @@ namespace neo {
         }
         RENDERER_MP_LEAVE();
 
+        /* Query against the depth the scene left behind, in the same framebuffer */
+        if (OcclusionQueries::mEnabled) {
+            RENDERER_MP_ENTER("OcclusionQueries");
+            resetState();
+            if (activePostShaders.size()) {
+                mDefaultFBO->bind();
+            }
+            else if (activePreShaders.size()) {
+                Library::getFBO("0")->bind();
+            }
+            CHECK_GL(glViewport(0, 0, frameSize.x, frameSize.y));
+            OcclusionQueries::issue();
+            RENDERER_MP_LEAVE();
+        }
+
         /* Post process with ping & pong */
         if (activePostShaders.size()) {
             RENDERER_MP_ENTER("PostProcess shaders");
@@ -44,6 +44,8 @@ namespace neo {
         private:
             static Framebuffer* mDefaultFBO;
             static glm::vec3 mClearColor;
+            /* Viewport and ping/pong resizing */
+            static std::vector<Subscription> mFrameSizeReceivers;
 
             static std::vector<std::pair<std::type_index, std::unique_ptr<Shader>>> mComputeShaders;
             static std::vector<std::pair<std::type_index, std::unique_ptr<Shader>>> mPreProcessShaders;
@@ -115,11 +117,10 @@ namespace neo {
             pong->attachColorTexture(Window::getFrameSize(), format);
             pong->mTextures.push_back(ping->mTextures[1]);
 
-            Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const Message &msg) {
-                const WindowFrameSizeMessage & m(static_cast<const WindowFrameSizeMessage &>(msg));
-                Library::getFBO("ping")->resize(m.frameSize);
-                Library::getFBO("pong")->resize(m.frameSize);
-            });
+            mFrameSizeReceivers.push_back(Messenger::addReceiver<WindowFrameSizeMessage>(nullptr, [&](const WindowFrameSizeMessage &msg) {
+                Library::getFBO("ping")->resize(msg.frameSize);
+                Library::getFBO("pong")->resize(msg.frameSize);
+            }));
         }
 
         std::type_index typeI(typeid(ShaderT));
@@ -46,14 +46,8 @@ namespace neo {
                 auto renderableSpatial = renderable->get<SpatialComponent>();
 
                 // VFC
-                if (cameraFrustum) {
-                    MICROPROFILE_SCOPEI("OutlineShader", "VFC", MP_AUTO);
-                    if (const auto& boundingBox = renderable->mGameObject.getComponentByType<BoundingBoxComponent>()) {
-                        float radius = glm::max(glm::max(renderableSpatial->getScale().x, renderableSpatial->getScale().y), renderableSpatial->getScale().z) * boundingBox->getRadius();
-                        if (!cameraFrustum->isInFrustum(renderableSpatial->getPosition(), radius)) {
-                            continue;
-                        }
-                    }
+                if (cameraFrustum && !cameraFrustum->isVisible(renderable->mGameObject)) {
+                    continue;
                 }
 
                 glm::mat4 M = renderableSpatial->getModelMatrix() * glm::scale(glm::mat4(1.f), glm::vec3(1.f + renderableOutline->mScale));
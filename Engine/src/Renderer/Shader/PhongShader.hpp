@@ -80,17 +80,12 @@ namespace neo {
                 auto renderableSpatial = renderableIt->get<SpatialComponent>();
 
                 // VFC
-                if (cameraFrustum) {
-                    MICROPROFILE_SCOPEI("PhongShader", "VFC", MP_AUTO);
-                    if (const auto& boundingBox = renderableIt->mGameObject.getComponentByType<BoundingBoxComponent>()) {
-                        float radius = glm::max(glm::max(renderableSpatial->getScale().x, renderableSpatial->getScale().y), renderableSpatial->getScale().z) * boundingBox->getRadius();
-                        if (!cameraFrustum->isInFrustum(renderableSpatial->getPosition(), radius)) {
-                            continue;
-                        }
-                    }
+                if (cameraFrustum && !cameraFrustum->isVisible(renderableIt->mGameObject)) {
+                    continue;
                 }
 
-                loadUniform("M", renderableSpatial->getModelMatrix());
+                const glm::mat4 M = renderableSpatial->getModelMatrix();
+                loadUniform("M", M);
                 loadUniform("N", renderableSpatial->getNormalMatrix());
 
                 /* Bind texture */
@@ -105,7 +100,7 @@ namespace neo {
                 loadUniform("shine", material.mShininess);
 
                 /* DRAW */
-                renderableIt->get<MeshComponent>()->mMesh.draw();
+                renderableIt->get<MeshComponent>()->mMesh.draw(camera->get<CameraComponent>()->getProj(), camera->get<CameraComponent>()->getView(), M);
             }
         }
     };
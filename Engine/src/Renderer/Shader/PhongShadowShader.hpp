@@ -25,12 +25,14 @@ namespace neo {
                     out vec3 fragNor;
                     out vec2 fragTex;
                     out vec4 shadowCoord;
+                    out float fragViewDepth;
                     void main() {
                         fragPos = M * vec4(vertPos, 1.0);
                         fragNor = N * vertNor;
                         gl_Position = P * V * fragPos;
                         fragTex = vertTex;
                         shadowCoord = L * fragPos; 
+                        fragViewDepth = -(V * fragPos).z;
                     })", 
                     R"(
                     #include "phong.glsl"
@@ -41,6 +43,7 @@ namespace neo {
                     in vec3 fragNor;
                     in vec2 fragTex;
                     in vec4 shadowCoord;
+                    in float fragViewDepth;
                     uniform vec3 ambientColor;
                     uniform vec3 diffuseColor;
                     uniform vec3 specularColor;
@@ -51,13 +54,26 @@ namespace neo {
                     uniform sampler2D shadowMap;
                     uniform float bias;
                     uniform int pcfSize;
+                    uniform int numCascades;
+                    uniform mat4 cascadeL0, cascadeL1, cascadeL2, cascadeL3;
+                    uniform vec4 cascadeSplits;
                     out vec4 color;
                     void main() {
                         vec4 albedo = texture(diffuseMap, fragTex);
                         alphaDiscard(albedo.a);
                         albedo.rgb += diffuseColor;
 
-                        float visibility = getShadowVisibility(pcfSize, shadowMap, shadowCoord, bias);
+                        float visibility = 1.0;
+                        if (numCascades == 0) {
+                            visibility = getShadowVisibility(pcfSize, shadowMap, shadowCoord, bias);
+                        }
+                        else {
+                            int cascade = getShadowCascade(fragViewDepth, cascadeSplits, numCascades);
+                            if (cascade >= 0) {
+                                mat4 cascadeL = cascade == 0 ? cascadeL0 : cascade == 1 ? cascadeL1 : cascade == 2 ? cascadeL2 : cascadeL3;
+                                visibility = getShadowVisibility(pcfSize, shadowMap, cascadeL * fragPos, bias);
+                            }
+                        }
                         vec3 phong = getPhong(fragNor, fragPos.rgb, camPos, lightPos, lightAtt, lightCol, albedo.rgb, specularColor, shine);
                         color.rgb = albedo.rgb * ambientColor + 
                                     visibility * phong;
@@ -87,10 +103,29 @@ namespace neo {
                 loadUniform("camPos", camera->get<SpatialComponent>()->getPosition());
 
                 /* Load light */
+                int numCascades = 0;
                 if (auto shadowCamera = Engine::getComponentTuple<ShadowCameraComponent, CameraComponent>()) {
                     auto camera = shadowCamera->get<CameraComponent>();
                     loadUniform("L", biasMatrix * camera->getProj() * camera->getView());
+
+                    /* Each cascade maps into its tile of the shadow map */
+                    if (auto cascaded = camera->getGameObject().getComponentByType<CascadedShadowComponent>()) {
+                        const auto & depthTexture = Library::getFBO("shadowMap")->mTextures[0];
+                        const glm::vec2 mapSize(depthTexture->mWidth, depthTexture->mHeight);
+                        const glm::vec2 tileScale = glm::vec2(float(cascaded->mResolution)) / mapSize;
+                        glm::vec4 splits(0.f);
+                        numCascades = cascaded->mNumCascades;
+                        for (int i = 0; i < numCascades; i++) {
+                            const auto & cascade = cascaded->mCascades[i];
+                            const glm::vec2 tileOffset = glm::vec2(cascaded->getTileOffset(i)) / mapSize;
+                            const glm::mat4 tile = glm::scale(glm::translate(glm::mat4(1.f), glm::vec3(tileOffset, 0.f)), glm::vec3(tileScale, 1.f));
+                            loadUniform("cascadeL" + std::to_string(i), tile * biasMatrix * cascade.mProj * cascade.mView);
+                            splits[i] = cascade.mSplit;
+                        }
+                        loadUniform("cascadeSplits", splits);
+                    }
                 }
+                loadUniform("numCascades", numCascades);
 
                 if (auto light = Engine::getComponentTuple<LightComponent, SpatialComponent>()) {
                     loadUniform("lightPos", light->get<SpatialComponent>()->getPosition());
@@ -113,17 +148,12 @@ namespace neo {
                     auto renderableSpatial = renderableIt->get<SpatialComponent>();
 
                     // VFC
-                    if (cameraFrustum) {
-                        MICROPROFILE_SCOPEI("PhongShaderShader", "VFC", MP_AUTO);
-                        if (const auto& boundingBox = renderableIt->mGameObject.getComponentByType<BoundingBoxComponent>()) {
-                            float radius = glm::max(glm::max(renderableSpatial->getScale().x, renderableSpatial->getScale().y), renderableSpatial->getScale().z) * boundingBox->getRadius();
-                            if (!cameraFrustum->isInFrustum(renderableSpatial->getPosition(), radius)) {
-                                continue;
-                            }
-                        }
+                    if (cameraFrustum && !cameraFrustum->isVisible(renderableIt->mGameObject)) {
+                        continue;
                     }
 
-                    loadUniform("M", renderableSpatial->getModelMatrix());
+                    const glm::mat4 M = renderableSpatial->getModelMatrix();
+                    loadUniform("M", M);
                     loadUniform("N", renderableSpatial->getNormalMatrix());
 
                     /* Bind texture */
@@ -136,7 +166,7 @@ namespace neo {
                     loadUniform("shine", renderable->mMaterial.mShininess);
 
                     /* DRAW */
-                    renderableIt->get<MeshComponent>()->mMesh.draw();
+                    renderableIt->get<MeshComponent>()->mMesh.draw(camera->get<CameraComponent>()->getProj(), camera->get<CameraComponent>()->getView(), M);
                 }
 
                 unbind();
@@ -1,5 +1,6 @@
 #include "Renderer/Shader/Shader.hpp"
 #include "Util/Util.hpp"
+#include "Util/Counters.hpp"
 #include "Renderer/GLObjects/Texture.hpp"
 #include "Renderer/GLObjects/GLHelper.hpp"
 
@@ -296,47 +297,58 @@ namespace neo {
     }
 
     void Shader::loadUniform(const std::string &loc, const bool b) const {
+        Counters::increment(Counters::UniformUploads);
         CHECK_GL(glUniform1i(getUniform(loc), b));
     }
 
     void Shader::loadUniform(const std::string &loc, const int i) const {
+        Counters::increment(Counters::UniformUploads);
         CHECK_GL(glUniform1i(getUniform(loc), i));
     }
 
     void Shader::loadUniform(const std::string &loc, const double d) const {
+        Counters::increment(Counters::UniformUploads);
         CHECK_GL(glUniform1f(getUniform(loc), static_cast<float>(d)));
     }
 
     void Shader::loadUniform(const std::string &loc, const float f) const {
+        Counters::increment(Counters::UniformUploads);
         CHECK_GL(glUniform1f(getUniform(loc), f));
     }
 
     void Shader::loadUniform(const std::string &loc, const glm::vec2 & v) const {
+        Counters::increment(Counters::UniformUploads);
         CHECK_GL(glUniform2f(getUniform(loc), v.x, v.y));
     }
 
     void Shader::loadUniform(const std::string &loc, const glm::ivec2 & v) const {
+        Counters::increment(Counters::UniformUploads);
         CHECK_GL(glUniform2i(getUniform(loc), v.x, v.y));
     }
 
     void Shader::loadUniform(const std::string &loc, const glm::vec3 & v) const {
+        Counters::increment(Counters::UniformUploads);
         CHECK_GL(glUniform3f(getUniform(loc), v.x, v.y, v.z));
     }
 
     void Shader::loadUniform(const std::string &loc, const glm::vec4 & v) const {
+        Counters::increment(Counters::UniformUploads);
         CHECK_GL(glUniform4f(getUniform(loc), v.r, v.g, v.b, v.a));
     }
 
     void Shader::loadUniform(const std::string &loc, const glm::mat3 & m) const {
+        Counters::increment(Counters::UniformUploads);
         CHECK_GL(glUniformMatrix3fv(getUniform(loc), 1, GL_FALSE, glm::value_ptr(m)));
     }
 
     void Shader::loadUniform(const std::string &loc, const glm::mat4 & m) const {
+        Counters::increment(Counters::UniformUploads);
         CHECK_GL(glUniformMatrix4fv(getUniform(loc), 1, GL_FALSE, glm::value_ptr(m)));
     }
 
     void Shader::loadTexture(const std::string &loc, const Texture & texture) const {
         texture.bind();
+        Counters::increment(Counters::UniformUploads);
         CHECK_GL(glUniform1i(getUniform(loc), texture.mTextureID));
     }
 
@@ -52,27 +52,39 @@ namespace neo {
 
                 fbo->bind();
                 CHECK_GL(glClear(GL_DEPTH_BUFFER_BIT));
-                CHECK_GL(glViewport(0, 0, depthTexture->mWidth, depthTexture->mHeight));
 
                 bind();
-                loadUniform("P", camera->getProj());
-                loadUniform("V", camera->getView());
 
-                const auto& cameraFrustum = camera->getGameObject().getComponentByType<FrustumComponent>();
+                /* Each cascade draws into its own tile with the casters culled against it */
+                if (auto cascaded = camera->getGameObject().getComponentByType<CascadedShadowComponent>()) {
+                    NEO_ASSERT(glm::all(glm::lessThanEqual(cascaded->getGrid() * cascaded->mResolution, glm::ivec2(depthTexture->mWidth, depthTexture->mHeight))), "Shadow map is too small for its cascades");
+                    for (int i = 0; i < cascaded->mNumCascades; i++) {
+                        const auto & cascade = cascaded->mCascades[i];
+                        const glm::ivec2 offset = cascaded->getTileOffset(i);
+                        CHECK_GL(glViewport(offset.x, offset.y, cascaded->mResolution, cascaded->mResolution));
+                        _renderCasters(cascade.mProj, cascade.mView, &cascade.mFrustum);
+                    }
+                }
+                else {
+                    CHECK_GL(glViewport(0, 0, depthTexture->mWidth, depthTexture->mHeight));
+                    _renderCasters(camera->getProj(), camera->getView(), camera->getGameObject().getComponentByType<FrustumComponent>());
+                }
+
+                unbind();
+            }
+
+        private:
+            void _renderCasters(const glm::mat4 & P, const glm::mat4 & V, const FrustumComponent * cameraFrustum) {
+                loadUniform("P", P);
+                loadUniform("V", V);
 
                 for (auto& renderableIt : Engine::getComponentTuples<renderable::ShadowCasterRenderable, MeshComponent, SpatialComponent>()) {
                     auto renderable = renderableIt->get<renderable::ShadowCasterRenderable>();
                     auto renderableSpatial = renderableIt->get<SpatialComponent>();
 
                     // VFC
-                    if (cameraFrustum) {
-                        MICROPROFILE_SCOPEI("ShadowCasterShader", "VFC", MP_AUTO);
-                        if (const auto& boundingBox = renderableIt->mGameObject.getComponentByType<BoundingBoxComponent>()) {
-                            float radius = glm::max(glm::max(renderableSpatial->getScale().x, renderableSpatial->getScale().y), renderableSpatial->getScale().z);
-                            if (!cameraFrustum->isInFrustum(renderableSpatial->getPosition(), radius)) {
-                                continue;
-                            }
-                        }
+                    if (cameraFrustum && !cameraFrustum->isVisible(renderableIt->mGameObject)) {
+                        continue;
                     }
 
                     loadUniform("M", renderableSpatial->getModelMatrix());
@@ -83,9 +95,6 @@ namespace neo {
                     /* DRAW */
                     renderableIt->get<MeshComponent>()->mMesh.draw();
                 }
-
-
-                unbind();
             }
         };
 
@@ -0,0 +1,328 @@
+#include "BVH.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <cfloat>
+
+namespace neo {
+
+    namespace {
+        const int NumBins = 12;
+
+        float _area(const glm::vec3 & min, const glm::vec3 & max) {
+            const glm::vec3 d = glm::max(max - min, glm::vec3(0.f));
+            return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        bool _overlaps(const glm::vec3 & aMin, const glm::vec3 & aMax, const glm::vec3 & bMin, const glm::vec3 & bMax) {
+            return aMin.x <= bMax.x && aMax.x >= bMin.x &&
+                   aMin.y <= bMax.y && aMax.y >= bMin.y &&
+                   aMin.z <= bMax.z && aMax.z >= bMin.z;
+        }
+
+        const unsigned AllPlanes = 0x3F;
+    }
+
+    float BVH::intersectRay(const glm::vec3 & min, const glm::vec3 & max, const glm::vec3 & origin, const glm::vec3 & invDir, float maxDist) {
+        const glm::vec3 t1 = (min - origin) * invDir;
+        const glm::vec3 t2 = (max - origin) * invDir;
+        const glm::vec3 tNear = glm::min(t1, t2);
+        const glm::vec3 tFar = glm::max(t1, t2);
+        const float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.f));
+        const float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDist));
+        return enter <= exit ? enter : -1.f;
+    }
+
+    bool BVH::outsideFrustum(const glm::vec3 & min, const glm::vec3 & max, const glm::vec4 planes[6], unsigned & mask, unsigned & planeTests) {
+        for (int p = 0; p < 6; p++) {
+            if (!(mask & (1u << p))) {
+                continue;
+            }
+            planeTests++;
+            const glm::vec3 n(planes[p]);
+            const glm::vec3 far(n.x >= 0.f ? max.x : min.x, n.y >= 0.f ? max.y : min.y, n.z >= 0.f ? max.z : min.z);
+            const glm::vec3 near(n.x >= 0.f ? min.x : max.x, n.y >= 0.f ? min.y : max.y, n.z >= 0.f ? min.z : max.z);
+            if (glm::dot(n, far) + planes[p].w < 0.f) {
+                return true;
+            }
+            if (glm::dot(n, near) + planes[p].w >= 0.f) {
+                mask &= ~(1u << p);
+            }
+        }
+        return false;
+    }
+
+    void BVH::build(const std::vector<glm::vec3> & mins, const std::vector<glm::vec3> & maxs) {
+        const unsigned count = unsigned(mins.size());
+        mNodes.clear();
+        mIndices.resize(count);
+        std::iota(mIndices.begin(), mIndices.end(), 0u);
+        if (!count) {
+            return;
+        }
+
+        mCentroids.resize(count);
+        Node root = { glm::vec3(FLT_MAX), 0, glm::vec3(-FLT_MAX), count };
+        for (unsigned i = 0; i < count; i++) {
+            mCentroids[i] = (mins[i] + maxs[i]) * 0.5f;
+            root.mMin = glm::min(root.mMin, mins[i]);
+            root.mMax = glm::max(root.mMax, maxs[i]);
+        }
+
+        /* A binary tree never has more than 2n - 1 nodes, so references into mNodes stay valid while splitting */
+        mNodes.reserve(2 * count - 1);
+        mNodes.push_back(root);
+        _split(0, mins, maxs);
+        _gatherItems(mins, maxs);
+    }
+
+    void BVH::_split(unsigned nodeIndex, const std::vector<glm::vec3> & mins, const std::vector<glm::vec3> & maxs) {
+        Node & node = mNodes[nodeIndex];
+        if (node.mCount <= MaxLeafSize) {
+            return;
+        }
+
+        const auto first = mIndices.begin() + node.mFirst;
+        const auto last = first + node.mCount;
+
+        glm::vec3 cMin(FLT_MAX), cMax(-FLT_MAX);
+        for (auto it = first; it != last; ++it) {
+            cMin = glm::min(cMin, mCentroids[*it]);
+            cMax = glm::max(cMax, mCentroids[*it]);
+        }
+
+        /* Pick the bin boundary with the lowest surface area cost over all three axes */
+        int bestAxis = -1;
+        int bestBin = 0;
+        float bestCost = FLT_MAX;
+        for (int axis = 0; axis < 3; axis++) {
+            const float extent = cMax[axis] - cMin[axis];
+            if (extent <= 0.f) {
+                continue;
+            }
+
+            struct Bin {
+                glm::vec3 mMin = glm::vec3(FLT_MAX);
+                glm::vec3 mMax = glm::vec3(-FLT_MAX);
+                unsigned mCount = 0;
+            } bins[NumBins];
+            const float scale = NumBins / extent;
+            for (auto it = first; it != last; ++it) {
+                const int b = std::min(NumBins - 1, int((mCentroids[*it][axis] - cMin[axis]) * scale));
+                bins[b].mMin = glm::min(bins[b].mMin, mins[*it]);
+                bins[b].mMax = glm::max(bins[b].mMax, maxs[*it]);
+                bins[b].mCount++;
+            }
+
+            /* Sweep from the right to get the cost of everything after each boundary */
+            float rightCost[NumBins];
+            Bin right;
+            for (int b = NumBins - 1; b > 0; b--) {
+                right.mMin = glm::min(right.mMin, bins[b].mMin);
+                right.mMax = glm::max(right.mMax, bins[b].mMax);
+                right.mCount += bins[b].mCount;
+                rightCost[b] = right.mCount ? _area(right.mMin, right.mMax) * right.mCount : 0.f;
+            }
+            Bin left;
+            for (int b = 0; b < NumBins - 1; b++) {
+                left.mMin = glm::min(left.mMin, bins[b].mMin);
+                left.mMax = glm::max(left.mMax, bins[b].mMax);
+                left.mCount += bins[b].mCount;
+                if (!left.mCount || left.mCount == node.mCount) {
+                    continue;
+                }
+                const float cost = _area(left.mMin, left.mMax) * left.mCount + rightCost[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                }
+            }
+        }
+
+        /* Every centroid is in the same spot -- no split can separate them */
+        if (bestAxis < 0) {
+            return;
+        }
+
+        const float scale = NumBins / (cMax[bestAxis] - cMin[bestAxis]);
+        const auto mid = std::partition(first, last, [&](unsigned i) {
+            return std::min(NumBins - 1, int((mCentroids[i][bestAxis] - cMin[bestAxis]) * scale)) <= bestBin;
+        });
+
+        const unsigned leftIndex = unsigned(mNodes.size());
+        Node children[2] = {
+            { glm::vec3(FLT_MAX), node.mFirst, glm::vec3(-FLT_MAX), unsigned(mid - first) },
+            { glm::vec3(FLT_MAX), node.mFirst + unsigned(mid - first), glm::vec3(-FLT_MAX), unsigned(last - mid) },
+        };
+        for (auto & child : children) {
+            for (unsigned i = child.mFirst; i < child.mFirst + child.mCount; i++) {
+                child.mMin = glm::min(child.mMin, mins[mIndices[i]]);
+                child.mMax = glm::max(child.mMax, maxs[mIndices[i]]);
+            }
+            mNodes.push_back(child);
+        }
+        node.mFirst = leftIndex;
+        node.mCount = 0;
+
+        _split(leftIndex, mins, maxs);
+        _split(leftIndex + 1, mins, maxs);
+    }
+
+    void BVH::refit(const std::vector<glm::vec3> & mins, const std::vector<glm::vec3> & maxs) {
+        _gatherItems(mins, maxs);
+
+        /* Children are always stored after their parent */
+        for (int n = int(mNodes.size()) - 1; n >= 0; n--) {
+            Node & node = mNodes[n];
+            if (node.mCount) {
+                node.mMin = glm::vec3(FLT_MAX);
+                node.mMax = glm::vec3(-FLT_MAX);
+                for (unsigned i = node.mFirst; i < node.mFirst + node.mCount; i++) {
+                    node.mMin = glm::min(node.mMin, mItemMins[i]);
+                    node.mMax = glm::max(node.mMax, mItemMaxs[i]);
+                }
+            }
+            else {
+                node.mMin = glm::min(mNodes[node.mFirst].mMin, mNodes[node.mFirst + 1].mMin);
+                node.mMax = glm::max(mNodes[node.mFirst].mMax, mNodes[node.mFirst + 1].mMax);
+            }
+        }
+    }
+
+    float BVH::getCost() const {
+        if (mNodes.empty()) {
+            return 0.f;
+        }
+
+        float cost = 0.f;
+        for (auto & node : mNodes) {
+            cost += _area(node.mMin, node.mMax) * (node.mCount ? node.mCount : 1);
+        }
+        const float rootArea = _area(mNodes[0].mMin, mNodes[0].mMax);
+        return rootArea > 0.f ? cost / rootArea : 0.f;
+    }
+
+    void BVH::_gatherItems(const std::vector<glm::vec3> & mins, const std::vector<glm::vec3> & maxs) {
+        mItemMins.resize(mIndices.size());
+        mItemMaxs.resize(mIndices.size());
+        for (unsigned i = 0; i < mIndices.size(); i++) {
+            mItemMins[i] = mins[mIndices[i]];
+            mItemMaxs[i] = maxs[mIndices[i]];
+        }
+    }
+
+    void BVH::_appendSubtree(unsigned node, std::vector<unsigned> & out) const {
+        /* Leaves are contiguous in mIndices, so a subtree is the range from its leftmost to rightmost leaf */
+        unsigned lo = node, hi = node;
+        while (!mNodes[lo].mCount) {
+            lo = mNodes[lo].mFirst;
+        }
+        while (!mNodes[hi].mCount) {
+            hi = mNodes[hi].mFirst + 1;
+        }
+        out.insert(out.end(), mIndices.begin() + mNodes[lo].mFirst, mIndices.begin() + mNodes[hi].mFirst + mNodes[hi].mCount);
+    }
+
+    void BVH::queryFrustum(const glm::vec4 planes[6], std::vector<unsigned> & out) const {
+        mNodesVisited = 0;
+        mPlaneTests = 0;
+        if (mNodes.empty()) {
+            return;
+        }
+
+        /* Each stacked node carries the planes its parent wasn't already inside */
+        mStack.assign(1, 0);
+        mMaskStack.assign(1, AllPlanes);
+        while (mStack.size()) {
+            const unsigned n = mStack.back();
+            unsigned mask = mMaskStack.back();
+            mStack.pop_back();
+            mMaskStack.pop_back();
+            const Node & node = mNodes[n];
+            mNodesVisited++;
+
+            if (outsideFrustum(node.mMin, node.mMax, planes, mask, mPlaneTests)) {
+                continue;
+            }
+
+            if (!mask) {
+                _appendSubtree(n, out);
+            }
+            else if (node.mCount) {
+                for (unsigned i = node.mFirst; i < node.mFirst + node.mCount; i++) {
+                    unsigned itemMask = mask;
+                    if (!outsideFrustum(mItemMins[i], mItemMaxs[i], planes, itemMask, mPlaneTests)) {
+                        out.push_back(mIndices[i]);
+                    }
+                }
+            }
+            else {
+                mStack.push_back(node.mFirst);
+                mStack.push_back(node.mFirst + 1);
+                mMaskStack.push_back(mask);
+                mMaskStack.push_back(mask);
+            }
+        }
+    }
+
+    void BVH::queryRay(const glm::vec3 & origin, const glm::vec3 & dir, float maxDist, std::vector<std::pair<unsigned, float>> & out) const {
+        mNodesVisited = 0;
+        if (mNodes.empty()) {
+            return;
+        }
+
+        const glm::vec3 invDir = 1.f / dir;
+        mStack.assign(1, 0);
+        while (mStack.size()) {
+            const Node & node = mNodes[mStack.back()];
+            mStack.pop_back();
+            mNodesVisited++;
+            if (intersectRay(node.mMin, node.mMax, origin, invDir, maxDist) < 0.f) {
+                continue;
+            }
+
+            if (node.mCount) {
+                for (unsigned i = node.mFirst; i < node.mFirst + node.mCount; i++) {
+                    const float t = intersectRay(mItemMins[i], mItemMaxs[i], origin, invDir, maxDist);
+                    if (t >= 0.f) {
+                        out.emplace_back(mIndices[i], t);
+                    }
+                }
+            }
+            else {
+                mStack.push_back(node.mFirst);
+                mStack.push_back(node.mFirst + 1);
+            }
+        }
+    }
+
+    void BVH::queryAABB(const glm::vec3 & min, const glm::vec3 & max, std::vector<unsigned> & out) const {
+        mNodesVisited = 0;
+        if (mNodes.empty()) {
+            return;
+        }
+
+        mStack.assign(1, 0);
+        while (mStack.size()) {
+            const Node & node = mNodes[mStack.back()];
+            mStack.pop_back();
+            mNodesVisited++;
+            if (!_overlaps(node.mMin, node.mMax, min, max)) {
+                continue;
+            }
+
+            if (node.mCount) {
+                for (unsigned i = node.mFirst; i < node.mFirst + node.mCount; i++) {
+                    if (_overlaps(mItemMins[i], mItemMaxs[i], min, max)) {
+                        out.push_back(mIndices[i]);
+                    }
+                }
+            }
+            else {
+                mStack.push_back(node.mFirst);
+                mStack.push_back(node.mFirst + 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <utility>
+
+namespace neo {
+
+    /* Bounding volume hierarchy over a set of AABBs. Items are the indices of the bounds passed to build(),
+     * and every query reports those indices. The tree only stores bounds -- callers keep whatever the
+     * indices refer to */
+    class BVH {
+
+        public:
+            /* 32 bytes so two nodes share a cache line. Internal nodes have mCount == 0 and their children at
+             * mFirst and mFirst + 1. Leaves cover mIndices[mFirst, mFirst + mCount) */
+            struct Node {
+                glm::vec3 mMin;
+                unsigned mFirst;
+                glm::vec3 mMax;
+                unsigned mCount;
+            };
+
+            static const unsigned MaxLeafSize = 4;
+
+            /* Binned SAH build. Slower than refit, but gives the best tree for the current bounds */
+            void build(const std::vector<glm::vec3> & mins, const std::vector<glm::vec3> & maxs);
+
+            /* Recomputes node bounds bottom-up from new item bounds, keeping the topology. Items must be the
+             * same ones the tree was built with */
+            void refit(const std::vector<glm::vec3> & mins, const std::vector<glm::vec3> & maxs);
+
+            /* Appends every item whose bounds touch the frustum. Planes point inward, like FrustumComponent's.
+             * Nodes pass down the planes they aren't fully inside, so subtrees only test those */
+            void queryFrustum(const glm::vec4 planes[6], std::vector<unsigned> & out) const;
+
+            /* Appends every item whose bounds the ray enters before maxDist, with the entry distance.
+             * dir doesn't need to be normalized -- distances are in units of dir */
+            void queryRay(const glm::vec3 & origin, const glm::vec3 & dir, float maxDist, std::vector<std::pair<unsigned, float>> & out) const;
+
+            /* Appends every item whose bounds overlap [min, max] */
+            void queryAABB(const glm::vec3 & min, const glm::vec3 & max, std::vector<unsigned> & out) const;
+
+            void clear() { mNodes.clear(); mIndices.clear(); mItemMins.clear(); mItemMaxs.clear(); }
+            bool empty() const { return mNodes.empty(); }
+            unsigned getNumItems() const { return unsigned(mIndices.size()); }
+            const std::vector<Node> & getNodes() const { return mNodes; }
+
+            /* Slab test. Returns where the ray enters the box -- 0 if it starts inside -- or -1 if it misses
+             * before maxDist */
+            static float intersectRay(const glm::vec3 & min, const glm::vec3 & max, const glm::vec3 & origin, const glm::vec3 & invDir, float maxDist);
+
+            /* Box against the frustum planes in mask. Planes the box is fully inside are cleared from mask, so
+             * anything inside the box can skip them. planeTests counts the planes tested */
+            static bool outsideFrustum(const glm::vec3 & min, const glm::vec3 & max, const glm::vec4 planes[6], unsigned & mask, unsigned & planeTests);
+
+            /* SAH cost of the tree relative to the root's area. Refits degrade it, so compare against the
+             * cost right after build to decide when to rebuild */
+            float getCost() const;
+
+            /* Nodes touched by the last query */
+            unsigned getNodesVisited() const { return mNodesVisited; }
+            /* Box-plane tests done by the last frustum query */
+            unsigned getPlaneTests() const { return mPlaneTests; }
+
+        private:
+            std::vector<Node> mNodes;
+            std::vector<unsigned> mIndices;
+            /* Item bounds in leaf order, parallel to mIndices, so leaves test items without chasing indices */
+            std::vector<glm::vec3> mItemMins;
+            std::vector<glm::vec3> mItemMaxs;
+            mutable unsigned mNodesVisited = 0;
+            mutable unsigned mPlaneTests = 0;
+            mutable std::vector<unsigned> mStack;
+            /* Planes left to test for each node on mStack during frustum queries */
+            mutable std::vector<unsigned> mMaskStack;
+
+            /* Build scratch, kept so rebuilds don't allocate */
+            std::vector<glm::vec3> mCentroids;
+
+            void _split(unsigned node, const std::vector<glm::vec3> & mins, const std::vector<glm::vec3> & maxs);
+            void _gatherItems(const std::vector<glm::vec3> & mins, const std::vector<glm::vec3> & maxs);
+            void _appendSubtree(unsigned node, std::vector<unsigned> & out) const;
+    };
+
+}
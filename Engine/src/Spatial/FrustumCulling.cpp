@@ -0,0 +1,331 @@
+#include "FrustumCulling.hpp"
+#include "SceneBVH.hpp"
+#include "WorldBounds.hpp"
+#include "BVH.hpp"
+
+#include "Engine.hpp"
+#include "ECS/GameObject.hpp"
+#include "ECS/Component/CollisionComponent/BoundingBoxComponent.hpp"
+#include "ECS/Component/CameraComponent/FrustumComponent.hpp"
+#include "ECS/Component/CameraComponent/CascadedShadowComponent.hpp"
+#include "Util/SIMD.hpp"
+#include "Util/ThreadPool.hpp"
+
+#include "ext/imgui/imgui.h"
+#include "ext/microprofile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cfloat>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace neo {
+
+    bool FrustumCulling::mCoherent = true;
+    unsigned FrustumCulling::mCapacity = 0;
+    std::vector<unsigned> FrustumCulling::mIDs;
+    unsigned FrustumCulling::mMaxID = 0;
+    std::vector<uint64_t> FrustumCulling::mLive;
+    std::vector<uint64_t> FrustumCulling::mChanged;
+    std::vector<glm::vec3> FrustumCulling::mGroupMins;
+    std::vector<glm::vec3> FrustumCulling::mGroupMaxs;
+    bool FrustumCulling::mRegathered = false;
+    unsigned FrustumCulling::mPass = 1;
+
+    namespace {
+        enum CullingCounter {
+            ObjectsTested,
+            ObjectsSkipped,
+            ObjectsVisible,
+            GroupsOutside,
+            GroupsInside,
+            PlaneTests,
+            PlaneCacheTries,
+            PlaneCacheHits,
+            NumCounters
+        };
+
+        unsigned _counter(CullingCounter counter) {
+            static const unsigned counters[NumCounters] = {
+                Counters::add("Culling", "Objects tested"),
+                Counters::add("Culling", "Objects skipped"),
+                Counters::add("Culling", "Objects visible"),
+                Counters::add("Culling", "Groups outside"),
+                Counters::add("Culling", "Groups inside"),
+                Counters::add("Culling", "Plane tests"),
+                Counters::add("Culling", "Plane cache tries"),
+                Counters::add("Culling", "Plane cache hits"),
+            };
+            return counters[counter];
+        }
+
+        const unsigned AllPlanes = 0x3F;
+        /* Rejecting plane of objects that were visible */
+        const uint8_t NoPlane = 6;
+
+        /* Groups handed to each worker at a time */
+        const unsigned GroupsPerTask = 64;
+
+        unsigned _lowestBit(uint64_t bits) {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward64(&index, bits);
+            return unsigned(index);
+#else
+            return unsigned(__builtin_ctzll(bits));
+#endif
+        }
+
+        unsigned _count(uint64_t bits) {
+            return unsigned(std::bitset<64>(bits).count());
+        }
+    }
+
+    void FrustumCulling::_writeSlot(unsigned slot) {
+        const auto & entry = SceneBVH::mEntries[slot];
+        const bool live = entry.mBox != nullptr;
+        mIDs[slot] = live ? entry.mBox->getGameObject().getID() : 0;
+        mMaxID = std::max(mMaxID, mIDs[slot]);
+
+        const uint64_t bit = uint64_t(1) << (slot % GroupSize);
+        if (live) {
+            mLive[slot / GroupSize] |= bit;
+        }
+        else {
+            mLive[slot / GroupSize] &= ~bit;
+        }
+        mChanged[slot / GroupSize] |= bit;
+    }
+
+    void FrustumCulling::_gather() {
+        MICROPROFILE_SCOPEI("FrustumCulling", "_gather", MP_AUTO);
+        SceneBVH::update();
+        const auto & entries = SceneBVH::mEntries;
+
+        std::fill(mChanged.begin(), mChanged.end(), 0);
+        mRegathered = WorldBounds::getCapacity() != mCapacity;
+        if (mRegathered) {
+            mCapacity = WorldBounds::getCapacity();
+            mIDs.assign(mCapacity, 0);
+            mLive.assign(mCapacity / GroupSize, 0);
+            mChanged.assign(mCapacity / GroupSize, 0);
+            mGroupMins.resize(mCapacity / GroupSize);
+            mGroupMaxs.resize(mCapacity / GroupSize);
+            for (unsigned slot = 0; slot < entries.size(); slot++) {
+                _writeSlot(slot);
+            }
+            for (auto index : SceneBVH::mChangedEntries) {
+                SceneBVH::mEntries[index].mChanged = false;
+            }
+        }
+        else {
+            for (auto index : SceneBVH::mChangedEntries) {
+                SceneBVH::mEntries[index].mChanged = false;
+                _writeSlot(index);
+            }
+        }
+        SceneBVH::mChangedEntries.clear();
+
+        for (unsigned group = 0; group < mLive.size(); group++) {
+            if (!mChanged[group]) {
+                continue;
+            }
+            glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+            for (uint64_t live = mLive[group]; live; live &= live - 1) {
+                const unsigned slot = group * GroupSize + _lowestBit(live);
+                min = glm::min(min, WorldBounds::getMin(slot));
+                max = glm::max(max, WorldBounds::getMax(slot));
+            }
+            mGroupMins[group] = min;
+            mGroupMaxs[group] = max;
+        }
+    }
+
+    void FrustumCulling::_cull(FrustumComponent & frustum) {
+        MICROPROFILE_SCOPEI("FrustumCulling", "_cull", MP_AUTO);
+        const glm::vec4 planes[6] = { frustum.mLeft, frustum.mRight, frustum.mBottom, frustum.mTop, frustum.mNear, frustum.mFar };
+        const unsigned groups = unsigned(mLive.size());
+
+        /* Last pass's result still holds for groups where nothing changed if the planes are the same */
+        const bool coherent = mCoherent && !mRegathered && frustum.mCulledPass + 1 == mPass &&
+            std::equal(planes, planes + 6, frustum.mCulledPlanes) && frustum.mSlotVisibility.size() == groups;
+        if (frustum.mSlotVisibility.size() != groups) {
+            frustum.mSlotVisibility.assign(groups, 0);
+        }
+        if (frustum.mRejectingPlane.size() != mCapacity) {
+            frustum.mRejectingPlane.assign(mCapacity, NoPlane);
+        }
+        std::copy(planes, planes + 6, frustum.mCulledPlanes);
+        frustum.mCulledPass = mPass;
+
+        /* No bounds yet, so nothing to cull -- and no rows to read */
+        if (!mCapacity) {
+            frustum.mVisibility.assign(mMaxID / 64 + 1, ~uint64_t(0));
+            return;
+        }
+
+        const float * const rows[6] = {
+            WorldBounds::getRow(WorldBounds::CenterX), WorldBounds::getRow(WorldBounds::CenterY), WorldBounds::getRow(WorldBounds::CenterZ),
+            WorldBounds::getRow(WorldBounds::ExtentX), WorldBounds::getRow(WorldBounds::ExtentY), WorldBounds::getRow(WorldBounds::ExtentZ),
+        };
+
+        std::atomic<uint64_t> totals[NumCounters];
+        for (auto & total : totals) {
+            total = 0;
+        }
+
+        /* Tasks own whole groups, so the workers never write the same word or slot */
+        ThreadPool::parallelFor(groups, GroupsPerTask, [&](unsigned begin, unsigned end) {
+            uint64_t counts[NumCounters] = {};
+            simd::vfloat normal[6][3], absNormal[6][3], offset[6];
+            for (int p = 0; p < 6; p++) {
+                for (int axis = 0; axis < 3; axis++) {
+                    normal[p][axis] = simd::set1(planes[p][axis]);
+                    absNormal[p][axis] = simd::abs(normal[p][axis]);
+                }
+                offset[p] = simd::set1(planes[p].w);
+            }
+            const simd::vfloat zero = simd::set1(0.f);
+            const unsigned laneMask = (1u << simd::Width) - 1;
+            uint8_t * const rejectingPlane = frustum.mRejectingPlane.data();
+
+            for (unsigned group = begin; group < end; group++) {
+                const uint64_t live = mLive[group];
+                uint64_t & visible = frustum.mSlotVisibility[group];
+                if (!live) {
+                    visible = 0;
+                    continue;
+                }
+                if (coherent && !mChanged[group]) {
+                    counts[ObjectsSkipped] += _count(live);
+                    counts[ObjectsVisible] += _count(visible);
+                    continue;
+                }
+                counts[ObjectsTested] += _count(live);
+
+                /* Test the group's bounds first. Planes it's fully inside don't need testing per object */
+                unsigned mask = AllPlanes;
+                unsigned planeTests = 0;
+                const bool outside = BVH::outsideFrustum(mGroupMins[group], mGroupMaxs[group], planes, mask, planeTests);
+                counts[PlaneTests] += planeTests;
+                if (outside) {
+                    counts[GroupsOutside]++;
+                    visible = 0;
+                    continue;
+                }
+                if (!mask) {
+                    counts[GroupsInside]++;
+                    visible = live;
+                    counts[ObjectsVisible] += _count(visible);
+                    continue;
+                }
+
+                visible = 0;
+                for (unsigned lane = 0; lane < GroupSize; lane += simd::Width) {
+                    const unsigned laneLive = unsigned(live >> lane) & laneMask;
+                    if (!laneLive) {
+                        continue;
+                    }
+                    const unsigned i = group * GroupSize + lane;
+                    const simd::vfloat center[3] = { simd::load(rows[0] + i), simd::load(rows[1] + i), simd::load(rows[2] + i) };
+                    const simd::vfloat extent[3] = { simd::load(rows[3] + i), simd::load(rows[4] + i), simd::load(rows[5] + i) };
+
+                    /* Each object tries the plane that rejected it last time. Lanes without one get a plane
+                     * that everything is in front of */
+                    alignas(32) float cached[4][simd::Width];
+                    for (int k = 0; k < simd::Width; k++) {
+                        const uint8_t p = rejectingPlane[i + k];
+                        const bool tried = ((laneLive >> k) & 1) && p != NoPlane && ((mask >> p) & 1);
+                        const glm::vec4 plane = tried ? planes[p] : glm::vec4(0.f, 0.f, 0.f, 1.f);
+                        for (int c = 0; c < 4; c++) {
+                            cached[c][k] = plane[c];
+                        }
+                        counts[PlaneCacheTries] += tried;
+                    }
+                    const simd::vfloat cachedNormal[3] = { simd::load(cached[0]), simd::load(cached[1]), simd::load(cached[2]) };
+                    const simd::vfloat cachedDistance = cachedNormal[0] * center[0] + cachedNormal[1] * center[1] + cachedNormal[2] * center[2] + simd::load(cached[3]);
+                    const simd::vfloat cachedRadius = simd::abs(cachedNormal[0]) * extent[0] + simd::abs(cachedNormal[1]) * extent[1] + simd::abs(cachedNormal[2]) * extent[2];
+                    const unsigned hits = unsigned(simd::movemask(cachedDistance + cachedRadius < zero)) & laneLive;
+                    counts[PlaneCacheHits] += _count(hits);
+                    counts[PlaneTests] += _count(laneLive);
+
+                    /* A box is outside a plane when its center is further behind it than the box's projected radius */
+                    unsigned remaining = laneLive & ~hits;
+                    for (unsigned p = 0; p < 6 && remaining; p++) {
+                        if (!((mask >> p) & 1)) {
+                            continue;
+                        }
+                        const simd::vfloat distance = normal[p][0] * center[0] + normal[p][1] * center[1] + normal[p][2] * center[2] + offset[p];
+                        const simd::vfloat radius = absNormal[p][0] * extent[0] + absNormal[p][1] * extent[1] + absNormal[p][2] * extent[2];
+                        const unsigned rejected = unsigned(simd::movemask(distance + radius < zero)) & remaining;
+                        counts[PlaneTests] += _count(remaining);
+                        for (unsigned bits = rejected; bits; bits &= bits - 1) {
+                            rejectingPlane[i + _lowestBit(bits)] = uint8_t(p);
+                        }
+                        remaining &= ~rejected;
+                    }
+                    for (unsigned bits = remaining; bits; bits &= bits - 1) {
+                        rejectingPlane[i + _lowestBit(bits)] = NoPlane;
+                    }
+                    visible |= uint64_t(remaining) << lane;
+                }
+                counts[ObjectsVisible] += _count(visible);
+            }
+
+            for (int c = 0; c < NumCounters; c++) {
+                totals[c] += counts[c];
+            }
+        });
+
+        for (int c = 0; c < NumCounters; c++) {
+            Counters::increment(_counter(CullingCounter(c)), totals[c]);
+        }
+
+        /* Scatter the culled slots into the GameObject ID bitset -- unless nothing could have changed */
+        const bool changed = std::any_of(mChanged.begin(), mChanged.end(), [](uint64_t bits) { return bits != 0; });
+        const unsigned words = mMaxID / 64 + 1;
+        if (coherent && !changed && frustum.mVisibility.size() == words) {
+            return;
+        }
+        frustum.mVisibility.assign(words, ~uint64_t(0));
+        for (unsigned group = 0; group < groups; group++) {
+            for (uint64_t culled = mLive[group] & ~frustum.mSlotVisibility[group]; culled; culled &= culled - 1) {
+                const unsigned id = mIDs[group * GroupSize + _lowestBit(culled)];
+                frustum.mVisibility[id / 64] &= ~(uint64_t(1) << (id % 64));
+            }
+        }
+    }
+
+    void FrustumCulling::cull() {
+        MICROPROFILE_SCOPEI("FrustumCulling", "cull", MP_AUTO);
+        mPass++;
+
+        /* Always gather, so changes don't pile up while there's nothing to cull for */
+        _gather();
+        for (auto frustum : Engine::getComponents<FrustumComponent>()) {
+            _cull(*frustum);
+        }
+        for (auto cascaded : Engine::getComponents<CascadedShadowComponent>()) {
+            for (int i = 0; i < cascaded->mNumCascades; i++) {
+                _cull(cascaded->mCascades[i].mFrustum);
+            }
+        }
+    }
+
+    void FrustumCulling::imguiEditor() {
+        ImGui::Checkbox("Temporal coherence", &mCoherent);
+        auto rate = [](CullingCounter part, CullingCounter whole) {
+            const double total = double(Counters::getLastFrame(_counter(whole)));
+            return total > 0.0 ? float(100.0 * double(Counters::getLastFrame(_counter(part))) / total) : 0.f;
+        };
+        const uint64_t tested = Counters::getLastFrame(_counter(ObjectsTested));
+        const uint64_t skipped = Counters::getLastFrame(_counter(ObjectsSkipped));
+        ImGui::Text("Skipped unchanged: %0.1f%%", tested + skipped ? float(100.0 * double(skipped) / double(tested + skipped)) : 0.f);
+        ImGui::Text("Plane cache hits: %0.1f%%", rate(PlaneCacheHits, PlaneCacheTries));
+        ImGui::Text("Plane tests per object tested: %0.2f", tested ? float(double(Counters::getLastFrame(_counter(PlaneTests))) / double(tested)) : 0.f);
+    }
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+namespace neo {
+
+    class FrustumComponent;
+
+    /* One culling pass per frame for every FrustumComponent and shadow cascade. Each frustum tests the world
+     * bounds of every object with a BoundingBoxComponent straight from WorldBounds' SoA rows, with SIMD across
+     * the worker threads. The result is written to each FrustumComponent's visibility bitset, so draw loops
+     * only check a bit -- see FrustumComponent::isVisible. Run after everything has moved, before rendering.
+     *
+     * Cameras barely move between frames, so the pass leans on the last frame's result. Every 64 slots form a
+     * group with its own bounds -- a group outside a plane culls all of its objects, and planes a group is fully
+     * inside aren't tested for its objects. Each object first tries the plane that rejected it last time. And
+     * when a frustum's planes haven't changed, groups where nothing moved keep last frame's result untested */
+    class FrustumCulling {
+
+        public:
+            static void cull();
+
+            static void imguiEditor();
+
+            /* Reuse results between frames. Turn off to compare against culling from scratch */
+            static bool mCoherent;
+
+        private:
+            /* Objects per group, one bit each */
+            static const unsigned GroupSize = 64;
+
+            /* Slots covered, following WorldBounds' capacity */
+            static unsigned mCapacity;
+            static std::vector<unsigned> mIDs;
+            static unsigned mMaxID;
+            /* Bitsets by group of occupied slots, and slots that changed since the last pass */
+            static std::vector<uint64_t> mLive;
+            static std::vector<uint64_t> mChanged;
+            static std::vector<glm::vec3> mGroupMins, mGroupMaxs;
+            /* Every slot was regathered this pass, so nothing from earlier passes holds */
+            static bool mRegathered;
+            static unsigned mPass;
+
+            static void _gather();
+            static void _writeSlot(unsigned slot);
+            static void _cull(FrustumComponent &);
+    };
+
+}
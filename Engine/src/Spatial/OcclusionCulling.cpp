@@ -0,0 +1,327 @@
+#include "OcclusionCulling.hpp"
+#include "SceneBVH.hpp"
+#include "WorldBounds.hpp"
+
+#include "Engine.hpp"
+#include "ECS/GameObject.hpp"
+#include "ECS/Component/CameraComponent/CameraComponent.hpp"
+#include "ECS/Component/CameraComponent/FrustumComponent.hpp"
+#include "ECS/Component/CameraComponent/MainCameraComponent.hpp"
+#include "ECS/Component/CollisionComponent/BoundingBoxComponent.hpp"
+#include "ECS/Component/CollisionComponent/OccluderComponent.hpp"
+#include "ECS/Component/SpatialComponent/SpatialComponent.hpp"
+#include "Util/SIMD.hpp"
+#include "Util/ThreadPool.hpp"
+
+#include "ext/imgui/imgui.h"
+#include "ext/microprofile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+
+namespace neo {
+
+    bool OcclusionCulling::mEnabled = true;
+    int OcclusionCulling::mWidth = 320;
+    int OcclusionCulling::mHeight = 192;
+    std::vector<OcclusionCulling::Triangle> OcclusionCulling::mTriangles;
+    std::vector<std::vector<unsigned>> OcclusionCulling::mBins;
+    std::vector<std::vector<float>> OcclusionCulling::mHiZ;
+    std::vector<glm::ivec2> OcclusionCulling::mHiZSizes;
+    std::vector<uint8_t> OcclusionCulling::mSlotOccluded;
+
+    namespace {
+        enum OcclusionCounter {
+            OccluderTriangles,
+            OccludeesTested,
+            OccludeesHidden,
+            NumCounters
+        };
+
+        unsigned _counter(OcclusionCounter counter) {
+            static const unsigned counters[NumCounters] = {
+                Counters::add("Occlusion", "Occluder triangles"),
+                Counters::add("Occlusion", "Occludees tested"),
+                Counters::add("Occlusion", "Occludees hidden"),
+            };
+            return counters[counter];
+        }
+
+        /* Anything this close to the eye plane is treated as crossing it */
+        const float NearW = 1e-4f;
+
+        /* Objects tested per task */
+        const unsigned OccludeesPerTask = 1024;
+    }
+
+    void OcclusionCulling::setResolution(int width, int height) {
+        mWidth = std::max((width + TileSize - 1) / TileSize, 1) * TileSize;
+        mHeight = std::max((height + TileSize - 1) / TileSize, 1) * TileSize;
+        mHiZ.clear();
+        mHiZSizes.clear();
+    }
+
+    void OcclusionCulling::_setupTriangle(const glm::vec4 & a, const glm::vec4 & b, const glm::vec4 & c) {
+        /* Triangles reaching behind the eye would need clipping. Dropping them only loses occlusion */
+        if (a.w < NearW || b.w < NearW || c.w < NearW) {
+            return;
+        }
+
+        const glm::vec2 scale(mWidth * 0.5f, mHeight * 0.5f);
+        glm::vec3 v[3];
+        for (int i = 0; i < 3; i++) {
+            const glm::vec4 & clip = i == 0 ? a : (i == 1 ? b : c);
+            v[i] = glm::vec3((glm::vec2(clip) / clip.w + 1.f) * scale, clip.z / clip.w);
+        }
+
+        /* Wind every triangle the same way so inside is where all edges are positive */
+        float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+        if (area < 0.f) {
+            std::swap(v[1], v[2]);
+            area = -area;
+        }
+        if (area < 1e-6f) {
+            return;
+        }
+
+        Triangle tri;
+        tri.mMin = glm::max(glm::ivec2(glm::floor(glm::min(glm::min(glm::vec2(v[0]), glm::vec2(v[1])), glm::vec2(v[2])))), glm::ivec2(0));
+        tri.mMax = glm::min(glm::ivec2(glm::ceil(glm::max(glm::max(glm::vec2(v[0]), glm::vec2(v[1])), glm::vec2(v[2])))), glm::ivec2(mWidth - 1, mHeight - 1));
+        if (tri.mMin.x > tri.mMax.x || tri.mMin.y > tri.mMax.y) {
+            return;
+        }
+
+        /* Edge i is opposite vertex i, so dividing by the area gives that vertex's barycentric weight */
+        for (int i = 0; i < 3; i++) {
+            const glm::vec3 & from = v[(i + 1) % 3];
+            const glm::vec3 & to = v[(i + 2) % 3];
+            tri.mEdges[i] = glm::vec3(from.y - to.y, to.x - from.x, from.x * to.y - from.y * to.x);
+        }
+        tri.mDepth = (tri.mEdges[0] * v[0].z + tri.mEdges[1] * v[1].z + tri.mEdges[2] * v[2].z) / area;
+
+        const unsigned index = unsigned(mTriangles.size());
+        mTriangles.push_back(tri);
+        const int tilesX = mWidth / TileSize;
+        for (int ty = tri.mMin.y / TileSize; ty <= tri.mMax.y / TileSize; ty++) {
+            for (int tx = tri.mMin.x / TileSize; tx <= tri.mMax.x / TileSize; tx++) {
+                mBins[ty * tilesX + tx].push_back(index);
+            }
+        }
+    }
+
+    void OcclusionCulling::_rasterizeTile(unsigned tile) {
+        const int tilesX = mWidth / TileSize;
+        const glm::ivec2 tileMin(int(tile) % tilesX * TileSize, int(tile) / tilesX * TileSize);
+        const glm::ivec2 tileMax = tileMin + glm::ivec2(TileSize - 1);
+        float * depth = mHiZ[0].data();
+
+        float laneOffsets[simd::Width];
+        for (int lane = 0; lane < simd::Width; lane++) {
+            laneOffsets[lane] = float(lane) + 0.5f;
+        }
+        const simd::vfloat offsets = simd::load(laneOffsets);
+        const simd::vfloat zero = simd::set1(0.f);
+
+        for (auto index : mBins[tile]) {
+            const Triangle & tri = mTriangles[index];
+            const glm::ivec2 min = glm::max(tri.mMin, tileMin);
+            const glm::ivec2 max = glm::min(tri.mMax, tileMax);
+            /* Rows start on a SIMD boundary. Tiles are a whole number of SIMD widths, so no row runs over */
+            const int startX = min.x - (min.x - tileMin.x) % simd::Width;
+
+            const simd::vfloat edgeX[3] = { simd::set1(tri.mEdges[0].x), simd::set1(tri.mEdges[1].x), simd::set1(tri.mEdges[2].x) };
+            const simd::vfloat depthX = simd::set1(tri.mDepth.x);
+            for (int y = min.y; y <= max.y; y++) {
+                const float py = float(y) + 0.5f;
+                const simd::vfloat edgeRow[3] = {
+                    simd::set1(tri.mEdges[0].y * py + tri.mEdges[0].z),
+                    simd::set1(tri.mEdges[1].y * py + tri.mEdges[1].z),
+                    simd::set1(tri.mEdges[2].y * py + tri.mEdges[2].z) };
+                const simd::vfloat depthRow = simd::set1(tri.mDepth.y * py + tri.mDepth.z);
+                float * row = depth + y * mWidth;
+                for (int x = startX; x <= max.x; x += simd::Width) {
+                    const simd::vfloat px = simd::set1(float(x)) + offsets;
+                    const simd::vfloat inside =
+                        (edgeX[0] * px + edgeRow[0] >= zero) &
+                        (edgeX[1] * px + edgeRow[1] >= zero) &
+                        (edgeX[2] * px + edgeRow[2] >= zero);
+                    if (!simd::movemask(inside)) {
+                        continue;
+                    }
+                    const simd::vfloat current = simd::load(row + x);
+                    const simd::vfloat z = depthX * px + depthRow;
+                    simd::store(row + x, simd::select(inside, simd::min(current, z), current));
+                }
+            }
+        }
+    }
+
+    void OcclusionCulling::_buildHiZ() {
+        MICROPROFILE_SCOPEI("OcclusionCulling", "_buildHiZ", MP_AUTO);
+        for (unsigned level = 1; level < mHiZ.size(); level++) {
+            const glm::ivec2 below = mHiZSizes[level - 1];
+            const glm::ivec2 size = mHiZSizes[level];
+            const float * src = mHiZ[level - 1].data();
+            float * dst = mHiZ[level].data();
+            for (int y = 0; y < size.y; y++) {
+                const int y0 = y * 2;
+                const int y1 = std::min(y0 + 1, below.y - 1);
+                for (int x = 0; x < size.x; x++) {
+                    const int x0 = x * 2;
+                    const int x1 = std::min(x0 + 1, below.x - 1);
+                    dst[y * size.x + x] = std::max(
+                        std::max(src[y0 * below.x + x0], src[y0 * below.x + x1]),
+                        std::max(src[y1 * below.x + x0], src[y1 * below.x + x1]));
+                }
+            }
+        }
+    }
+
+    bool OcclusionCulling::_isOccluded(const glm::mat4 & PV, const glm::vec3 & min, const glm::vec3 & max) {
+        glm::vec2 screenMin(FLT_MAX), screenMax(-FLT_MAX);
+        float nearest = FLT_MAX;
+        for (int corner = 0; corner < 8; corner++) {
+            const glm::vec4 clip = PV * glm::vec4(corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z, 1.f);
+            if (clip.w < NearW) {
+                /* Reaches behind the eye, so it's at least partly in front of everything */
+                return false;
+            }
+            const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            screenMin = glm::min(screenMin, glm::vec2(ndc));
+            screenMax = glm::max(screenMax, glm::vec2(ndc));
+            nearest = std::min(nearest, ndc.z);
+        }
+
+        const glm::vec2 scale(mWidth * 0.5f, mHeight * 0.5f);
+        const glm::ivec2 pixelMin = glm::max(glm::ivec2(glm::floor((screenMin + 1.f) * scale)), glm::ivec2(0));
+        const glm::ivec2 pixelMax = glm::min(glm::ivec2(glm::floor((screenMax + 1.f) * scale)), glm::ivec2(mWidth - 1, mHeight - 1));
+        if (pixelMin.x > pixelMax.x || pixelMin.y > pixelMax.y) {
+            return false;
+        }
+
+        /* The level where the rect covers at most 2x2 texels */
+        unsigned level = 0;
+        while (level + 1 < mHiZ.size() && ((pixelMax.x >> level) - (pixelMin.x >> level) > 1 || (pixelMax.y >> level) - (pixelMin.y >> level) > 1)) {
+            level++;
+        }
+        const glm::ivec2 size = mHiZSizes[level];
+        float furthest = -FLT_MAX;
+        for (int y = pixelMin.y >> level; y <= std::min(pixelMax.y >> level, size.y - 1); y++) {
+            for (int x = pixelMin.x >> level; x <= std::min(pixelMax.x >> level, size.x - 1); x++) {
+                furthest = std::max(furthest, mHiZ[level][y * size.x + x]);
+            }
+        }
+        return nearest > furthest;
+    }
+
+    void OcclusionCulling::cull() {
+        MICROPROFILE_SCOPEI("OcclusionCulling", "cull", MP_AUTO);
+        auto mainCamera = Engine::getComponentTuple<MainCameraComponent, CameraComponent>();
+        FrustumComponent * frustum = mainCamera ? mainCamera->mGameObject.getComponentByType<FrustumComponent>() : nullptr;
+        if (!frustum) {
+            return;
+        }
+        frustum->mOccluded.clear();
+        if (!mEnabled) {
+            return;
+        }
+
+        if (mHiZ.empty()) {
+            for (glm::ivec2 size(mWidth, mHeight);; size = (size + 1) / 2) {
+                mHiZSizes.push_back(size);
+                mHiZ.emplace_back(size.x * size.y);
+                if (size.x == 1 && size.y == 1) {
+                    break;
+                }
+            }
+        }
+
+        const auto camera = mainCamera->get<CameraComponent>();
+        const glm::mat4 PV = camera->getProj() * camera->getView();
+
+        /* Occluders the camera can see, into screen space triangles binned by tile */
+        {
+            MICROPROFILE_SCOPEI("OcclusionCulling", "Setup occluders", MP_AUTO);
+            mTriangles.clear();
+            mBins.resize((mWidth / TileSize) * (mHeight / TileSize));
+            for (auto & bin : mBins) {
+                bin.clear();
+            }
+            std::vector<glm::vec4> clip;
+            for (auto & occluderIt : Engine::getComponentTuples<OccluderComponent, SpatialComponent>()) {
+                if (!frustum->isVisible(occluderIt->mGameObject)) {
+                    continue;
+                }
+                auto occluder = occluderIt->get<OccluderComponent>();
+                const glm::mat4 PVM = PV * occluderIt->get<SpatialComponent>()->getModelMatrix();
+                clip.resize(occluder->mVertices.size());
+                for (unsigned i = 0; i < clip.size(); i++) {
+                    clip[i] = PVM * glm::vec4(occluder->mVertices[i], 1.f);
+                }
+                for (unsigned i = 0; i + 2 < occluder->mIndices.size(); i += 3) {
+                    _setupTriangle(clip[occluder->mIndices[i]], clip[occluder->mIndices[i + 1]], clip[occluder->mIndices[i + 2]]);
+                }
+            }
+            Counters::increment(_counter(OccluderTriangles), mTriangles.size());
+        }
+        if (mTriangles.empty()) {
+            return;
+        }
+
+        {
+            MICROPROFILE_SCOPEI("OcclusionCulling", "Rasterize", MP_AUTO);
+            std::fill(mHiZ[0].begin(), mHiZ[0].end(), 1.f);
+            ThreadPool::parallelFor(unsigned(mBins.size()), 1, [](unsigned begin, unsigned end) {
+                for (unsigned tile = begin; tile < end; tile++) {
+                    _rasterizeTile(tile);
+                }
+            });
+        }
+        _buildHiZ();
+
+        /* Test what frustum culling kept. Results go by slot first so the tasks never share a word */
+        MICROPROFILE_SCOPEI("OcclusionCulling", "Test occludees", MP_AUTO);
+        const auto & entries = SceneBVH::mEntries;
+        mSlotOccluded.assign(entries.size(), 0);
+        std::atomic<uint64_t> tested(0);
+        ThreadPool::parallelFor(unsigned(entries.size()), OccludeesPerTask, [&](unsigned begin, unsigned end) {
+            uint64_t count = 0;
+            for (unsigned slot = begin; slot < end; slot++) {
+                const auto & entry = entries[slot];
+                if (!entry.mBox || !frustum->isVisible(entry.mBox->getGameObject())) {
+                    continue;
+                }
+                count++;
+                mSlotOccluded[slot] = _isOccluded(PV, WorldBounds::getMin(slot), WorldBounds::getMax(slot));
+            }
+            tested += count;
+        });
+
+        uint64_t hidden = 0;
+        for (unsigned slot = 0; slot < entries.size(); slot++) {
+            if (!mSlotOccluded[slot]) {
+                continue;
+            }
+            const unsigned id = entries[slot].mBox->getGameObject().getID();
+            if (id / 64 >= frustum->mOccluded.size()) {
+                frustum->mOccluded.resize(id / 64 + 1, 0);
+            }
+            frustum->mOccluded[id / 64] |= uint64_t(1) << (id % 64);
+            hidden++;
+        }
+        Counters::increment(_counter(OccludeesTested), tested);
+        Counters::increment(_counter(OccludeesHidden), hidden);
+    }
+
+    void OcclusionCulling::imguiEditor() {
+        ImGui::Checkbox("Enabled", &mEnabled);
+        int resolution[2] = { mWidth, mHeight };
+        if (ImGui::SliderInt2("Resolution", resolution, TileSize, 1024)) {
+            setResolution(resolution[0], resolution[1]);
+        }
+        ImGui::Text("Occluder triangles: %d", int(Counters::getLastFrame(_counter(OccluderTriangles))));
+        ImGui::Text("Hidden: %d / %d", int(Counters::getLastFrame(_counter(OccludeesHidden))), int(Counters::getLastFrame(_counter(OccludeesTested))));
+    }
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+namespace neo {
+
+    class FrustumComponent;
+
+    /* Software occlusion culling for the main camera, entirely on the CPU. Every OccluderComponent the camera
+     * can see is rasterized into a small depth buffer -- binned into tiles, the tiles filled in parallel, a
+     * row of pixels per SIMD op. A max-depth pyramid is built over the result, and every object frustum
+     * culling kept is tested against it by the nearest depth of its world bounds. Hidden objects are marked in
+     * the camera FrustumComponent's mOccluded bits, so FrustumComponent::isVisible skips them. Run after
+     * FrustumCulling, before rendering */
+    class OcclusionCulling {
+
+        public:
+            static void cull();
+
+            static void imguiEditor();
+
+            static bool mEnabled;
+
+            /* Depth buffer size in pixels. Rounded up to whole tiles */
+            static void setResolution(int width, int height);
+
+        private:
+            static const int TileSize = 32;
+
+            /* Screen space triangle. Edge functions and depth are planes in pixel coordinates */
+            struct Triangle {
+                glm::vec3 mEdges[3];
+                glm::vec3 mDepth;
+                glm::ivec2 mMin, mMax;
+            };
+
+            static int mWidth, mHeight;
+            static std::vector<Triangle> mTriangles;
+            /* Triangles overlapping each tile */
+            static std::vector<std::vector<unsigned>> mBins;
+            /* Level 0 is the depth buffer, each level after keeps the furthest depth of 2x2 below it */
+            static std::vector<std::vector<float>> mHiZ;
+            static std::vector<glm::ivec2> mHiZSizes;
+            static std::vector<uint8_t> mSlotOccluded;
+
+            static void _setupTriangle(const glm::vec4 & a, const glm::vec4 & b, const glm::vec4 & c);
+            static void _rasterizeTile(unsigned tile);
+            static void _buildHiZ();
+            static bool _isOccluded(const glm::mat4 & PV, const glm::vec3 & min, const glm::vec3 & max);
+    };
+
+}
@@ -0,0 +1,370 @@
+#include "SceneBVH.hpp"
+#include "WorldBounds.hpp"
+
+#include "ECS/GameObject.hpp"
+#include "ECS/Component/CollisionComponent/BoundingBoxComponent.hpp"
+#include "ECS/Component/CameraComponent/FrustumComponent.hpp"
+#include "ECS/Component/SpatialComponent/SpatialComponent.hpp"
+
+#include "Util/Util.hpp"
+#include "Util/Counters.hpp"
+
+#include "ext/imgui/imgui.h"
+#include "ext/microprofile.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace neo {
+
+    unsigned SceneBVH::mSettleFrames = 60;
+    float SceneBVH::mRebuildRatio = 1.5f;
+    std::vector<SceneBVH::Entry> SceneBVH::mEntries;
+    std::vector<unsigned> SceneBVH::mFreeEntries;
+    std::vector<unsigned> SceneBVH::mDirtyEntries;
+    std::vector<unsigned> SceneBVH::mChangedEntries;
+    unsigned SceneBVH::mPendingStatic = 0;
+    unsigned SceneBVH::mStaleStatic = 0;
+    SceneBVH::Tree SceneBVH::mStatic;
+    SceneBVH::Tree SceneBVH::mDynamic;
+    std::vector<unsigned> SceneBVH::mUpdatedEntries;
+    std::vector<const BoundingBoxComponent *> SceneBVH::mUpdatedBoxes;
+    std::vector<unsigned> SceneBVH::mItems;
+    std::vector<std::pair<unsigned, float>> SceneBVH::mRayItems;
+    std::vector<std::pair<unsigned, float>> SceneBVH::mRayScratch;
+
+    namespace {
+        enum SceneBVHCounter {
+            StaticBuilds,
+            DynamicBuilds,
+            DynamicRefits,
+            NodesVisited,
+            PlaneTests,
+            NumCounters
+        };
+
+        unsigned _counter(SceneBVHCounter counter) {
+            static const unsigned counters[NumCounters] = {
+                Counters::add("Scene BVH", "Static builds"),
+                Counters::add("Scene BVH", "Dynamic builds"),
+                Counters::add("Scene BVH", "Dynamic refits"),
+                Counters::add("Scene BVH", "Nodes visited"),
+                Counters::add("Scene BVH", "Plane tests"),
+            };
+            return counters[counter];
+        }
+    }
+
+    void SceneBVH::insert(BoundingBoxComponent & box) {
+        if (mFreeEntries.size()) {
+            box.mSceneIndex = mFreeEntries.back();
+            mFreeEntries.pop_back();
+        }
+        else {
+            box.mSceneIndex = unsigned(mEntries.size());
+            mEntries.emplace_back();
+            WorldBounds::reserve(unsigned(mEntries.size()));
+        }
+
+        /* New objects count as settled -- they join the dynamic tree until the next static build */
+        const bool changed = mEntries[box.mSceneIndex].mChanged;
+        mEntries[box.mSceneIndex] = { &box, INT_MIN / 2, false, false, false, true, changed };
+        mDirtyEntries.push_back(box.mSceneIndex);
+        mPendingStatic++;
+        mDynamic.mNeedsBuild = true;
+    }
+
+    void SceneBVH::remove(BoundingBoxComponent & box) {
+        const unsigned index = box.mSceneIndex;
+        if (index >= mEntries.size() || mEntries[index].mBox != &box) {
+            return;
+        }
+        box.mSceneIndex = ~0u;
+
+        Entry & entry = mEntries[index];
+        if (entry.mInStatic) {
+            mStaleStatic++;
+        }
+        else {
+            if (!entry.mMoving) {
+                mPendingStatic--;
+            }
+            mDynamic.mNeedsBuild = true;
+        }
+        entry.mBox = nullptr;
+        entry.mInStatic = false;
+        entry.mDirty = false;
+        WorldBounds::clear(index);
+        if (!entry.mChanged) {
+            entry.mChanged = true;
+            mChangedEntries.push_back(index);
+        }
+        mFreeEntries.push_back(index);
+    }
+
+    void SceneBVH::markMoved(BoundingBoxComponent & box) {
+        if (box.mSceneIndex >= mEntries.size()) {
+            return;
+        }
+
+        /* Bounds for new entries are computed on the next update anyway, so moves before then -- like the ones
+         * from setting up the spatial -- don't count */
+        Entry & entry = mEntries[box.mSceneIndex];
+        if (entry.mDirty && entry.mLastMoved < 0) {
+            return;
+        }
+        entry.mLastMoved = Util::mTotalFrames;
+        entry.mMoved = true;
+        if (!entry.mDirty) {
+            entry.mDirty = true;
+            mDirtyEntries.push_back(box.mSceneIndex);
+        }
+    }
+
+    void SceneBVH::_buildStatic() {
+        MICROPROFILE_SCOPEI("SceneBVH", "_buildStatic", MP_AUTO);
+        Tree & tree = mStatic;
+        tree.mEntries.clear();
+        tree.mMins.clear();
+        tree.mMaxs.clear();
+        for (unsigned i = 0; i < mEntries.size(); i++) {
+            Entry & entry = mEntries[i];
+            entry.mInStatic = entry.mBox && !entry.mMoving;
+            if (entry.mInStatic) {
+                tree.mEntries.push_back(i);
+                tree.mMins.push_back(WorldBounds::getMin(i));
+                tree.mMaxs.push_back(WorldBounds::getMax(i));
+            }
+        }
+        tree.mBVH.build(tree.mMins, tree.mMaxs);
+        tree.mBuildCost = tree.mBVH.getCost();
+        tree.mNeedsBuild = false;
+        mPendingStatic = 0;
+        mStaleStatic = 0;
+        mDynamic.mNeedsBuild = true;
+        Counters::increment(_counter(StaticBuilds));
+    }
+
+    void SceneBVH::_buildDynamic() {
+        MICROPROFILE_SCOPEI("SceneBVH", "_buildDynamic", MP_AUTO);
+        Tree & tree = mDynamic;
+        tree.mEntries.clear();
+        tree.mMins.clear();
+        tree.mMaxs.clear();
+        for (unsigned i = 0; i < mEntries.size(); i++) {
+            const Entry & entry = mEntries[i];
+            if (entry.mBox && !entry.mInStatic) {
+                tree.mEntries.push_back(i);
+                tree.mMins.push_back(WorldBounds::getMin(i));
+                tree.mMaxs.push_back(WorldBounds::getMax(i));
+            }
+        }
+        tree.mBVH.build(tree.mMins, tree.mMaxs);
+        tree.mBuildCost = tree.mBVH.getCost();
+        tree.mNeedsBuild = false;
+        tree.mNeedsRefit = false;
+        Counters::increment(_counter(DynamicBuilds));
+    }
+
+    void SceneBVH::update() {
+        MICROPROFILE_SCOPEI("SceneBVH", "update", MP_AUTO);
+
+        /* Recompute the world bounds of everything that changed in one batch */
+        mUpdatedEntries.clear();
+        mUpdatedBoxes.clear();
+        for (auto index : mDirtyEntries) {
+            Entry & entry = mEntries[index];
+            if (!entry.mBox || !entry.mDirty) {
+                continue;
+            }
+            entry.mDirty = false;
+            mUpdatedEntries.push_back(index);
+            mUpdatedBoxes.push_back(entry.mBox);
+        }
+        mDirtyEntries.clear();
+        WorldBounds::update(mUpdatedEntries, mUpdatedBoxes);
+
+        for (auto index : mUpdatedEntries) {
+            Entry & entry = mEntries[index];
+            if (!entry.mChanged) {
+                entry.mChanged = true;
+                mChangedEntries.push_back(index);
+            }
+            if (!entry.mMoved) {
+                continue;
+            }
+            entry.mMoved = false;
+            if (entry.mInStatic) {
+                /* Its static item is stale now -- the dynamic tree takes over */
+                entry.mInStatic = false;
+                mStaleStatic++;
+                mDynamic.mNeedsBuild = true;
+            }
+            else {
+                if (!entry.mMoving) {
+                    mPendingStatic--;
+                }
+                mDynamic.mNeedsRefit = true;
+            }
+            entry.mMoving = true;
+        }
+
+        /* Settle objects that have been still long enough, at most once a frame */
+        static int lastSettleFrame = INT_MIN;
+        const int frame = Util::mTotalFrames;
+        if (frame != lastSettleFrame) {
+            lastSettleFrame = frame;
+            for (auto index : mDynamic.mEntries) {
+                Entry & entry = mEntries[index];
+                if (entry.mBox && entry.mMoving && frame - entry.mLastMoved > int(mSettleFrames)) {
+                    entry.mMoving = false;
+                    mPendingStatic++;
+                }
+            }
+        }
+
+        /* Batch static builds -- wait until a tenth of the tree is waiting to join or a quarter of it is stale */
+        const unsigned staticItems = mStatic.mBVH.getNumItems();
+        if (mPendingStatic * 10 > staticItems || mStaleStatic * 4 > staticItems) {
+            _buildStatic();
+        }
+
+        if (mDynamic.mNeedsBuild) {
+            _buildDynamic();
+        }
+        else if (mDynamic.mNeedsRefit) {
+            MICROPROFILE_SCOPEI("SceneBVH", "Dynamic refit", MP_AUTO);
+            for (unsigned i = 0; i < mDynamic.mEntries.size(); i++) {
+                mDynamic.mMins[i] = WorldBounds::getMin(mDynamic.mEntries[i]);
+                mDynamic.mMaxs[i] = WorldBounds::getMax(mDynamic.mEntries[i]);
+            }
+            mDynamic.mBVH.refit(mDynamic.mMins, mDynamic.mMaxs);
+            mDynamic.mNeedsRefit = false;
+            Counters::increment(_counter(DynamicRefits));
+            if (mDynamic.mBVH.getCost() > mDynamic.mBuildCost * mRebuildRatio) {
+                _buildDynamic();
+            }
+        }
+    }
+
+    void SceneBVH::queryFrustum(const FrustumComponent & frustum, std::vector<GameObject *> & out) {
+        MICROPROFILE_SCOPEI("SceneBVH", "queryFrustum", MP_AUTO);
+        update();
+
+        const glm::vec4 planes[6] = { frustum.mLeft, frustum.mRight, frustum.mBottom, frustum.mTop, frustum.mNear, frustum.mFar };
+        for (auto tree : { &mStatic, &mDynamic }) {
+            mItems.clear();
+            tree->mBVH.queryFrustum(planes, mItems);
+            Counters::increment(_counter(NodesVisited), tree->mBVH.getNodesVisited());
+            Counters::increment(_counter(PlaneTests), tree->mBVH.getPlaneTests());
+            for (auto item : mItems) {
+                const Entry & entry = mEntries[tree->mEntries[item]];
+                if (tree == &mDynamic || entry.mInStatic) {
+                    out.push_back(&entry.mBox->getGameObject());
+                }
+            }
+        }
+    }
+
+    void SceneBVH::_queryRayEntries(const glm::vec3 & origin, const glm::vec3 & dir, float maxDist) {
+        update();
+
+        mRayItems.clear();
+        for (auto tree : { &mStatic, &mDynamic }) {
+            mRayScratch.clear();
+            tree->mBVH.queryRay(origin, dir, maxDist, mRayScratch);
+            Counters::increment(_counter(NodesVisited), tree->mBVH.getNodesVisited());
+            for (auto & hit : mRayScratch) {
+                const unsigned index = tree->mEntries[hit.first];
+                if (tree == &mDynamic || mEntries[index].mInStatic) {
+                    mRayItems.emplace_back(index, hit.second);
+                }
+            }
+        }
+        std::sort(mRayItems.begin(), mRayItems.end(), [](const std::pair<unsigned, float> & a, const std::pair<unsigned, float> & b) {
+            return a.second < b.second;
+        });
+    }
+
+    void SceneBVH::queryRay(const glm::vec3 & origin, const glm::vec3 & dir, float maxDist, std::vector<std::pair<GameObject *, float>> & out) {
+        MICROPROFILE_SCOPEI("SceneBVH", "queryRay", MP_AUTO);
+        _queryRayEntries(origin, dir, maxDist);
+        for (auto & item : mRayItems) {
+            out.emplace_back(&mEntries[item.first].mBox->getGameObject(), item.second);
+        }
+    }
+
+    GameObject * SceneBVH::raycast(const glm::vec3 & origin, const glm::vec3 & dir, float maxDist, float & distance, const RayFilter & filter) {
+        MICROPROFILE_SCOPEI("SceneBVH", "raycast", MP_AUTO);
+        _queryRayEntries(origin, dir, maxDist);
+
+        /* Candidates come nearest bounds first, and a box is never hit before its bounds, so stop once the
+         * bounds start past the best hit */
+        GameObject * nearest = nullptr;
+        distance = maxDist;
+        for (auto & item : mRayItems) {
+            if (item.second > distance) {
+                break;
+            }
+            GameObject & gameObject = mEntries[item.first].mBox->getGameObject();
+            if (filter && !filter(gameObject)) {
+                continue;
+            }
+            const float t = mEntries[item.first].mBox->intersect(origin, dir, distance);
+            if (t >= 0.f && (!nearest || t < distance)) {
+                nearest = &gameObject;
+                distance = t;
+            }
+        }
+        return nearest;
+    }
+
+    void SceneBVH::raycastAll(const glm::vec3 & origin, const glm::vec3 & dir, float maxDist, std::vector<std::pair<GameObject *, float>> & out, const RayFilter & filter) {
+        MICROPROFILE_SCOPEI("SceneBVH", "raycastAll", MP_AUTO);
+        _queryRayEntries(origin, dir, maxDist);
+
+        const size_t first = out.size();
+        for (auto & item : mRayItems) {
+            GameObject & gameObject = mEntries[item.first].mBox->getGameObject();
+            if (filter && !filter(gameObject)) {
+                continue;
+            }
+            const float t = mEntries[item.first].mBox->intersect(origin, dir, maxDist);
+            if (t >= 0.f) {
+                out.emplace_back(&gameObject, t);
+            }
+        }
+        std::sort(out.begin() + first, out.end(), [](const std::pair<GameObject *, float> & a, const std::pair<GameObject *, float> & b) {
+            return a.second < b.second;
+        });
+    }
+
+    void SceneBVH::queryAABB(const glm::vec3 & min, const glm::vec3 & max, std::vector<GameObject *> & out) {
+        MICROPROFILE_SCOPEI("SceneBVH", "queryAABB", MP_AUTO);
+        update();
+
+        for (auto tree : { &mStatic, &mDynamic }) {
+            mItems.clear();
+            tree->mBVH.queryAABB(min, max, mItems);
+            Counters::increment(_counter(NodesVisited), tree->mBVH.getNodesVisited());
+            for (auto item : mItems) {
+                const Entry & entry = mEntries[tree->mEntries[item]];
+                if (tree == &mDynamic || entry.mInStatic) {
+                    out.push_back(&entry.mBox->getGameObject());
+                }
+            }
+        }
+    }
+
+    void SceneBVH::imguiEditor() {
+        ImGui::Text("Objects: %d", int(mEntries.size() - mFreeEntries.size()));
+        ImGui::Text("Static: %d (%d nodes, cost %0.1f, %d stale, %d waiting)", int(mStatic.mEntries.size()), int(mStatic.mBVH.getNodes().size()), mStatic.mBuildCost, int(mStaleStatic), int(mPendingStatic));
+        ImGui::Text("Dynamic: %d (%d nodes, cost %0.1f / %0.1f)", int(mDynamic.mEntries.size()), int(mDynamic.mBVH.getNodes().size()), mDynamic.mBVH.getCost(), mDynamic.mBuildCost);
+        int settleFrames = int(mSettleFrames);
+        if (ImGui::SliderInt("Settle frames", &settleFrames, 1, 600)) {
+            mSettleFrames = unsigned(settleFrames);
+        }
+        ImGui::SliderFloat("Rebuild ratio", &mRebuildRatio, 1.f, 4.f);
+    }
+
+}
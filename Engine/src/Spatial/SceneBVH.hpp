@@ -0,0 +1,114 @@
+#pragma once
+
+#include "BVH.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <utility>
+#include <functional>
+
+namespace neo {
+
+    class GameObject;
+    class BoundingBoxComponent;
+    class FrustumComponent;
+
+    /* World-space BVH over every BoundingBoxComponent, split into two trees. The static tree is SAH built over
+     * objects that have been still for a while, and is only rebuilt in batches -- once enough objects are
+     * waiting to join it, or enough of its items went stale. Everything else lives in the small dynamic tree,
+     * which is refit every update and rebuilt when its members change or refitting has degraded it. An object
+     * that moves leaves the static tree (its item there is just ignored) and rejoins on a later rebuild once
+     * it has settled.
+     *
+     * Bounding boxes register themselves and track their SpatialChangeMessages, so the trees catch up lazily
+     * on the next query. Queries see moves that have been relayed. Main thread only */
+    class SceneBVH {
+
+        friend class FrustumCulling;
+        friend class OcclusionCulling;
+        friend class OcclusionQueries;
+
+        public:
+            /* Used by BoundingBoxComponent */
+            static void insert(BoundingBoxComponent &);
+            static void remove(BoundingBoxComponent &);
+            static void markMoved(BoundingBoxComponent &);
+
+            /* Brings the trees up to date. Queries call this themselves */
+            static void update();
+
+            /* Objects whose world bounds touch the frustum */
+            static void queryFrustum(const FrustumComponent &, std::vector<GameObject *> & out);
+            /* Objects whose world bounds the ray enters before maxDist, with the entry distance, nearest first */
+            static void queryRay(const glm::vec3 & origin, const glm::vec3 & dir, float maxDist, std::vector<std::pair<GameObject *, float>> & out);
+            /* Objects whose world bounds overlap [min, max] */
+            static void queryAABB(const glm::vec3 & min, const glm::vec3 & max, std::vector<GameObject *> & out);
+
+            /* Exact ray casts against each BoundingBoxComponent in its object space, so rotated boxes don't pick
+             * from their loose world bounds. Only objects passing filter count. raycast returns the nearest hit
+             * and its distance, or nullptr. raycastAll appends every hit, nearest first */
+            using RayFilter = std::function<bool(const GameObject &)>;
+            static GameObject * raycast(const glm::vec3 & origin, const glm::vec3 & dir, float maxDist, float & distance, const RayFilter & filter = nullptr);
+            static void raycastAll(const glm::vec3 & origin, const glm::vec3 & dir, float maxDist, std::vector<std::pair<GameObject *, float>> & out, const RayFilter & filter = nullptr);
+
+            static void imguiEditor();
+
+            /* Frames an object has to stay still before it goes back to the static tree */
+            static unsigned mSettleFrames;
+            /* Rebuild the dynamic tree once refits have made it this much worse than when it was built */
+            static float mRebuildRatio;
+
+        private:
+            /* Slots are reused but never move, so trees can refer to them while objects come and go. Each slot's
+             * world bounds are in WorldBounds */
+            struct Entry {
+                BoundingBoxComponent * mBox;
+                int mLastMoved;
+                /* The static tree has this entry's current bounds. Otherwise it's in the dynamic tree */
+                bool mInStatic;
+                /* Moved within the last mSettleFrames */
+                bool mMoving;
+                bool mMoved;
+                bool mDirty;
+                /* Waiting in mChangedEntries */
+                bool mChanged;
+            };
+
+            static std::vector<Entry> mEntries;
+            static std::vector<unsigned> mFreeEntries;
+            /* Entries that changed since the last update */
+            static std::vector<unsigned> mDirtyEntries;
+            /* Entries whose bounds were updated, or that were added or removed, since FrustumCulling last looked */
+            static std::vector<unsigned> mChangedEntries;
+            /* Settled entries waiting for the static tree, and static items that no longer count */
+            static unsigned mPendingStatic;
+            static unsigned mStaleStatic;
+
+            struct Tree {
+                BVH mBVH;
+                /* Tree item -> entry */
+                std::vector<unsigned> mEntries;
+                std::vector<glm::vec3> mMins, mMaxs;
+                float mBuildCost = 0.f;
+                bool mNeedsBuild = false;
+                bool mNeedsRefit = false;
+            };
+            static Tree mStatic;
+            static Tree mDynamic;
+
+            static void _buildStatic();
+            static void _buildDynamic();
+            /* Entries whose world bounds the ray enters, nearest first, into mRayItems */
+            static void _queryRayEntries(const glm::vec3 & origin, const glm::vec3 & dir, float maxDist);
+
+            /* Entries whose world bounds are recomputed this update */
+            static std::vector<unsigned> mUpdatedEntries;
+            static std::vector<const BoundingBoxComponent *> mUpdatedBoxes;
+            /* Scratch for translating tree items to entries */
+            static std::vector<unsigned> mItems;
+            static std::vector<std::pair<unsigned, float>> mRayItems;
+            static std::vector<std::pair<unsigned, float>> mRayScratch;
+    };
+
+}
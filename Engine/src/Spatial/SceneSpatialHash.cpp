@@ -0,0 +1,119 @@
+#include "SceneSpatialHash.hpp"
+
+#include "ECS/GameObject.hpp"
+#include "ECS/Component/SpatialComponent/SpatialComponent.hpp"
+#include "ECS/Component/SpatialComponent/SpatialHashComponent.hpp"
+
+#include "ext/imgui/imgui.h"
+#include "ext/microprofile.h"
+
+namespace neo {
+
+    SpatialHash SceneSpatialHash::mHash;
+    std::vector<SpatialHashComponent *> SceneSpatialHash::mComponents;
+    std::vector<SpatialComponent *> SceneSpatialHash::mSpatials;
+    std::vector<unsigned> SceneSpatialHash::mFreeIDs;
+    std::vector<unsigned> SceneSpatialHash::mMoved;
+    std::vector<bool> SceneSpatialHash::mMovedFlags;
+    std::vector<unsigned> SceneSpatialHash::mIDs;
+    std::vector<std::pair<unsigned, float>> SceneSpatialHash::mNearest;
+
+    void SceneSpatialHash::insert(SpatialHashComponent & component) {
+        /* Objects without a position have nothing to hash */
+        SpatialComponent * spatial = component.getGameObject().getComponentByType<SpatialComponent>();
+        if (!spatial) {
+            return;
+        }
+
+        if (mFreeIDs.size()) {
+            component.mSceneHashID = mFreeIDs.back();
+            mFreeIDs.pop_back();
+        }
+        else {
+            component.mSceneHashID = unsigned(mComponents.size());
+            mComponents.push_back(nullptr);
+            mSpatials.push_back(nullptr);
+            mMovedFlags.push_back(false);
+        }
+
+        mComponents[component.mSceneHashID] = &component;
+        mSpatials[component.mSceneHashID] = spatial;
+        mMovedFlags[component.mSceneHashID] = false;
+        mHash.insert(component.mSceneHashID, spatial->getPosition());
+    }
+
+    void SceneSpatialHash::remove(SpatialHashComponent & component) {
+        const unsigned id = component.mSceneHashID;
+        if (id >= mComponents.size() || mComponents[id] != &component) {
+            return;
+        }
+
+        mHash.remove(id);
+        mComponents[id] = nullptr;
+        mSpatials[id] = nullptr;
+        mFreeIDs.push_back(id);
+        component.mSceneHashID = ~0u;
+    }
+
+    void SceneSpatialHash::markMoved(SpatialHashComponent & component) {
+        const unsigned id = component.mSceneHashID;
+        if (id < mComponents.size() && !mMovedFlags[id]) {
+            mMovedFlags[id] = true;
+            mMoved.push_back(id);
+        }
+    }
+
+    void SceneSpatialHash::update() {
+        MICROPROFILE_SCOPEI("SceneSpatialHash", "update", MP_AUTO);
+        for (auto id : mMoved) {
+            mMovedFlags[id] = false;
+            if (mSpatials[id]) {
+                mHash.update(id, mSpatials[id]->getPosition());
+            }
+        }
+        mMoved.clear();
+    }
+
+    void SceneSpatialHash::queryRadius(const glm::vec3 & center, float radius, std::vector<GameObject *> & out) {
+        MICROPROFILE_SCOPEI("SceneSpatialHash", "queryRadius", MP_AUTO);
+        update();
+
+        mIDs.clear();
+        mHash.queryRadius(center, radius, mIDs);
+        for (auto id : mIDs) {
+            out.push_back(&mSpatials[id]->getGameObject());
+        }
+    }
+
+    void SceneSpatialHash::queryAABB(const glm::vec3 & min, const glm::vec3 & max, std::vector<GameObject *> & out) {
+        MICROPROFILE_SCOPEI("SceneSpatialHash", "queryAABB", MP_AUTO);
+        update();
+
+        mIDs.clear();
+        mHash.queryAABB(min, max, mIDs);
+        for (auto id : mIDs) {
+            out.push_back(&mSpatials[id]->getGameObject());
+        }
+    }
+
+    void SceneSpatialHash::queryNearest(const glm::vec3 & position, unsigned k, std::vector<std::pair<GameObject *, float>> & out) {
+        MICROPROFILE_SCOPEI("SceneSpatialHash", "queryNearest", MP_AUTO);
+        update();
+
+        mNearest.clear();
+        mHash.queryNearest(position, k, mNearest);
+        for (auto & nearest : mNearest) {
+            out.emplace_back(&mSpatials[nearest.first]->getGameObject(), nearest.second);
+        }
+    }
+
+    void SceneSpatialHash::imguiEditor() {
+        ImGui::Text("Objects: %d", int(mHash.getNumItems()));
+        ImGui::Text("Cells: %d", int(mHash.getNumCells()));
+        float cellSize = mHash.getCellSize();
+        if (ImGui::SliderFloat("Cell size", &cellSize, 0.25f, 64.f)) {
+            mHash.setCellSize(cellSize);
+        }
+    }
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "SpatialHash.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <utility>
+
+namespace neo {
+
+    class GameObject;
+    class SpatialComponent;
+    class SpatialHashComponent;
+
+    /* Spatial hash over the SpatialComponent position of every object with a SpatialHashComponent -- a lighter
+     * alternative to SceneBVH for scenes where most things move every frame, like lights or metaballs. The
+     * components register themselves and mark themselves moved through their SpatialChangeMessages, and moved
+     * positions are rehashed lazily on the next query. Queries return GameObjects, so filter by the components
+     * you're after. Main thread only */
+    class SceneSpatialHash {
+
+        public:
+            /* Used by SpatialHashComponent */
+            static void insert(SpatialHashComponent &);
+            static void remove(SpatialHashComponent &);
+            static void markMoved(SpatialHashComponent &);
+
+            /* Rehashes moved positions. Queries call this themselves */
+            static void update();
+
+            /* Objects within radius of center */
+            static void queryRadius(const glm::vec3 & center, float radius, std::vector<GameObject *> & out);
+            /* Objects inside [min, max] */
+            static void queryAABB(const glm::vec3 & min, const glm::vec3 & max, std::vector<GameObject *> & out);
+            /* The k objects nearest to position with their distances, nearest first */
+            static void queryNearest(const glm::vec3 & position, unsigned k, std::vector<std::pair<GameObject *, float>> & out);
+
+            static void setCellSize(float cellSize) { mHash.setCellSize(cellSize); }
+
+            static void imguiEditor();
+
+        private:
+            static SpatialHash mHash;
+            /* Hash id -> component and its spatial, null for free ids */
+            static std::vector<SpatialHashComponent *> mComponents;
+            static std::vector<SpatialComponent *> mSpatials;
+            static std::vector<unsigned> mFreeIDs;
+            static std::vector<unsigned> mMoved;
+            static std::vector<bool> mMovedFlags;
+
+            /* Scratch for translating ids to objects */
+            static std::vector<unsigned> mIDs;
+            static std::vector<std::pair<unsigned, float>> mNearest;
+    };
+
+}
@@ -0,0 +1,253 @@
+#include "SpatialHash.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace neo {
+
+    namespace {
+        /* Cell coordinates are packed into 21 bits each */
+        const int CellLimit = (1 << 20) - 1;
+    }
+
+    SpatialHash::SpatialHash(float cellSize) :
+        mCellSize(cellSize),
+        mInvCellSize(1.f / cellSize),
+        mItems(),
+        mNumItems(0),
+        mCells(),
+        mMinCell(INT_MAX),
+        mMaxCell(INT_MIN)
+    {}
+
+    void SpatialHash::setCellSize(float cellSize) {
+        mCellSize = cellSize;
+        mInvCellSize = 1.f / cellSize;
+        mCells.clear();
+        mMinCell = glm::ivec3(INT_MAX);
+        mMaxCell = glm::ivec3(INT_MIN);
+        for (unsigned id = 0; id < mItems.size(); id++) {
+            if (mItems[id].mLive) {
+                _addToCell(id, _key(_cellCoord(mItems[id].mPosition)));
+            }
+        }
+    }
+
+    glm::ivec3 SpatialHash::_cellCoord(const glm::vec3 & position) const {
+        const glm::vec3 cell = glm::floor(position * mInvCellSize);
+        return glm::ivec3(
+            int(glm::clamp(cell.x, float(-CellLimit), float(CellLimit))),
+            int(glm::clamp(cell.y, float(-CellLimit), float(CellLimit))),
+            int(glm::clamp(cell.z, float(-CellLimit), float(CellLimit))));
+    }
+
+    uint64_t SpatialHash::_key(const glm::ivec3 & cell) {
+        return (uint64_t(cell.x + CellLimit) << 42) | (uint64_t(cell.y + CellLimit) << 21) | uint64_t(cell.z + CellLimit);
+    }
+
+    void SpatialHash::_addToCell(unsigned id, uint64_t key) {
+        auto & cell = mCells[key];
+        mItems[id].mCell = key;
+        mItems[id].mSlot = unsigned(cell.size());
+        cell.push_back(id);
+
+        const glm::ivec3 coord(int(key >> 42) - CellLimit, int((key >> 21) & 0x1FFFFF) - CellLimit, int(key & 0x1FFFFF) - CellLimit);
+        mMinCell = glm::min(mMinCell, coord);
+        mMaxCell = glm::max(mMaxCell, coord);
+    }
+
+    void SpatialHash::_removeFromCell(unsigned id) {
+        auto it = mCells.find(mItems[id].mCell);
+        auto & cell = it->second;
+        const unsigned slot = mItems[id].mSlot;
+        cell[slot] = cell.back();
+        mItems[cell[slot]].mSlot = slot;
+        cell.pop_back();
+        if (cell.empty()) {
+            mCells.erase(it);
+        }
+    }
+
+    void SpatialHash::insert(unsigned id, const glm::vec3 & position) {
+        if (id >= mItems.size()) {
+            mItems.resize(id + 1, Item{ glm::vec3(0.f), 0, 0, false });
+        }
+        if (mItems[id].mLive) {
+            update(id, position);
+            return;
+        }
+
+        mItems[id].mPosition = position;
+        mItems[id].mLive = true;
+        mNumItems++;
+        _addToCell(id, _key(_cellCoord(position)));
+    }
+
+    void SpatialHash::update(unsigned id, const glm::vec3 & position) {
+        Item & item = mItems[id];
+        item.mPosition = position;
+        const uint64_t key = _key(_cellCoord(position));
+        if (key != item.mCell) {
+            _removeFromCell(id);
+            _addToCell(id, key);
+        }
+    }
+
+    void SpatialHash::remove(unsigned id) {
+        if (id >= mItems.size() || !mItems[id].mLive) {
+            return;
+        }
+
+        _removeFromCell(id);
+        mItems[id].mLive = false;
+        mNumItems--;
+    }
+
+    void SpatialHash::clear() {
+        mItems.clear();
+        mCells.clear();
+        mNumItems = 0;
+        mMinCell = glm::ivec3(INT_MAX);
+        mMaxCell = glm::ivec3(INT_MIN);
+    }
+
+    template <typename F>
+    void SpatialHash::_forEachInRange(const glm::ivec3 & rangeMin, const glm::ivec3 & rangeMax, F && func) const {
+        const glm::ivec3 min = glm::max(rangeMin, mMinCell);
+        const glm::ivec3 max = glm::min(rangeMax, mMaxCell);
+        if (min.x > max.x || min.y > max.y || min.z > max.z) {
+            return;
+        }
+
+        /* Probing more cells than there are items is slower than checking every item */
+        const double cells = double(max.x - min.x + 1) * double(max.y - min.y + 1) * double(max.z - min.z + 1);
+        if (cells > double(mNumItems)) {
+            for (unsigned id = 0; id < mItems.size(); id++) {
+                if (mItems[id].mLive) {
+                    func(id);
+                }
+            }
+            return;
+        }
+
+        for (int x = min.x; x <= max.x; x++) {
+            for (int y = min.y; y <= max.y; y++) {
+                for (int z = min.z; z <= max.z; z++) {
+                    auto it = mCells.find(_key(glm::ivec3(x, y, z)));
+                    if (it != mCells.end()) {
+                        for (auto id : it->second) {
+                            func(id);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void SpatialHash::queryRadius(const glm::vec3 & center, float radius, std::vector<unsigned> & out) const {
+        const float radius2 = radius * radius;
+        _forEachInRange(_cellCoord(center - glm::vec3(radius)), _cellCoord(center + glm::vec3(radius)), [&](unsigned id) {
+            const glm::vec3 d = mItems[id].mPosition - center;
+            if (glm::dot(d, d) <= radius2) {
+                out.push_back(id);
+            }
+        });
+    }
+
+    void SpatialHash::queryAABB(const glm::vec3 & min, const glm::vec3 & max, std::vector<unsigned> & out) const {
+        _forEachInRange(_cellCoord(min), _cellCoord(max), [&](unsigned id) {
+            const glm::vec3 & p = mItems[id].mPosition;
+            if (p.x >= min.x && p.y >= min.y && p.z >= min.z && p.x <= max.x && p.y <= max.y && p.z <= max.z) {
+                out.push_back(id);
+            }
+        });
+    }
+
+    void SpatialHash::queryNearest(const glm::vec3 & position, unsigned k, std::vector<std::pair<unsigned, float>> & out) const {
+        if (!k || !mNumItems) {
+            return;
+        }
+
+        /* Max-heap of the best k squared distances so far */
+        std::vector<std::pair<float, unsigned>> best;
+        best.reserve(k + 1);
+        auto consider = [&](unsigned id) {
+            const glm::vec3 d = mItems[id].mPosition - position;
+            const float dist2 = glm::dot(d, d);
+            if (best.size() < k) {
+                best.emplace_back(dist2, id);
+                std::push_heap(best.begin(), best.end());
+            }
+            else if (dist2 < best.front().first) {
+                std::pop_heap(best.begin(), best.end());
+                best.back() = { dist2, id };
+                std::push_heap(best.begin(), best.end());
+            }
+        };
+
+        /* Search shells of cells outward. Anything in shell r is at least (r - 1) cells away, so stop once that
+         * can't beat the k-th best, or once the shell covers every occupied cell */
+        const glm::ivec3 center = _cellCoord(position);
+        for (int r = 0;; r++) {
+            if (best.size() == k && r > 0) {
+                const float bound = (r - 1) * mCellSize;
+                if (bound * bound > best.front().first) {
+                    break;
+                }
+            }
+
+            const glm::ivec3 min = glm::max(center - glm::ivec3(r), mMinCell);
+            const glm::ivec3 max = glm::min(center + glm::ivec3(r), mMaxCell);
+            const double cells = double(max.x - min.x + 1) * double(max.y - min.y + 1) * double(max.z - min.z + 1);
+            if (cells > double(mNumItems)) {
+                /* The shells have grown past the point where probing pays off */
+                best.clear();
+                for (unsigned id = 0; id < mItems.size(); id++) {
+                    if (mItems[id].mLive) {
+                        consider(id);
+                    }
+                }
+                break;
+            }
+
+            auto visit = [&](int x, int y, int z) {
+                auto it = mCells.find(_key(glm::ivec3(x, y, z)));
+                if (it != mCells.end()) {
+                    for (auto id : it->second) {
+                        consider(id);
+                    }
+                }
+            };
+            for (int x = min.x; x <= max.x; x++) {
+                for (int y = min.y; y <= max.y; y++) {
+                    /* Only the shell -- the inside was searched by earlier rings */
+                    if (std::abs(x - center.x) == r || std::abs(y - center.y) == r) {
+                        for (int z = min.z; z <= max.z; z++) {
+                            visit(x, y, z);
+                        }
+                    }
+                    else {
+                        if (center.z - r >= min.z) {
+                            visit(x, y, center.z - r);
+                        }
+                        if (center.z + r <= max.z) {
+                            visit(x, y, center.z + r);
+                        }
+                    }
+                }
+            }
+
+            if (center.x - r <= mMinCell.x && center.y - r <= mMinCell.y && center.z - r <= mMinCell.z &&
+                center.x + r >= mMaxCell.x && center.y + r >= mMaxCell.y && center.z + r >= mMaxCell.z) {
+                break;
+            }
+        }
+
+        std::sort_heap(best.begin(), best.end());
+        for (auto & b : best) {
+            out.emplace_back(b.second, std::sqrt(b.first));
+        }
+    }
+
+}
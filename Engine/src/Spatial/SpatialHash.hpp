@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+
+namespace neo {
+
+    /* Uniform grid over points, hashed so only occupied cells take memory. Items are small caller-chosen ids
+     * (slot indices) and can be moved one at a time -- an update that stays in its cell is just a store, so
+     * it suits scenes where most things move every frame. Pick a cell size around the typical query radius */
+    class SpatialHash {
+
+        public:
+            SpatialHash(float cellSize = 4.f);
+
+            /* Rehashes everything */
+            void setCellSize(float);
+            float getCellSize() const { return mCellSize; }
+
+            void insert(unsigned id, const glm::vec3 & position);
+            void update(unsigned id, const glm::vec3 & position);
+            void remove(unsigned id);
+            void clear();
+
+            /* Appends items within radius of center */
+            void queryRadius(const glm::vec3 & center, float radius, std::vector<unsigned> & out) const;
+            /* Appends items inside [min, max] */
+            void queryAABB(const glm::vec3 & min, const glm::vec3 & max, std::vector<unsigned> & out) const;
+            /* Appends the k items nearest to position with their distances, nearest first */
+            void queryNearest(const glm::vec3 & position, unsigned k, std::vector<std::pair<unsigned, float>> & out) const;
+
+            unsigned getNumItems() const { return mNumItems; }
+            unsigned getNumCells() const { return unsigned(mCells.size()); }
+
+        private:
+            struct Item {
+                glm::vec3 mPosition;
+                uint64_t mCell;
+                /* Index in its cell's list */
+                unsigned mSlot;
+                bool mLive;
+            };
+
+            float mCellSize;
+            float mInvCellSize;
+            std::vector<Item> mItems;
+            unsigned mNumItems;
+            std::unordered_map<uint64_t, std::vector<unsigned>> mCells;
+            /* Bounds of every cell that has been occupied since the last rehash */
+            glm::ivec3 mMinCell, mMaxCell;
+
+            glm::ivec3 _cellCoord(const glm::vec3 &) const;
+            static uint64_t _key(const glm::ivec3 &);
+            void _addToCell(unsigned id, uint64_t key);
+            void _removeFromCell(unsigned id);
+            /* Calls func(id) for every item in the cells overlapping [min, max] -- or every item when that's fewer */
+            template <typename F> void _forEachInRange(const glm::ivec3 & min, const glm::ivec3 & max, F && func) const;
+    };
+
+}
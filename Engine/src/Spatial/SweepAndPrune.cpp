@@ -0,0 +1,325 @@
+#include "SweepAndPrune.hpp"
+
+#include "Util/SIMD.hpp"
+#include "Util/ThreadPool.hpp"
+
+#include "ext/microprofile.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iterator>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace neo {
+
+    namespace {
+        /* Objects each sweep task starts from, and pairs each narrowphase task tests */
+        const unsigned SweepChunk = 1024;
+        const unsigned PairsPerTask = 1024;
+
+        /* Insertion sort gives up and sorts from scratch after this many moves per entry */
+        const size_t MaxShiftsPerObject = 8;
+
+        /* Slabs are this many average half extents tall, and there are never more than MaxSlabs over the
+         * colliders' spread */
+        const float SlabExtents = 8.f;
+        const float MaxSlabs = 4096.f;
+
+        unsigned _lowestBit(unsigned bits) {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, bits);
+            return unsigned(index);
+#else
+            return unsigned(__builtin_ctz(bits));
+#endif
+        }
+
+        uint64_t _key(unsigned a, unsigned b) {
+            return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+        }
+
+        bool _sphereBox(const glm::vec3 & center, float radius, const glm::vec3 & boxCenter, const glm::vec3 axes[3], const glm::vec3 & halfSize) {
+            const glm::vec3 d = center - boxCenter;
+            float dist2 = 0.f;
+            for (int i = 0; i < 3; i++) {
+                const float local = glm::dot(d, axes[i]);
+                const float outside = glm::max(glm::abs(local) - halfSize[i], 0.f);
+                dist2 += outside * outside;
+            }
+            return dist2 <= radius * radius;
+        }
+
+        /* Separating axis test over the 15 axes of two oriented boxes */
+        bool _boxBox(const glm::vec3 & ca, const glm::vec3 a[3], const glm::vec3 & ea, const glm::vec3 & cb, const glm::vec3 b[3], const glm::vec3 & eb) {
+            /* b's axes in a's frame. The epsilon keeps near parallel edges from making a false axis */
+            float R[3][3], absR[3][3];
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    R[i][j] = glm::dot(a[i], b[j]);
+                    absR[i][j] = glm::abs(R[i][j]) + 1e-6f;
+                }
+            }
+            const glm::vec3 d = cb - ca;
+            const float t[3] = { glm::dot(d, a[0]), glm::dot(d, a[1]), glm::dot(d, a[2]) };
+
+            for (int i = 0; i < 3; i++) {
+                if (glm::abs(t[i]) > ea[i] + eb[0] * absR[i][0] + eb[1] * absR[i][1] + eb[2] * absR[i][2]) {
+                    return false;
+                }
+            }
+            for (int j = 0; j < 3; j++) {
+                if (glm::abs(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]) > ea[0] * absR[0][j] + ea[1] * absR[1][j] + ea[2] * absR[2][j] + eb[j]) {
+                    return false;
+                }
+            }
+            /* a[i] x b[j] */
+            for (int i = 0; i < 3; i++) {
+                const int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+                for (int j = 0; j < 3; j++) {
+                    const int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+                    const float ra = ea[i1] * absR[i2][j] + ea[i2] * absR[i1][j];
+                    const float rb = eb[j1] * absR[i][j2] + eb[j2] * absR[i][j1];
+                    if (glm::abs(t[i2] * R[i1][j] - t[i1] * R[i2][j]) > ra + rb) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    }
+
+    void SweepAndPrune::_sort(const std::vector<Collider> & colliders) {
+        MICROPROFILE_SCOPEI("SweepAndPrune", "_sort", MP_AUTO);
+        const unsigned count = unsigned(colliders.size());
+
+        /* Slab along whichever of y and z the colliders are more spread over. The axis only changes when the
+         * other is clearly better, and slabs are only resized when the colliders' size drifts well away from
+         * what they were sized for, so entries keep their slab */
+        glm::vec2 low(FLT_MAX), high(-FLT_MAX);
+        glm::vec2 extents(0.f);
+        for (auto & c : colliders) {
+            const glm::vec2 center(c.mCenter.y, c.mCenter.z);
+            low = glm::min(low, center);
+            high = glm::max(high, center);
+            extents += glm::vec2(c.mExtent.y, c.mExtent.z);
+        }
+        const glm::vec2 spreads = count ? high - low : glm::vec2(0.f);
+        int axis = mSlabAxis ? mSlabAxis : 1;
+        if (spreads[2 - axis] > spreads[axis - 1] * (mSlabAxis ? 1.5f : 1.f)) {
+            axis = 3 - axis;
+        }
+        const float spread = spreads[axis - 1];
+        const float extent = count ? extents[axis - 1] / count : 0.f;
+        if (axis != mSlabAxis || extent > mSlabExtent * 2.f || extent < mSlabExtent * 0.5f) {
+            mSlabAxis = axis;
+            mSlabExtent = extent;
+            mSlabSize = std::max(SlabExtents * extent, spread / MaxSlabs);
+            if (!(mSlabSize > 0.f)) {
+                mSlabSize = 1.f;
+            }
+            mOrder.clear();
+        }
+
+        /* The slabs each collider touches */
+        mSlabs.resize(count);
+        for (unsigned index = 0; index < count; index++) {
+            const Collider & c = colliders[index];
+            auto slab = [this](float x) { return int(glm::clamp(std::floor(x / mSlabSize), -1e9f, 1e9f)); };
+            mSlabs[index] = { slab(c.mCenter[mSlabAxis] - c.mExtent[mSlabAxis]), slab(c.mCenter[mSlabAxis] + c.mExtent[mSlabAxis]) };
+        }
+
+        /* Start from last update's order -- objects only move a little, so it's nearly sorted already. Entries
+         * for slabs a collider has left are dropped, and ones for slabs it has entered go on the end */
+        mSweep.clear();
+        for (auto & entry : mOrder) {
+            const unsigned index = entry.first < mByID.size() ? mByID[entry.first] : ~0u;
+            if (index != ~0u && entry.second >= mSlabs[index].first && entry.second <= mSlabs[index].second) {
+                mSweep.push_back({ entry.second, colliders[index].mCenter.x - colliders[index].mExtent.x, index });
+            }
+        }
+        mLastSlabs.resize(mByID.size(), { 1, 0 });
+        for (unsigned index = 0; index < count; index++) {
+            const std::pair<int, int> & last = mLastSlabs[colliders[index].mID];
+            for (int slab = mSlabs[index].first; slab <= mSlabs[index].second; slab++) {
+                if (mOrder.empty() || slab < last.first || slab > last.second) {
+                    mSweep.push_back({ slab, colliders[index].mCenter.x - colliders[index].mExtent.x, index });
+                }
+            }
+        }
+
+        auto before = [](const Entry & a, const Entry & b) { return a.mSlab < b.mSlab || (a.mSlab == b.mSlab && a.mMinX < b.mMinX); };
+        size_t shifts = 0;
+        const size_t maxShifts = MaxShiftsPerObject * mSweep.size();
+        for (size_t i = 1; i < mSweep.size() && shifts <= maxShifts; i++) {
+            const Entry item = mSweep[i];
+            size_t j = i;
+            for (; j > 0 && before(item, mSweep[j - 1]); j--) {
+                mSweep[j] = mSweep[j - 1];
+            }
+            mSweep[j] = item;
+            shifts += i - j;
+        }
+        if (shifts > maxShifts) {
+            std::sort(mSweep.begin(), mSweep.end(), before);
+        }
+
+        mOrder.resize(mSweep.size());
+        for (size_t i = 0; i < mSweep.size(); i++) {
+            mOrder[i] = { colliders[mSweep[i].mIndex].mID, mSweep[i].mSlab };
+        }
+        std::fill(mLastSlabs.begin(), mLastSlabs.end(), std::pair<int, int>(1, 0));
+        for (unsigned index = 0; index < count; index++) {
+            mLastSlabs[colliders[index].mID] = mSlabs[index];
+        }
+    }
+
+    void SweepAndPrune::_sweep(const std::vector<Collider> & colliders) {
+        MICROPROFILE_SCOPEI("SweepAndPrune", "_sweep", MP_AUTO);
+
+        /* SoA in sweep order, a batch of padding after each slab. Padding starts past every box, so a sweep
+         * always stops inside it */
+        mRows.clear();
+        for (size_t i = 0; i < mSweep.size(); i++) {
+            mRows.push_back(unsigned(i));
+            if (i + 1 == mSweep.size() || mSweep[i + 1].mSlab != mSweep[i].mSlab) {
+                mRows.insert(mRows.end(), simd::Width, ~0u);
+            }
+        }
+        const unsigned count = unsigned(mRows.size());
+        for (auto row : { &mMinX, &mMaxX, &mMinY, &mMaxY, &mMinZ, &mMaxZ }) {
+            row->resize(count);
+        }
+        for (unsigned i = 0; i < count; i++) {
+            if (mRows[i] == ~0u) {
+                mMinX[i] = FLT_MAX;
+                mMaxX[i] = -FLT_MAX;
+                mMinY[i] = mMaxY[i] = mMinZ[i] = mMaxZ[i] = 0.f;
+                continue;
+            }
+            const Entry & entry = mSweep[mRows[i]];
+            const Collider & c = colliders[entry.mIndex];
+            mMinX[i] = entry.mMinX;
+            mMaxX[i] = c.mCenter.x + c.mExtent.x;
+            mMinY[i] = c.mCenter.y - c.mExtent.y;
+            mMaxY[i] = c.mCenter.y + c.mExtent.y;
+            mMinZ[i] = c.mCenter.z - c.mExtent.z;
+            mMaxZ[i] = c.mCenter.z + c.mExtent.z;
+        }
+
+        const unsigned chunks = (count + SweepChunk - 1) / SweepChunk;
+        mCandidates.resize(chunks);
+        ThreadPool::parallelFor(chunks, 1, [&](unsigned begin, unsigned end) {
+            const unsigned allLanes = (1u << simd::Width) - 1;
+            for (unsigned chunk = begin; chunk < end; chunk++) {
+                auto & candidates = mCandidates[chunk];
+                candidates.clear();
+                const unsigned last = std::min(count, (chunk + 1) * SweepChunk);
+                for (unsigned i = chunk * SweepChunk; i < last; i++) {
+                    if (mRows[i] == ~0u) {
+                        continue;
+                    }
+                    const simd::vfloat maxX = simd::set1(mMaxX[i]);
+                    const simd::vfloat minY = simd::set1(mMinY[i]), maxY = simd::set1(mMaxY[i]);
+                    const simd::vfloat minZ = simd::set1(mMinZ[i]), maxZ = simd::set1(mMaxZ[i]);
+
+                    /* Everything that starts before this box ends overlaps it in x -- the rest only need y and z */
+                    for (unsigned j = i + 1;; j += simd::Width) {
+                        const unsigned inRange = unsigned(simd::movemask(simd::load(&mMinX[j]) <= maxX));
+                        if (!inRange) {
+                            break;
+                        }
+                        const simd::vfloat overlap =
+                            (simd::load(&mMinY[j]) <= maxY) & (simd::load(&mMaxY[j]) >= minY) &
+                            (simd::load(&mMinZ[j]) <= maxZ) & (simd::load(&mMaxZ[j]) >= minZ);
+                        for (unsigned bits = inRange & unsigned(simd::movemask(overlap)); bits; bits &= bits - 1) {
+                            /* Pairs sharing several slabs are only kept in the first one they share */
+                            const Entry & a = mSweep[mRows[i]];
+                            const Entry & b = mSweep[mRows[j + _lowestBit(bits)]];
+                            if (a.mSlab == std::max(mSlabs[a.mIndex].first, mSlabs[b.mIndex].first)) {
+                                candidates.emplace_back(a.mIndex, b.mIndex);
+                            }
+                        }
+                        /* Sorted by min x, so nothing past the first box out of range can be in range */
+                        if (inRange != allLanes) {
+                            break;
+                        }
+                    }
+                }
+            }
+        });
+
+        mPairs.clear();
+        for (auto & candidates : mCandidates) {
+            mPairs.insert(mPairs.end(), candidates.begin(), candidates.end());
+        }
+    }
+
+    bool SweepAndPrune::_touching(const Collider & a, const Collider & b) {
+        if (a.mShape == Shape::Sphere && b.mShape == Shape::Sphere) {
+            const glm::vec3 d = a.mCenter - b.mCenter;
+            const float r = a.mRadius + b.mRadius;
+            return glm::dot(d, d) <= r * r;
+        }
+        if (a.mShape == Shape::Sphere) {
+            return _sphereBox(a.mCenter, a.mRadius, b.mCenter, b.mAxes, b.mHalfSize);
+        }
+        if (b.mShape == Shape::Sphere) {
+            return _sphereBox(b.mCenter, b.mRadius, a.mCenter, a.mAxes, a.mHalfSize);
+        }
+        /* The broadphase already found the world boxes overlapping */
+        if (a.mShape == Shape::AABB && b.mShape == Shape::AABB) {
+            return true;
+        }
+        return _boxBox(a.mCenter, a.mAxes, a.mHalfSize, b.mCenter, b.mAxes, b.mHalfSize);
+    }
+
+    void SweepAndPrune::_narrowphase(const std::vector<Collider> & colliders) {
+        MICROPROFILE_SCOPEI("SweepAndPrune", "_narrowphase", MP_AUTO);
+        mTouching.assign(mPairs.size(), 0);
+        ThreadPool::parallelFor(unsigned(mPairs.size()), PairsPerTask, [&](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end; i++) {
+                mTouching[i] = _touching(colliders[mPairs[i].first], colliders[mPairs[i].second]);
+            }
+        });
+    }
+
+    void SweepAndPrune::_updateContacts(const std::vector<Collider> & colliders) {
+        MICROPROFILE_SCOPEI("SweepAndPrune", "_updateContacts", MP_AUTO);
+        mLastContactKeys.swap(mContactKeys);
+        mContactKeys.clear();
+        for (size_t i = 0; i < mPairs.size(); i++) {
+            if (mTouching[i]) {
+                mContactKeys.push_back(_key(colliders[mPairs[i].first].mID, colliders[mPairs[i].second].mID));
+            }
+        }
+        std::sort(mContactKeys.begin(), mContactKeys.end());
+
+        /* Keys only in the new list entered, keys only in the old one exited */
+        mEntered.clear();
+        mExited.clear();
+        std::set_difference(mContactKeys.begin(), mContactKeys.end(), mLastContactKeys.begin(), mLastContactKeys.end(), std::back_inserter(mEntered));
+        std::set_difference(mLastContactKeys.begin(), mLastContactKeys.end(), mContactKeys.begin(), mContactKeys.end(), std::back_inserter(mExited));
+    }
+
+    void SweepAndPrune::update(const std::vector<Collider> & colliders) {
+        MICROPROFILE_SCOPEI("SweepAndPrune", "update", MP_AUTO);
+        std::fill(mByID.begin(), mByID.end(), ~0u);
+        for (unsigned i = 0; i < colliders.size(); i++) {
+            const unsigned id = colliders[i].mID;
+            if (id >= mByID.size()) {
+                mByID.resize(std::max(size_t(id) + 1, mByID.size() * 2), ~0u);
+            }
+            mByID[id] = i;
+        }
+
+        _sort(colliders);
+        _sweep(colliders);
+        _narrowphase(colliders);
+        _updateContacts(colliders);
+    }
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace neo {
+
+    /* Finds touching pairs in a set of colliders, and keeps them between updates so it can say which pairs
+     * started or stopped touching. Sweep and prune along x over world AABBs, split into slabs along y or z so
+     * a crowd doesn't put hundreds of boxes in every box's x range. A collider is swept in each slab it
+     * touches. The sweep order is kept between updates so sorting starts nearly sorted, and each collider's
+     * sweep tests the boxes that follow it a SIMD batch at a time. Candidate pairs are then tested against
+     * their shapes in parallel. Colliders are named by unique caller-chosen ids, like GameObject IDs, which
+     * should stay small */
+    class SweepAndPrune {
+
+        public:
+            enum class Shape {
+                AABB,
+                Sphere,
+                OBB
+            };
+
+            struct Collider {
+                unsigned mID;
+                Shape mShape;
+                /* World AABB -- for spheres, the box around the sphere */
+                glm::vec3 mCenter;
+                glm::vec3 mExtent;
+                float mRadius;
+                /* Oriented box, for OBB colliders */
+                glm::vec3 mAxes[3];
+                glm::vec3 mHalfSize;
+            };
+
+            /* Replaces the colliders and finds what touches */
+            void update(const std::vector<Collider> &);
+
+            /* Touching pairs as (lower id << 32 | higher id), sorted */
+            const std::vector<uint64_t> & getContacts() const { return mContactKeys; }
+            /* Pairs that started and stopped touching in the last update, same form. A pair can exit because
+             * one of its colliders is gone */
+            const std::vector<uint64_t> & getEntered() const { return mEntered; }
+            const std::vector<uint64_t> & getExited() const { return mExited; }
+            size_t getNumCandidates() const { return mPairs.size(); }
+
+        private:
+            /* Collider by id, or ~0u */
+            std::vector<unsigned> mByID;
+
+            /* A collider's place in one slab */
+            struct Entry {
+                int mSlab;
+                float mMinX;
+                unsigned mIndex;
+            };
+
+            /* Slabs are along y (1) or z (2) */
+            int mSlabAxis = 0;
+            float mSlabSize = 1.f;
+            /* Average half extent the slabs were sized for */
+            float mSlabExtent = 0.f;
+            /* First and last slab of each collider, and of each id as of the last update */
+            std::vector<std::pair<int, int>> mSlabs;
+            std::vector<std::pair<int, int>> mLastSlabs;
+            /* (id, slab) in the last update's sweep order */
+            std::vector<std::pair<unsigned, int>> mOrder;
+
+            /* Entries by slab then min x, and the endpoints in that order -- each slab followed by padding that
+             * never overlaps. Rows hold the entry at each endpoint, or ~0u for padding */
+            std::vector<Entry> mSweep;
+            std::vector<unsigned> mRows;
+            std::vector<float> mMinX, mMaxX, mMinY, mMaxY, mMinZ, mMaxZ;
+
+            /* Candidate pairs by sweep chunk, so the tasks never share a list */
+            std::vector<std::vector<std::pair<unsigned, unsigned>>> mCandidates;
+            std::vector<std::pair<unsigned, unsigned>> mPairs;
+            std::vector<uint8_t> mTouching;
+
+            std::vector<uint64_t> mContactKeys;
+            std::vector<uint64_t> mLastContactKeys;
+            std::vector<uint64_t> mEntered;
+            std::vector<uint64_t> mExited;
+
+            void _sort(const std::vector<Collider> &);
+            void _sweep(const std::vector<Collider> &);
+            void _narrowphase(const std::vector<Collider> &);
+            void _updateContacts(const std::vector<Collider> &);
+
+            static bool _touching(const Collider &, const Collider &);
+    };
+}
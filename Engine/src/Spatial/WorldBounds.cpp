@@ -0,0 +1,130 @@
+#include "WorldBounds.hpp"
+
+#include "ECS/GameObject.hpp"
+#include "ECS/Component/CollisionComponent/BoundingBoxComponent.hpp"
+#include "ECS/Component/SpatialComponent/SpatialComponent.hpp"
+
+#include "Util/SIMD.hpp"
+#include "Util/Counters.hpp"
+
+#include "ext/microprofile.h"
+
+#include <algorithm>
+
+namespace neo {
+
+    std::vector<float> WorldBounds::mRows;
+    unsigned WorldBounds::mCapacity = 0;
+    std::vector<float> WorldBounds::mScratch;
+
+    namespace {
+        const unsigned GroupSize = 64;
+
+        /* Scratch rows -- the model matrix's columns and the local box going in, the world bounds coming out */
+        enum ScratchRow {
+            M0X, M0Y, M0Z,
+            M1X, M1Y, M1Z,
+            M2X, M2Y, M2Z,
+            M3X, M3Y, M3Z,
+            LocalCenterX, LocalCenterY, LocalCenterZ,
+            LocalExtentX, LocalExtentY, LocalExtentZ,
+            OutCenterX, OutCenterY, OutCenterZ,
+            OutExtentX, OutExtentY, OutExtentZ,
+            OutRadius,
+            NumScratchRows
+        };
+
+        unsigned _counter() {
+            static const unsigned counter = Counters::add("Scene BVH", "Bounds updated");
+            return counter;
+        }
+    }
+
+    void WorldBounds::reserve(unsigned slots) {
+        if (slots <= mCapacity) {
+            return;
+        }
+
+        /* Rows are mCapacity apart, so growing moves everything */
+        const unsigned capacity = std::max((slots + GroupSize - 1) / GroupSize * GroupSize, mCapacity * 2);
+        std::vector<float> rows(NumRows * capacity, 0.f);
+        for (unsigned row = 0; row < NumRows; row++) {
+            std::copy(mRows.begin() + row * mCapacity, mRows.begin() + (row + 1) * mCapacity, rows.begin() + row * capacity);
+        }
+        mRows.swap(rows);
+        mCapacity = capacity;
+    }
+
+    void WorldBounds::clear(unsigned slot) {
+        for (unsigned row = 0; row < NumRows; row++) {
+            mRows[row * mCapacity + slot] = 0.f;
+        }
+    }
+
+    void WorldBounds::update(const std::vector<unsigned> & slots, const std::vector<const BoundingBoxComponent *> & boxes) {
+        MICROPROFILE_SCOPEI("WorldBounds", "update", MP_AUTO);
+        const unsigned count = unsigned(slots.size());
+        if (!count) {
+            return;
+        }
+        const unsigned stride = (count + simd::Width - 1) / simd::Width * simd::Width;
+        mScratch.assign(NumScratchRows * stride, 0.f);
+        auto scratch = [&](ScratchRow row) { return &mScratch[row * stride]; };
+
+        /* Gather on this thread -- model matrices are computed lazily */
+        for (unsigned i = 0; i < count; i++) {
+            const BoundingBoxComponent & box = *boxes[i];
+            const auto spatial = box.getGameObject().getComponentByType<SpatialComponent>();
+            const glm::mat4 M = spatial ? spatial->getModelMatrix() : glm::mat4(1.f);
+            for (int column = 0; column < 4; column++) {
+                for (int axis = 0; axis < 3; axis++) {
+                    scratch(ScratchRow(M0X + column * 3 + axis))[i] = M[column][axis];
+                }
+            }
+            const glm::vec3 center = (box.mMin + box.mMax) * 0.5f;
+            const glm::vec3 extent = (box.mMax - box.mMin) * 0.5f;
+            for (int axis = 0; axis < 3; axis++) {
+                scratch(ScratchRow(LocalCenterX + axis))[i] = center[axis];
+                scratch(ScratchRow(LocalExtentX + axis))[i] = extent[axis];
+            }
+        }
+
+        for (unsigned i = 0; i < stride; i += simd::Width) {
+            simd::vfloat M[4][3];
+            for (int column = 0; column < 4; column++) {
+                for (int axis = 0; axis < 3; axis++) {
+                    M[column][axis] = simd::load(scratch(ScratchRow(M0X + column * 3 + axis)) + i);
+                }
+            }
+            const simd::vfloat localCenter[3] = { simd::load(scratch(LocalCenterX) + i), simd::load(scratch(LocalCenterY) + i), simd::load(scratch(LocalCenterZ) + i) };
+            const simd::vfloat localExtent[3] = { simd::load(scratch(LocalExtentX) + i), simd::load(scratch(LocalExtentY) + i), simd::load(scratch(LocalExtentZ) + i) };
+
+            /* Transform the center, and take the extents through the absolute value of the rotation and scale */
+            simd::vfloat extent[3];
+            for (int axis = 0; axis < 3; axis++) {
+                const simd::vfloat center = M[0][axis] * localCenter[0] + M[1][axis] * localCenter[1] + M[2][axis] * localCenter[2] + M[3][axis];
+                extent[axis] = simd::abs(M[0][axis]) * localExtent[0] + simd::abs(M[1][axis]) * localExtent[1] + simd::abs(M[2][axis]) * localExtent[2];
+                simd::store(scratch(ScratchRow(OutCenterX + axis)) + i, center);
+                simd::store(scratch(ScratchRow(OutExtentX + axis)) + i, extent[axis]);
+            }
+
+            /* The sphere around the local box, scaled by the largest axis -- model matrices only rotate and scale,
+             * so no direction stretches further. Unless the world box's own sphere is smaller */
+            simd::vfloat maxScale2 = simd::set1(0.f);
+            for (int column = 0; column < 3; column++) {
+                maxScale2 = simd::max(maxScale2, M[column][0] * M[column][0] + M[column][1] * M[column][1] + M[column][2] * M[column][2]);
+            }
+            const simd::vfloat localRadius2 = localExtent[0] * localExtent[0] + localExtent[1] * localExtent[1] + localExtent[2] * localExtent[2];
+            const simd::vfloat worldRadius2 = extent[0] * extent[0] + extent[1] * extent[1] + extent[2] * extent[2];
+            simd::store(scratch(OutRadius) + i, simd::sqrt(simd::min(localRadius2 * maxScale2, worldRadius2)));
+        }
+
+        for (unsigned i = 0; i < count; i++) {
+            for (unsigned row = 0; row < NumRows; row++) {
+                mRows[row * mCapacity + slots[i]] = scratch(ScratchRow(OutCenterX + row))[i];
+            }
+        }
+        Counters::increment(_counter(), count);
+    }
+
+}
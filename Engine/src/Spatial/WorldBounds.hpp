@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace neo {
+
+    class BoundingBoxComponent;
+
+    /* World space bounds of every BoundingBoxComponent, kept in SoA by SceneBVH slot -- an AABB as center and
+     * extents, and a bounding sphere around the same center. SceneBVH recomputes a slot only when its transform
+     * or local bounds change, a batch at a time with SIMD. Culling, picking and the trees all read from here,
+     * so nothing else has to transform boxes or invert model matrices.
+     *
+     * Rows are padded to whole groups of 64 slots, and free slots hold empty bounds at the origin, so SIMD
+     * passes can run over every slot below getCapacity(). Main thread only */
+    class WorldBounds {
+
+        public:
+            enum Row {
+                CenterX, CenterY, CenterZ,
+                ExtentX, ExtentY, ExtentZ,
+                Radius,
+                NumRows
+            };
+
+            /* Used by SceneBVH */
+            static void reserve(unsigned slots);
+            static void update(const std::vector<unsigned> & slots, const std::vector<const BoundingBoxComponent *> & boxes);
+            static void clear(unsigned slot);
+
+            /* getCapacity() floats, moved whenever the capacity grows */
+            static const float * getRow(Row row) { return mRows.data() + row * mCapacity; }
+            static unsigned getCapacity() { return mCapacity; }
+
+            static glm::vec3 getCenter(unsigned slot) { return glm::vec3(_get(CenterX, slot), _get(CenterY, slot), _get(CenterZ, slot)); }
+            static glm::vec3 getExtent(unsigned slot) { return glm::vec3(_get(ExtentX, slot), _get(ExtentY, slot), _get(ExtentZ, slot)); }
+            static glm::vec3 getMin(unsigned slot) { return getCenter(slot) - getExtent(slot); }
+            static glm::vec3 getMax(unsigned slot) { return getCenter(slot) + getExtent(slot); }
+            static float getRadius(unsigned slot) { return _get(Radius, slot); }
+
+        private:
+            static std::vector<float> mRows;
+            static unsigned mCapacity;
+
+            /* Transforms and local bounds gathered for update, by row */
+            static std::vector<float> mScratch;
+
+            static float _get(Row row, unsigned slot) { return mRows[row * mCapacity + slot]; }
+    };
+
+}
@@ -0,0 +1,129 @@
+#include "Counters.hpp"
+
+#include "ext/imgui/imgui.h"
+
+#include <fstream>
+#include <cfloat>
+
+namespace neo {
+
+    std::vector<uint64_t> Counters::mValues(Counters::BuiltInCount, 0);
+    std::vector<Counters::CounterInfo> Counters::mInfo = {
+        { "Renderer", "Draw calls",            std::vector<uint64_t>(Counters::HistorySize, 0) },
+        { "Renderer", "Triangles",             std::vector<uint64_t>(Counters::HistorySize, 0) },
+        { "Renderer", "Uniform uploads",       std::vector<uint64_t>(Counters::HistorySize, 0) },
+        { "Renderer", "Texture binds",         std::vector<uint64_t>(Counters::HistorySize, 0) },
+        { "Renderer", "Buffer bytes uploaded", std::vector<uint64_t>(Counters::HistorySize, 0) },
+        { "Renderer", "FBO switches",          std::vector<uint64_t>(Counters::HistorySize, 0) },
+        { "Messenger", "Messages sent",        std::vector<uint64_t>(Counters::HistorySize, 0) },
+        { "Messenger", "Messages relayed",     std::vector<uint64_t>(Counters::HistorySize, 0) },
+        { "ECS", "Queries executed",           std::vector<uint64_t>(Counters::HistorySize, 0) },
+        { "ECS", "Query matches",              std::vector<uint64_t>(Counters::HistorySize, 0) },
+    };
+    unsigned Counters::mHistoryHead = 0;
+    unsigned Counters::mFramesRecorded = 0;
+
+    unsigned Counters::add(const std::string & group, const std::string & name) {
+        for (unsigned i = 0; i < mInfo.size(); i++) {
+            if (mInfo[i].mGroup == group && mInfo[i].mName == name) {
+                return i;
+            }
+        }
+
+        mInfo.push_back({ group, name, std::vector<uint64_t>(HistorySize, 0) });
+        mValues.push_back(0);
+        return unsigned(mValues.size() - 1);
+    }
+
+    void Counters::newFrame() {
+        for (unsigned i = 0; i < mValues.size(); i++) {
+            mInfo[i].mHistory[mHistoryHead] = mValues[i];
+            mValues[i] = 0;
+        }
+        mHistoryHead = (mHistoryHead + 1) % HistorySize;
+        if (mFramesRecorded < HistorySize) {
+            mFramesRecorded++;
+        }
+    }
+
+    uint64_t Counters::getLastFrame(unsigned counter) {
+        return mInfo[counter].mHistory[(mHistoryHead + HistorySize - 1) % HistorySize];
+    }
+
+    double Counters::getAverage(unsigned counter) {
+        if (!mFramesRecorded) {
+            return 0.0;
+        }
+
+        /* Slots that haven't been written yet are still 0 */
+        uint64_t total = 0;
+        for (auto value : mInfo[counter].mHistory) {
+            total += value;
+        }
+        return double(total) / mFramesRecorded;
+    }
+
+    bool Counters::exportCSV(const std::string & file) {
+        std::ofstream out(file);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        out << "frame";
+        for (auto & info : mInfo) {
+            out << ",\"" << info.mGroup << "/" << info.mName << "\"";
+        }
+        out << "\n";
+
+        const unsigned first = (mHistoryHead + HistorySize - mFramesRecorded) % HistorySize;
+        for (unsigned frame = 0; frame < mFramesRecorded; frame++) {
+            out << frame;
+            for (auto & info : mInfo) {
+                out << "," << info.mHistory[(first + frame) % HistorySize];
+            }
+            out << "\n";
+        }
+        return true;
+    }
+
+    void Counters::imguiEditor() {
+        if (ImGui::Button("Export counters")) {
+            exportCSV("counters.csv");
+        }
+
+        /* Groups in the order they were registered */
+        std::vector<const std::string *> groups;
+        for (auto & info : mInfo) {
+            bool found = false;
+            for (auto group : groups) {
+                found |= *group == info.mGroup;
+            }
+            if (!found) {
+                groups.push_back(&info.mGroup);
+            }
+        }
+
+        std::vector<float> plot(mFramesRecorded);
+        const unsigned first = (mHistoryHead + HistorySize - mFramesRecorded) % HistorySize;
+        for (auto group : groups) {
+            if (!ImGui::TreeNodeEx(group->c_str(), ImGuiTreeNodeFlags_DefaultOpen)) {
+                continue;
+            }
+            for (unsigned i = 0; i < mInfo.size(); i++) {
+                if (mInfo[i].mGroup != *group) {
+                    continue;
+                }
+                ImGui::Text("%s: %llu (avg %0.1f)", mInfo[i].mName.c_str(), (unsigned long long)getLastFrame(i), getAverage(i));
+                if (ImGui::IsItemHovered() && mFramesRecorded) {
+                    for (unsigned frame = 0; frame < mFramesRecorded; frame++) {
+                        plot[frame] = float(mInfo[i].mHistory[(first + frame) % HistorySize]);
+                    }
+                    ImGui::BeginTooltip();
+                    ImGui::PlotLines("", plot.data(), int(plot.size()), 0, mInfo[i].mName.c_str(), 0.f, FLT_MAX, ImVec2(400.f, 100.f));
+                    ImGui::EndTooltip();
+                }
+            }
+            ImGui::TreePop();
+        }
+    }
+}
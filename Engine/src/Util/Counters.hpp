@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace neo {
+
+    /* Per-frame counters for the work that drives frame cost. Counters are registered once and bumped by
+     * index, so counting is a single add. Main thread only -- workers should count locally and hand the
+     * totals to the main thread */
+    struct Counters {
+
+        /* Built-in counters, always registered */
+        enum Counter : unsigned {
+            DrawCalls,
+            Triangles,
+            UniformUploads,
+            TextureBinds,
+            BufferBytesUploaded,
+            FBOSwitches,
+            MessagesSent,
+            MessagesRelayed,
+            QueriesExecuted,
+            QueryMatches,
+            BuiltInCount
+        };
+
+        /* Number of frames of history kept for every counter */
+        static const unsigned HistorySize = 128;
+
+        /* Registers a counter and returns its index. Registering the same group and name twice returns the same index */
+        static unsigned add(const std::string & group, const std::string & name);
+
+        static void increment(unsigned counter, uint64_t amount = 1) {
+            mValues[counter] += amount;
+        }
+
+        /* Moves the running values into history. Called once at the end of every frame */
+        static void newFrame();
+
+        /* Value of the last completed frame, and the average over the history */
+        static uint64_t getLastFrame(unsigned counter);
+        static double getAverage(unsigned counter);
+
+        static unsigned getNumCounters() { return unsigned(mValues.size()); }
+        static const std::string & getGroup(unsigned counter) { return mInfo[counter].mGroup; }
+        static const std::string & getName(unsigned counter) { return mInfo[counter].mName; }
+
+        /* Writes the history as CSV -- one row per frame, one column per counter, oldest frame first */
+        static bool exportCSV(const std::string & file);
+
+        static void imguiEditor();
+
+        private:
+            struct CounterInfo {
+                std::string mGroup;
+                std::string mName;
+                std::vector<uint64_t> mHistory;
+            };
+
+            static std::vector<uint64_t> mValues;
+            static std::vector<CounterInfo> mInfo;
+            /* Next history slot to be written */
+            static unsigned mHistoryHead;
+            static unsigned mFramesRecorded;
+    };
+}
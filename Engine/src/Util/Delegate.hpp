@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace neo {
+
+    template <typename Signature> class Delegate;
+
+    /* Move-only callable like std::function, but the callable always lives inline -- never on the heap.
+     * Anything bigger than Capacity is a compile error, so capture pointers rather than containers */
+    template <typename R, typename... Args>
+    class Delegate<R(Args...)> {
+
+        public:
+            static constexpr std::size_t Capacity = 4 * sizeof(void *);
+
+            Delegate() = default;
+
+            template <typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Delegate>::value>>
+            Delegate(F && func) {
+                using FuncT = std::decay_t<F>;
+                static_assert(sizeof(FuncT) <= Capacity, "Callable is too large for a Delegate");
+                static_assert(alignof(FuncT) <= alignof(std::max_align_t), "Callable is over-aligned for a Delegate");
+                static_assert(std::is_nothrow_move_constructible<FuncT>::value, "Callable must be nothrow movable");
+
+                new (mStorage) FuncT(std::forward<F>(func));
+                mInvoke = [](void * storage, Args... args) -> R {
+                    return (*static_cast<FuncT *>(storage))(std::forward<Args>(args)...);
+                };
+                mManage = [](void * dst, void * src) {
+                    if (dst) {
+                        new (dst) FuncT(std::move(*static_cast<FuncT *>(src)));
+                    }
+                    static_cast<FuncT *>(src)->~FuncT();
+                };
+            }
+
+            Delegate(Delegate && other) noexcept {
+                _take(other);
+            }
+
+            Delegate & operator=(Delegate && other) noexcept {
+                if (this != &other) {
+                    reset();
+                    _take(other);
+                }
+                return *this;
+            }
+
+            Delegate(const Delegate &) = delete;
+            Delegate & operator=(const Delegate &) = delete;
+
+            ~Delegate() {
+                reset();
+            }
+
+            void reset() {
+                if (mManage) {
+                    mManage(nullptr, mStorage);
+                }
+                mInvoke = nullptr;
+                mManage = nullptr;
+            }
+
+            explicit operator bool() const { return mInvoke != nullptr; }
+
+            R operator()(Args... args) const {
+                return mInvoke(const_cast<unsigned char *>(mStorage), std::forward<Args>(args)...);
+            }
+
+        private:
+            void _take(Delegate & other) {
+                if (other.mManage) {
+                    other.mManage(mStorage, other.mStorage);
+                }
+                mInvoke = other.mInvoke;
+                mManage = other.mManage;
+                other.mInvoke = nullptr;
+                other.mManage = nullptr;
+            }
+
+            alignas(std::max_align_t) unsigned char mStorage[Capacity];
+            R(*mInvoke)(void *, Args...) = nullptr;
+            /* Moves the callable into dst if it's not null, then destroys the source */
+            void(*mManage)(void *, void *) = nullptr;
+    };
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <immintrin.h>
+
+// Thin wrappers over SSE / AVX so batched passes are written once. The lane
+// width follows the compiler flags -- AVX builds (/arch:AVX2) get 8 lanes,
+// everything else gets 4 SSE2 lanes. Data passed to load/store doesn't need
+// to be aligned. Masks are vfloats with all bits set in the true lanes.
+
+namespace neo {
+namespace simd {
+
+#if defined(__AVX__)
+
+    static constexpr int Width = 8;
+
+    struct vfloat { __m256 v; };
+
+    inline vfloat load(const float * p) { return { _mm256_loadu_ps(p) }; }
+    inline void store(float * p, vfloat a) { _mm256_storeu_ps(p, a.v); }
+    inline vfloat set1(float f) { return { _mm256_set1_ps(f) }; }
+
+    inline vfloat operator+(vfloat a, vfloat b) { return { _mm256_add_ps(a.v, b.v) }; }
+    inline vfloat operator-(vfloat a, vfloat b) { return { _mm256_sub_ps(a.v, b.v) }; }
+    inline vfloat operator*(vfloat a, vfloat b) { return { _mm256_mul_ps(a.v, b.v) }; }
+    inline vfloat operator/(vfloat a, vfloat b) { return { _mm256_div_ps(a.v, b.v) }; }
+    inline vfloat min(vfloat a, vfloat b) { return { _mm256_min_ps(a.v, b.v) }; }
+    inline vfloat max(vfloat a, vfloat b) { return { _mm256_max_ps(a.v, b.v) }; }
+    inline vfloat sqrt(vfloat a) { return { _mm256_sqrt_ps(a.v) }; }
+
+    inline vfloat operator==(vfloat a, vfloat b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ) }; }
+    inline vfloat operator<(vfloat a, vfloat b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+    inline vfloat operator<=(vfloat a, vfloat b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+    inline vfloat operator>(vfloat a, vfloat b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+    inline vfloat operator>=(vfloat a, vfloat b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+    inline vfloat operator&(vfloat a, vfloat b) { return { _mm256_and_ps(a.v, b.v) }; }
+    inline vfloat operator|(vfloat a, vfloat b) { return { _mm256_or_ps(a.v, b.v) }; }
+
+    /* mask ? a : b */
+    inline vfloat select(vfloat mask, vfloat a, vfloat b) { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+    /* One bit per lane */
+    inline int movemask(vfloat mask) { return _mm256_movemask_ps(mask.v); }
+    /* To the nearest integer */
+    inline vfloat round(vfloat a) { return { _mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+
+#else
+
+    static constexpr int Width = 4;
+
+    struct vfloat { __m128 v; };
+
+    inline vfloat load(const float * p) { return { _mm_loadu_ps(p) }; }
+    inline void store(float * p, vfloat a) { _mm_storeu_ps(p, a.v); }
+    inline vfloat set1(float f) { return { _mm_set1_ps(f) }; }
+
+    inline vfloat operator+(vfloat a, vfloat b) { return { _mm_add_ps(a.v, b.v) }; }
+    inline vfloat operator-(vfloat a, vfloat b) { return { _mm_sub_ps(a.v, b.v) }; }
+    inline vfloat operator*(vfloat a, vfloat b) { return { _mm_mul_ps(a.v, b.v) }; }
+    inline vfloat operator/(vfloat a, vfloat b) { return { _mm_div_ps(a.v, b.v) }; }
+    inline vfloat min(vfloat a, vfloat b) { return { _mm_min_ps(a.v, b.v) }; }
+    inline vfloat max(vfloat a, vfloat b) { return { _mm_max_ps(a.v, b.v) }; }
+    inline vfloat sqrt(vfloat a) { return { _mm_sqrt_ps(a.v) }; }
+
+    inline vfloat operator==(vfloat a, vfloat b) { return { _mm_cmpeq_ps(a.v, b.v) }; }
+    inline vfloat operator<(vfloat a, vfloat b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+    inline vfloat operator<=(vfloat a, vfloat b) { return { _mm_cmple_ps(a.v, b.v) }; }
+    inline vfloat operator>(vfloat a, vfloat b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+    inline vfloat operator>=(vfloat a, vfloat b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+    inline vfloat operator&(vfloat a, vfloat b) { return { _mm_and_ps(a.v, b.v) }; }
+    inline vfloat operator|(vfloat a, vfloat b) { return { _mm_or_ps(a.v, b.v) }; }
+
+    /* mask ? a : b -- SSE2 has no blend */
+    inline vfloat select(vfloat mask, vfloat a, vfloat b) { return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) }; }
+    /* One bit per lane */
+    inline int movemask(vfloat mask) { return _mm_movemask_ps(mask.v); }
+    /* To the nearest integer, through int32 -- SSE2 has no round */
+    inline vfloat round(vfloat a) { return { _mm_cvtepi32_ps(_mm_cvtps_epi32(a.v)) }; }
+
+#endif
+
+    inline vfloat operator-(vfloat a) { return set1(0.f) - a; }
+    inline vfloat abs(vfloat a) { return max(a, -a); }
+
+    /* Sine and cosine together, within a few 1e-7 for |x| up to ten thousand or so. Reduces by pi/2 in three parts,
+     * then swaps and negates the polynomials by quadrant */
+    inline void sincos(vfloat x, vfloat & s, vfloat & c) {
+        const vfloat q = round(x * set1(0.63661977236f));
+        const vfloat r = ((x - q * set1(1.5703125f)) - q * set1(4.837512969970703125e-4f)) - q * set1(7.54978995489188216e-8f);
+        const vfloat z = r * r;
+        const vfloat sinR = r + r * z * ((set1(-1.9515295891e-4f) * z + set1(8.3321608736e-3f)) * z + set1(-1.6666654611e-1f));
+        const vfloat cosR = set1(1.f) - set1(0.5f) * z + z * z * ((set1(2.443315711809948e-5f) * z + set1(-1.388731625493765e-3f)) * z + set1(4.166664568298827e-2f));
+
+        /* Quadrant as q mod 4, kept in floats */
+        vfloat quadrant = q - set1(4.f) * round(q * set1(0.25f));
+        quadrant = select(quadrant < set1(0.f), quadrant + set1(4.f), quadrant);
+        const vfloat odd = (quadrant == set1(1.f)) | (quadrant == set1(3.f));
+        const vfloat sinNegative = quadrant >= set1(2.f);
+        const vfloat cosNegative = (quadrant == set1(1.f)) | (quadrant == set1(2.f));
+        const vfloat sinQ = select(odd, cosR, sinR);
+        const vfloat cosQ = select(odd, sinR, cosR);
+        s = select(sinNegative, -sinQ, sinQ);
+        c = select(cosNegative, -cosQ, cosQ);
+    }
+
+}
+}
@@ -0,0 +1,129 @@
+#include "ThreadPool.hpp"
+
+#include "ext/microprofile.h"
+
+#include <algorithm>
+#include <string>
+
+namespace neo {
+
+    std::vector<std::thread> ThreadPool::mWorkers;
+    std::mutex ThreadPool::mMutex;
+    std::condition_variable ThreadPool::mWake;
+    std::condition_variable ThreadPool::mDone;
+    std::atomic<bool> ThreadPool::mRunning(false);
+    bool ThreadPool::mQuit = false;
+    const std::function<void(unsigned, unsigned)> * ThreadPool::mTask = nullptr;
+    unsigned ThreadPool::mCount = 0;
+    unsigned ThreadPool::mGrain = 1;
+    std::atomic<unsigned> ThreadPool::mNext(0);
+    unsigned ThreadPool::mGeneration = 0;
+    unsigned ThreadPool::mBusyWorkers = 0;
+    std::atomic<unsigned> ThreadPool::mCalls(0);
+    unsigned ThreadPool::mCall = 0;
+    thread_local uint64_t ThreadPool::mCurrentTask = ThreadPool::NoTask;
+
+    unsigned ThreadPool::getNumThreads() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    void ThreadPool::_start() {
+        mQuit = false;
+        for (unsigned i = 0; i + 1 < getNumThreads(); i++) {
+            mWorkers.emplace_back(_workerLoop, i);
+        }
+    }
+
+    void ThreadPool::shutDown() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQuit = true;
+        }
+        mWake.notify_all();
+        for (auto & worker : mWorkers) {
+            worker.join();
+        }
+        mWorkers.clear();
+    }
+
+    void ThreadPool::_runChunks() {
+        const uint64_t outer = mCurrentTask;
+        for (unsigned begin = mNext.fetch_add(mGrain); begin < mCount; begin = mNext.fetch_add(mGrain)) {
+            mCurrentTask = uint64_t(mCall) << 32 | begin;
+            (*mTask)(begin, std::min(begin + mGrain, mCount));
+        }
+        mCurrentTask = outer;
+    }
+
+    void ThreadPool::_workerLoop(unsigned index) {
+#if MICROPROFILE_ENABLED
+        MicroProfileOnThreadCreate(("Worker " + std::to_string(index)).c_str());
+#endif
+        unsigned generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWake.wait(lock, [&] { return mQuit || mGeneration != generation; });
+                if (mQuit) {
+                    return;
+                }
+                generation = mGeneration;
+            }
+
+            _runChunks();
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (--mBusyWorkers == 0) {
+                mDone.notify_one();
+            }
+        }
+    }
+
+    void ThreadPool::parallelFor(unsigned count, unsigned grain, const std::function<void(unsigned, unsigned)> & task) {
+        if (!count) {
+            return;
+        }
+        grain = std::max(grain, 1u);
+
+        /* Small ranges, single core machines and nested calls run inline. Nested ones stay part of the task
+         * they're called from */
+        bool expected = false;
+        if (count <= grain || getNumThreads() == 1 || !mRunning.compare_exchange_strong(expected, true)) {
+            if (mCurrentTask != NoTask) {
+                task(0, count);
+                return;
+            }
+            mCurrentTask = uint64_t(mCalls++) << 32;
+            task(0, count);
+            mCurrentTask = NoTask;
+            return;
+        }
+
+        MICROPROFILE_SCOPEI("ThreadPool", "parallelFor", MP_AUTO);
+        if (mWorkers.empty()) {
+            _start();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTask = &task;
+            mCount = count;
+            mGrain = grain;
+            mNext = 0;
+            mCall = mCalls++;
+            mBusyWorkers = unsigned(mWorkers.size());
+            mGeneration++;
+        }
+        mWake.notify_all();
+
+        _runChunks();
+
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mDone.wait(lock, [] { return mBusyWorkers == 0; });
+            mTask = nullptr;
+        }
+        mRunning = false;
+    }
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+namespace neo {
+
+    /* Persistent worker threads for data-parallel passes. parallelFor splits [0, count) into chunks of grain
+     * items that the workers and the calling thread pull until the range is done, and returns once every
+     * chunk has run. Calls made while a parallelFor is running (from a task, or from another thread) just run
+     * inline, so nesting is safe but doesn't go wider. Workers start on first use */
+    class ThreadPool {
+
+        public:
+            static void parallelFor(unsigned count, unsigned grain, const std::function<void(unsigned begin, unsigned end)> & task);
+
+            /* Worker threads plus the calling thread */
+            static unsigned getNumThreads();
+
+            /* The chunk the calling thread is running, as the parallelFor's place in call order and the chunk's
+             * first index -- or NoTask outside of one. Which thread runs a chunk varies, its task doesn't, as
+             * long as the parallelFors are called in the same order */
+            static constexpr uint64_t NoTask = ~uint64_t(0);
+            static uint64_t getCurrentTask() { return mCurrentTask; }
+
+            static void shutDown();
+
+        private:
+            static std::vector<std::thread> mWorkers;
+            static std::mutex mMutex;
+            static std::condition_variable mWake;
+            static std::condition_variable mDone;
+            static std::atomic<bool> mRunning;
+            static bool mQuit;
+
+            /* The current parallelFor */
+            static const std::function<void(unsigned, unsigned)> * mTask;
+            static unsigned mCount;
+            static unsigned mGrain;
+            static std::atomic<unsigned> mNext;
+            static unsigned mGeneration;
+            static unsigned mBusyWorkers;
+
+            /* Top level parallelFors so far, and the current one */
+            static std::atomic<unsigned> mCalls;
+            static unsigned mCall;
+            static thread_local uint64_t mCurrentTask;
+
+            static void _start();
+            static void _workerLoop(unsigned index);
+            static void _runChunks();
+    };
+
+}
@@ -98,8 +98,8 @@ namespace neo {
         mFrameSize.x = width; mFrameSize.y = height;
 
         // This message is sent for every frame that the window is being resized..
-        // During a quick click-and-drag resize of the window, this can result 
-        // in hundreds of messages 
+        // WindowFrameSizeMessage is coalesced, so receivers only see the latest
+        // size once per relay
         Messenger::sendMessage<WindowFrameSizeMessage>(nullptr, mFrameSize);
     }
 